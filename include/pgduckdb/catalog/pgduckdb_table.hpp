@@ -23,9 +23,13 @@ public:
 	duckdb::TableStorageInfo GetStorageInfo(duckdb::ClientContext &context) override;
 
 	static Relation OpenRelation(Oid relid);
+	static Relation TryOpenRelation(Oid relid);
+	static void CloseRelation(Relation rel);
 	static void SetTableInfo(duckdb::CreateTableInfo &info, Relation rel);
 
 protected:
+	duckdb::idx_t GetDistinctCount(duckdb::column_t column_id);
+
 	Relation rel;
 	Cardinality cardinality;
 	Snapshot snapshot;
@@ -16,6 +16,9 @@ class PostgresTable;
 
 void ClosePostgresRelations(duckdb::ClientContext &context);
 
+/* Forgets the cached columns of the relation, or of all relations if relid is InvalidOid */
+void InvalidateCachedTables(Oid relid);
+
 class SchemaItems {
 public:
 	SchemaItems(duckdb::unique_ptr<PostgresSchema> &&schema, const duckdb::string &name);
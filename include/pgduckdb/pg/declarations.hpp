@@ -23,6 +23,8 @@ typedef struct BufferAccessStrategyData *BufferAccessStrategy;
 
 typedef double Cardinality;
 
+struct CustomScan;
+
 typedef uintptr_t Datum;
 
 struct MemoryContextData;
@@ -5,5 +5,12 @@ struct ErrorData;
 }
 
 namespace pgduckdb::pg {
+/*
+ * The extra info of a DuckDB exception under which a Postgres error passes its
+ * SQLSTATE along, so that InvokeCPPFunc can raise the error with it again.
+ */
+constexpr const char *SQLERRCODE_EXTRA_INFO = "pg_sqlerrcode";
+
 const char *GetErrorDataMessage(ErrorData *error_data);
+int GetErrorDataSqlErrcode(ErrorData *error_data);
 }
@@ -12,6 +12,25 @@ Relation OpenRelation(Oid relationId);
 // Not thread-safe. Must be called under a lock.
 void CloseRelation(Relation relation);
 
+// Like OpenRelation, but returns nullptr if the relation does not exist (anymore).
+// Not thread-safe. Must be called under a lock.
+Relation TryOpenRelation(Oid relationId);
+
+/*
+ * Returns the current relcache entry of a relation that is already open, e.g.
+ * by the Postgres catalog of DuckDB or by a planned statement, without taking
+ * another reference to it. The entry stays valid as long as it's open.
+ * Not thread-safe. Must be called under a lock.
+ */
+Relation GetOpenRelation(Oid relationId);
+
+/*
+ * Registers the single callback that invalidates the backend-local caches
+ * that depend on the definition of relations, when a relation is changed.
+ * Called from _PG_init.
+ */
+void RegisterRelationInvalidationCallback();
+
 int GetTupleDescNatts(const TupleDesc tupleDesc);
 
 const char *GetAttName(const Form_pg_attribute);
@@ -26,6 +45,18 @@ TupleTableSlot *ExecStoreMinimalTupleUnsafe(MinimalTuple minmal_tuple, TupleTabl
 
 double EstimateRelSize(Relation rel);
 
+/*
+ * Returns the number of distinct values that ANALYZE estimated for the column
+ * with the given attribute number, or 0 if there are no statistics for it.
+ */
+double EstimateColumnDistinctCount(Relation rel, AttrNumber attnum, double reltuples);
+
+/*
+ * Returns the number of rows that Postgres expects to match the given quals.
+ * Throws if Postgres can't parse or plan the quals.
+ */
+double EstimateFilteredRelSize(Relation rel, const char *quals);
+
 Oid GetRelidFromSchemaAndTable(const char *, const char *);
 
 bool IsValidOid(Oid);
@@ -37,6 +68,8 @@ const char *QuoteIdentifier(const char *ident);
 
 const char *GetRelationName(Relation rel);
 
+Oid GetRelationOid(Relation rel);
+
 Oid GetOid(Form_pg_class rel);
 
 namespace pg {
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace pgduckdb {
+
+void InitAdmissionShmem(void);
+
+/*
+ * Waits until the limits of duckdb.max_active_queries_per_database and
+ * duckdb.max_active_queries_per_role allow this backend to execute another
+ * DuckDB query. Backends that already execute a DuckDB query are admitted
+ * right away. This is a Postgres function that throws Postgres errors, e.g.
+ * once duckdb.admission_timeout has passed.
+ */
+void AdmitDuckdbQuery(void);
+
+/*
+ * CHECK_FOR_INTERRUPTS that also cancels the query when cancel interrupts are
+ * held, for waits that happen before DuckDB started executing the query.
+ */
+void ProcessCancelInterrupts(void);
+
+/* Called once a query that was admitted doesn't run in DuckDB anymore */
+void ReleaseDuckdbQueryAdmission(void);
+
+/* Called at the end of the transaction, in case some queries never released their admission */
+void ReleaseAllDuckdbQueryAdmissions(void);
+
+} // namespace pgduckdb
@@ -9,6 +9,10 @@ bool DidWrites();
 bool DidWrites(duckdb::ClientContext &context);
 } // namespace ddb
 
+/* Defined in pgduckdb_node.cpp, for the streaming results of DuckDB queries that read Postgres tables */
+void MaterializeStreamingDuckdbScans();
+void AbortStreamingDuckdbScans();
+
 class DuckDBManager {
 public:
 	static inline bool
@@ -33,7 +37,7 @@ public:
 	}
 
 	static duckdb::unique_ptr<duckdb::Connection> CreateConnection();
-	static duckdb::Connection *GetConnection(bool force_transaction = false);
+	static duckdb::Connection *GetConnection(bool force_transaction = false, bool needs_extensions = true);
 	static duckdb::Connection *GetConnectionUnsafe();
 
 	inline const std::string &
@@ -55,8 +59,8 @@ public:
 
 private:
 	DuckDBManager()
-	    : extensions_table_current_seq(0), database(nullptr), connection(nullptr), default_dbname("<!UNSET!>"),
-	      secrets_valid(false) {
+	    : loaded_extensions_generation(0), loaded_extensions_table_seq(0), database(nullptr), connection(nullptr),
+	      default_dbname("<!UNSET!>"), secrets_valid(false), deferred_state_pending(false) {
 	}
 
 	DuckDBManager(const DuckDBManager &) = delete;
@@ -68,24 +72,18 @@ private:
 
 	void InitializeDatabase();
 
+	void LoadDeferredState(duckdb::ClientContext &);
 	void LoadSecrets(duckdb::ClientContext &);
 	void DropSecrets(duckdb::ClientContext &);
 	void LoadExtensions(duckdb::ClientContext &);
 	void InstallExtensions(duckdb::ClientContext &);
 	void LoadFunctions(duckdb::ClientContext &);
-	void RefreshConnectionState(duckdb::ClientContext &);
-
-	inline bool
-	IsExtensionsSeqLessThan(int64_t seq) const {
-		return extensions_table_current_seq < seq;
-	}
-
-	inline void
-	UpdateExtensionsSeq(int64_t seq) {
-		extensions_table_current_seq = seq;
-	}
+	void RefreshConnectionState(duckdb::ClientContext &, bool needs_extensions = true);
 
-	int64_t extensions_table_current_seq;
+	/* The generation of duckdb.extensions that the loaded extensions are from, see GetExtensionsGeneration */
+	uint64_t loaded_extensions_generation;
+	/* The same for duckdb.extensions_table_seq on a hot standby, see ExtensionsTableSeqOnStandby */
+	int64_t loaded_extensions_table_seq;
 	/*
 	 * FIXME: Use a unique_ptr instead of a raw pointer. For now this is not
 	 * possible though, as the MotherDuck extension causes an ABORT when the
@@ -101,6 +99,11 @@ private:
 	duckdb::unique_ptr<duckdb::Connection> connection;
 	std::string default_dbname;
 	bool secrets_valid;
+	/* Did duckdb.lazy_initialization defer loading the extensions and secrets? */
+	bool deferred_state_pending;
+	/* The values of the settings that RefreshConnectionState last sent to DuckDB */
+	std::string applied_disabled_filesystems;
+	std::string applied_azure_transport_option_type;
 };
 
 } // namespace pgduckdb
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pgduckdb {
+
+void InitGenerationsShmem(void);
+
+/*
+ * The generation of the duckdb.extensions table, which changes whenever
+ * another transaction changed the DuckDB extensions. A backend only needs to
+ * read the table again when this differs from the generation it last read.
+ */
+uint64_t GetExtensionsGeneration(void);
+
+/* Called when the current transaction changes duckdb.extensions */
+void BumpExtensionsGeneration(void);
+
+} // namespace pgduckdb
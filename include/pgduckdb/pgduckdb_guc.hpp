@@ -9,8 +9,18 @@ extern bool duckdb_unsafe_allow_execution_inside_functions;
 extern bool duckdb_unsafe_allow_mixed_transactions;
 extern bool duckdb_convert_unsupported_numeric_to_double;
 extern bool duckdb_log_pg_explain;
+extern bool duckdb_lazy_initialization;
 extern int duckdb_threads;
 extern int duckdb_maximum_memory;
+extern int duckdb_max_memory_global;
+extern int duckdb_max_threads_global;
+extern int duckdb_thread_priority;
+extern int duckdb_max_active_queries_per_database;
+extern int duckdb_max_active_queries_per_role;
+extern int duckdb_admission_timeout;
+extern char *duckdb_shared_engine_database;
+extern bool duckdb_use_shared_engine;
+extern bool duckdb_local_storage;
 extern char *duckdb_disabled_filesystems;
 extern char *duckdb_allowed_directories;
 extern bool duckdb_enable_external_access;
@@ -20,6 +30,9 @@ extern bool duckdb_autoinstall_known_extensions;
 extern bool duckdb_autoload_known_extensions;
 extern int duckdb_threads_for_postgres_scan;
 extern int duckdb_max_workers_per_postgres_scan;
+extern bool duckdb_columnar_worker_transport;
+extern int duckdb_dynamic_or_filter_threshold;
+extern int duckdb_max_cached_scan_plans;
 extern char *duckdb_postgres_role;
 extern char *duckdb_motherduck_session_hint;
 extern bool duckdb_force_motherduck_views;
@@ -8,5 +8,7 @@ bool IsAllowedStatement(Query *query, bool throw_error = false);
 bool IsCatalogTable(Relation rel);
 bool ContainsPostgresTable(Node *node, void *context);
 bool NeedsDuckdbExecution(Query *query);
+/* Does the DuckDB query need the extensions and secrets, which duckdb.lazy_initialization defers loading? */
+bool NeedsDuckdbExtensions(const Query *query);
 bool ShouldTryToUseDuckdbExecution(Query *query);
 } // namespace pgduckdb
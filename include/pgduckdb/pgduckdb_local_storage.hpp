@@ -0,0 +1,59 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+#include "pgduckdb/pg/declarations.hpp"
+
+namespace pgduckdb {
+
+/* The name under which duckdb.local_storage attaches the DuckDB database file of the Postgres database */
+constexpr const char *LOCAL_STORAGE_DATABASE = "pgduckdb_local";
+
+/*
+ * Registers the file system that gives access to the DuckDB database file,
+ * even when LocalFileSystem is disabled for the current user.
+ */
+void RegisterLocalStorageFileSystem(duckdb::DatabaseInstance &instance);
+
+/*
+ * The file system only gives access to the DuckDB database file while one of
+ * these is in scope, i.e. while pg_duckdb attaches, commits to or detaches
+ * the file itself.
+ */
+class LocalStorageFileAccess {
+public:
+	LocalStorageFileAccess();
+	~LocalStorageFileAccess();
+
+	LocalStorageFileAccess(const LocalStorageFileAccess &) = delete;
+	LocalStorageFileAccess &operator=(const LocalStorageFileAccess &) = delete;
+};
+
+/*
+ * Is the relation a table that duckdb.local_storage stores in the DuckDB
+ * database file, i.e. a permanent table using the duckdb access method?
+ */
+bool IsLocalStorageTable(Oid relid);
+
+/* Does the query read or write any table that duckdb.local_storage stores? */
+bool ReadsLocalStorageTable(Node *node, void *context);
+
+/*
+ * Attaches the DuckDB database file of the current Postgres database for the
+ * rest of the transaction. Any number of processes can open the file for
+ * reading, but only one can open it for writing. So this waits for the
+ * transactions of other backends that attached it in a conflicting way. A
+ * file that was attached for reading is attached again for writing when
+ * needed.
+ */
+void AttachLocalStorage(bool for_write);
+
+/* Attaches the DuckDB database file if the query uses tables in local storage, for writing if it changes them */
+void AttachLocalStorageForQuery(const Query *query);
+
+/* Detaches the DuckDB database file at the end of the transaction, after its DuckDB transaction finished */
+void DetachLocalStorage(duckdb::ClientContext &context);
+
+bool IsLocalStorageAttached();
+
+} // namespace pgduckdb
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/optional_idx.hpp"
+
+namespace pgduckdb {
+
+void InitMemoryGovernorShmem(void);
+
+/*
+ * Reserves memory for a DuckDB instance that is about to be created, and
+ * returns its memory limit in bytes. That can be 0 when the other backends
+ * reserved the whole budget. Returns an invalid index if the memory of the
+ * DuckDB instances is not limited by duckdb.max_memory_global.
+ */
+duckdb::optional_idx ReserveInitialDuckdbMemory(void);
+
+/*
+ * Reserves memory for the DuckDB queries of the current transaction, and
+ * applies the reservation as the memory limit of the DuckDB instance.
+ */
+void ReserveDuckdbMemory(duckdb::DatabaseInstance &instance);
+
+/* Gives back the part of the reservation that the DuckDB instance is not using at the end of the transaction */
+void ReleaseDuckdbMemory(duckdb::DatabaseInstance &instance);
+
+} // namespace pgduckdb
@@ -2,8 +2,11 @@
 
 extern "C" {
 #include "postgres.h"
+#include "executor/execdesc.h"
 #include "nodes/extensible.h"
 }
 
 extern CustomScanMethods duckdb_scan_scan_methods;
 extern "C" void DuckdbInitNode(void);
+bool CanRunDuckdbQueryInBulk(QueryDesc *query_desc, ScanDirection direction, uint64 count);
+void DuckdbExecutorRunInBulk(QueryDesc *query_desc);
@@ -5,6 +5,8 @@
 #include "pgduckdb/pg/declarations.hpp"
 #include "pgduckdb/pgduckdb_duckdb.hpp"
 
+#include <memory>
+
 #include "pgduckdb/utility/cpp_only_file.hpp" // Must be last include.
 
 extern bool duckdb_explain_analyze;
@@ -13,3 +15,8 @@ extern bool duckdb_explain_ctas;
 
 PlannedStmt *DuckdbPlanNode(Query *parse, int cursor_options, bool throw_error);
 duckdb::unique_ptr<duckdb::PreparedStatement> DuckdbPrepare(const Query *query, const char *explain_prefix = NULL);
+std::shared_ptr<duckdb::PreparedStatement> GetPlannedDuckdbStatement(const CustomScan *custom_scan, List **relations);
+void DropPlannedDuckdbStatements();
+/* Marks the planned statements that read the relation as invalid, or all of them if relid is InvalidOid */
+void InvalidatePlannedStatements(Oid relid);
+void RegisterPlannedDuckdbStatementNode();
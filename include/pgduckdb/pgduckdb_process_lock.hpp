@@ -1,9 +1,86 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace pgduckdb {
 
+/*
+ * A recursive mutex, which the thread that runs Postgres can also close for
+ * all other threads without holding it itself, see BlockOtherThreads.
+ */
+class ProcessLock {
+public:
+	void
+	lock() {
+		for (;;) {
+			mutex.lock();
+			if (!other_threads_blocked || blocking_thread == std::this_thread::get_id()) {
+				return;
+			}
+
+			mutex.unlock();
+			std::unique_lock<std::mutex> gate_lock(gate_mutex);
+			gate.wait(gate_lock, [this] { return !other_threads_blocked; });
+		}
+	}
+
+	bool
+	try_lock() {
+		if (!mutex.try_lock()) {
+			return false;
+		}
+		if (other_threads_blocked && blocking_thread != std::this_thread::get_id()) {
+			mutex.unlock();
+			return false;
+		}
+		return true;
+	}
+
+	void
+	unlock() {
+		mutex.unlock();
+	}
+
+	/*
+	 * Keeps all other threads from taking the lock until the matching
+	 * UnblockOtherThreads, while the calling thread doesn't hold it. Waits for
+	 * the other thread that holds the lock at the moment, if any.
+	 */
+	void
+	BlockOtherThreads() {
+		std::lock_guard<std::recursive_mutex> mutex_lock(mutex);
+		std::lock_guard<std::mutex> gate_lock(gate_mutex);
+		blocking_thread = std::this_thread::get_id();
+		blocks++;
+		other_threads_blocked = true;
+	}
+
+	void
+	UnblockOtherThreads() {
+		{
+			std::lock_guard<std::mutex> gate_lock(gate_mutex);
+			if (--blocks > 0) {
+				return;
+			}
+			other_threads_blocked = false;
+		}
+		gate.notify_all();
+	}
+
+private:
+	std::recursive_mutex mutex;
+	/* Protects blocks, and lets blocked threads wait until they're unblocked */
+	std::mutex gate_mutex;
+	std::condition_variable gate;
+	int blocks = 0;
+	std::atomic<bool> other_threads_blocked {false};
+	/* Only changed while holding mutex, so it's stable for the thread that holds it */
+	std::thread::id blocking_thread;
+};
+
 /*
  * GlobalProcessLock is used to synchronize calls to PG functions that modify global variables. Examples
  * for this synchronization are functions that read buffers/etc. This lock is shared between all threads and all
@@ -11,9 +88,9 @@ namespace pgduckdb {
  */
 struct GlobalProcessLock {
 public:
-	static std::recursive_mutex &
+	static ProcessLock &
 	GetLock() {
-		static std::recursive_mutex lock;
+		static ProcessLock lock;
 		return lock;
 	}
 };
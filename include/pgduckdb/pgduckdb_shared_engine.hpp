@@ -0,0 +1,31 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+#include "pgduckdb/pg/declarations.hpp"
+
+namespace pgduckdb {
+
+/* Registers the shared memory and the background worker of duckdb.shared_engine_database */
+void InitSharedEngine(void);
+
+/*
+ * Can the query be executed by the DuckDB instance of the shared engine,
+ * instead of the one of this backend? That's only the case for read-only
+ * queries that don't read Postgres tables, temporary tables or anything
+ * else that only this backend can see.
+ */
+bool CanUseSharedEngine(const Query *query);
+
+/*
+ * Executes the query in the shared engine and returns a result that receives
+ * its chunks from there. The result has the same types and names as the
+ * statement that this backend prepared for the query. Returns NULL if the
+ * shared engine is not running, in which case the query should be executed
+ * locally instead.
+ */
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteInSharedEngine(const Query *query, const duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &parameters,
+                      duckdb::PreparedStatement &prepared, duckdb::ClientContext &context);
+
+} // namespace pgduckdb
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace pgduckdb {
+
+void InitThreadGovernorShmem(void);
+
+/*
+ * Marks this backend as running a DuckDB query, which gives it a share of
+ * duckdb.max_threads_global. The next RebalanceDuckdbThreads call sizes the
+ * thread pool of its DuckDB instance to that share. Every call must be paired
+ * with a call to ReleaseDuckdbThreads.
+ */
+void AcquireDuckdbThreads(void);
+
+/*
+ * Resizes the thread pool of the DuckDB instance if the share of this backend
+ * changed since the last call, because other backends started or finished
+ * their queries. This is cheap enough to call in between DuckDB tasks.
+ */
+void RebalanceDuckdbThreads(duckdb::ClientContext &context);
+
+/* Called once a query that called AcquireDuckdbThreads doesn't need its threads anymore */
+void ReleaseDuckdbThreads(void);
+
+/* Called at the end of the transaction, in case some queries never released their threads */
+void ReleaseAllDuckdbThreads(void);
+
+/*
+ * Takes up to the given number of Postgres parallel workers out of the share
+ * of this backend, and returns how many it could take. Every worker that was
+ * taken must be given back with ReleasePostgresScanWorkers.
+ */
+int ReservePostgresScanWorkers(int wanted);
+
+void ReleasePostgresScanWorkers(int count);
+
+} // namespace pgduckdb
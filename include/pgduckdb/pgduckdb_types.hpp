@@ -30,15 +30,37 @@ const duckdb::date_t PGDUCKDB_PG_MAX_DATE_VALUE = duckdb::Date::FromDate(PG_MAXY
 constexpr int64_t PGDUCKDB_MAX_TIMESTAMP_VALUE = 9223371244800000000;
 constexpr int64_t PGDUCKDB_MIN_TIMESTAMP_VALUE = -210866803200000000;
 
+/* Converts a single non-NULL Postgres Datum and stores it at the given offset of the DuckDB vector */
+typedef void (*PostgresToDuckConverter)(duckdb::Vector &result, Datum value, uint64_t offset);
+
+/*
+ * How to convert the values of a single column from Postgres to DuckDB. This
+ * is resolved once per scan, so that no type checks are needed per value.
+ */
+struct PostgresColumnConverter {
+	PostgresToDuckConverter convert;
+	/* Same as convert, but references the value in place. Only set for strings. */
+	PostgresToDuckConverter convert_no_copy;
+	/* Values need to be detoasted before they can be converted */
+	bool is_varlena;
+	/* Conversion doesn't call any Postgres functions, so it doesn't need the global process lock */
+	bool is_thread_safe;
+};
+
 void CheckForUnsupportedPostgresType(duckdb::LogicalType type);
 duckdb::LogicalType ConvertPostgresToDuckColumnType(Form_pg_attribute &attribute);
 Oid GetPostgresDuckDBType(const duckdb::LogicalType &type, bool throw_error = false);
 int32_t GetPostgresDuckDBTypemod(const duckdb::LogicalType &type);
 duckdb::Value ConvertPostgresParameterToDuckValue(Datum value, Oid postgres_type);
 void ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &result, uint64_t offset);
+PostgresColumnConverter GetPostgresColumnConverter(Form_pg_attribute attribute, const duckdb::LogicalType &type);
 bool ConvertDuckToPostgresValue(TupleTableSlot *slot, duckdb::Value &value, uint64_t col);
+bool ConvertDuckToPostgresColumn(duckdb::Vector &vector, uint64_t count, Oid oid, Datum *values, bool *nulls);
 void InsertTupleIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state, TupleTableSlot *slot);
 void InsertTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state, TupleTableSlot **slots,
                            int num_slots);
+duckdb::vector<int32_t> ComputeAttrCacheOffsets(TupleDesc tupdesc);
+void InsertMinimalTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state,
+                                  MinimalTuple *tuples, int num_tuples);
 
 } // namespace pgduckdb
@@ -78,13 +78,21 @@ private:
 	PostgresScopedStackReset &operator=(const PostgresScopedStackReset &) = delete;
 };
 
+[[noreturn]] inline void
+ThrowPostgresError(const char *func_name, ErrorData *edata) {
+	auto message = duckdb::StringUtil::Format("(PGDuckDB/%s) %s", func_name, pg::GetErrorDataMessage(edata));
+	duckdb::unordered_map<std::string, std::string> extra_info = {
+	    {pg::SQLERRCODE_EXTRA_INFO, std::to_string(pg::GetErrorDataSqlErrcode(edata))}};
+	throw duckdb::Exception(duckdb::ExceptionType::EXECUTOR, message, extra_info);
+}
+
 /*
  * DuckdbGlobalLock should be held before calling.
  */
 template <typename Func, Func func, typename... FuncArgs>
 typename std::invoke_result<Func, FuncArgs...>::type
 __PostgresFunctionGuard__(const char *func_name, FuncArgs... args) {
-	std::lock_guard<std::recursive_mutex> lock(pgduckdb::GlobalProcessLock::GetLock());
+	std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
 	MemoryContext ctx = CurrentMemoryContext;
 
 	{ // PG_TRY
@@ -114,8 +122,7 @@ __PostgresFunctionGuard__(const char *func_name, FuncArgs... args) {
 		}
 	} // PG_END_TRY
 
-	auto message = duckdb::StringUtil::Format("(PGDuckDB/%s) %s", func_name, pg::GetErrorDataMessage(edata));
-	throw duckdb::Exception(duckdb::ExceptionType::EXECUTOR, message);
+	ThrowPostgresError(func_name, edata);
 }
 
 #define PostgresFunctionGuard(FUNC, ...)                                                                               \
@@ -154,8 +161,7 @@ __PostgresMemberGuard__(ReturnType (T::*func)(FuncArgs... args), T *instance, co
 		}
 	} // PG_END_TRY
 
-	auto message = duckdb::StringUtil::Format("(PGDuckDB/%s) %s", func_name, pg::GetErrorDataMessage(edata));
-	throw duckdb::Exception(duckdb::ExceptionType::EXECUTOR, message);
+	ThrowPostgresError(func_name, edata);
 }
 
 #define PostgresMemberGuard(FUNC, ...) pgduckdb::__PostgresMemberGuard__(&FUNC, this, __func__, ##__VA_ARGS__)
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+#include "pgduckdb/pg/declarations.hpp"
+
+#include "pgduckdb/utility/cpp_only_file.hpp" // Must be last include.
+
+namespace pgduckdb {
+
+struct PostgresScanLocalState;
+
+/*
+ * Parameters for a scan query whose parallel workers should send their tuples
+ * as columnar batches. Parameters are shipped to the workers through the DSM
+ * segment of the parallel query, which is how they find out.
+ */
+ParamListInfo MakeColumnarWorkerTransportParams();
+
+/* Can the parallel workers of a scan with these output types send columnar batches? */
+bool SupportsColumnarWorkerTransport(const duckdb::vector<duckdb::LogicalType> &types);
+
+/* Called by parallel workers, to send their tuples as columnar batches if the leader asked for that */
+void MaybeUseColumnarWorkerTransport(QueryDesc *query_desc);
+
+/* Appends a columnar batch that was received from a parallel worker to the output chunk */
+void InsertColumnarBatchIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state,
+                                  MinimalTuple batch);
+
+} // namespace pgduckdb
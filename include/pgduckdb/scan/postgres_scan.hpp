@@ -1,8 +1,12 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/planner/filter/dynamic_filter.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
 
 #include "pgduckdb/pg/declarations.hpp"
+#include "pgduckdb/pgduckdb_types.hpp"
 #include "pgduckdb/utility/allocator.hpp"
 
 #include "pgduckdb/scan/postgres_table_reader.hpp"
@@ -14,7 +18,7 @@ namespace pgduckdb {
 // Global State
 
 struct PostgresScanGlobalState : public duckdb::GlobalTableFunctionState {
-	explicit PostgresScanGlobalState(Snapshot, Relation rel, const duckdb::TableFunctionInitInput &input);
+	explicit PostgresScanGlobalState(Relation rel, const duckdb::TableFunctionInitInput &input);
 	~PostgresScanGlobalState();
 	idx_t
 	MaxThreads() const override {
@@ -31,19 +35,51 @@ private:
 	PostgresScanGlobalState &operator=(const PostgresScanGlobalState &) = delete;
 
 public:
-	Snapshot snapshot;
 	Relation rel;
 	TupleDesc table_tuple_desc;
 	bool count_tuples_only;
 	duckdb::vector<AttrNumber> output_columns;
+	/* How to convert each of the output columns, in the same order */
+	duckdb::vector<PostgresColumnConverter> column_converters;
+	/* Offsets of the fixed-width prefix of the scanned tuples, -1 past the first varlena */
+	duckdb::vector<int32_t> attr_cache_offsets;
+	/* Do the parallel workers send columnar batches instead of tuples? */
+	bool columnar_worker_transport;
+	/* Top-N dynamic filters on the output columns, with the index of the column they filter */
+	duckdb::vector<std::pair<idx_t, duckdb::shared_ptr<duckdb::DynamicFilterData>>> dynamic_filters;
 	std::atomic<std::uint32_t> total_row_count;
 	std::atomic<std::int32_t> registered_local_states;
 	std::ostringstream scan_query;
+	/* The WHERE clause of scan_query, if it has one */
+	duckdb::string scan_filters;
 	duckdb::shared_ptr<PostgresTableReader> table_reader_global_state;
 	MemoryContext duckdb_scan_memory_ctx;
 	idx_t max_threads;
 };
 
+// String buffer
+
+/*
+ * Owns the memory that strings in the output chunk of a scan point to, so
+ * they don't need to be copied into the string heap of their vector. Every
+ * string vector of the chunk holds a reference to the buffer, which keeps the
+ * memory alive for as long as DuckDB uses any of them.
+ */
+class PostgresScanStringBuffer : public duckdb::VectorBuffer {
+public:
+	PostgresScanStringBuffer();
+	~PostgresScanStringBuffer() override;
+
+	/* Takes ownership of a detoasted value that was allocated with duckdb_malloc */
+	void AddDetoastedValue(void *value);
+
+	/* Copies of the parallel worker tuples that were scanned into the chunk */
+	duckdb::ArenaAllocator tuple_arena;
+
+private:
+	duckdb::vector<void *> detoasted_values;
+};
+
 // Local State
 #define LOCAL_STATE_SLOT_BATCH_SIZE 32
 struct PostgresScanLocalState : public duckdb::LocalTableFunctionState {
@@ -52,7 +88,10 @@ struct PostgresScanLocalState : public duckdb::LocalTableFunctionState {
 
 	PostgresScanGlobalState *global_state;
 	TupleTableSlot *slots[LOCAL_STATE_SLOT_BATCH_SIZE];
-	std::vector<uint8_t> minimal_tuple_buffer[LOCAL_STATE_SLOT_BATCH_SIZE];
+	/* Parallel worker queues that only this thread reads from */
+	ParallelWorkerQueues worker_queues;
+	/* Keeps the memory alive that strings in the current output chunk point to */
+	duckdb::buffer_ptr<PostgresScanStringBuffer> string_buffer;
 
 	size_t output_vector_size;
 	bool exhausted_scan;
@@ -65,18 +104,43 @@ private:
 // PostgresScanFunctionData
 
 struct PostgresScanFunctionData : public duckdb::TableFunctionData {
-	PostgresScanFunctionData(Relation rel, uint64_t cardinality, Snapshot snapshot);
+	PostgresScanFunctionData(duckdb::TableCatalogEntry &table, Relation rel, uint64_t cardinality,
+	                         duckdb::vector<duckdb::LogicalType> column_types);
 	~PostgresScanFunctionData() override;
+	/* Filters that DuckDB pushes into the scan as Postgres quals, only used to estimate the cardinality */
 	duckdb::vector<duckdb::string> complex_filters;
-	Relation rel;
+	/*
+	 * The catalog entry of the scanned table. Catalog entries of Postgres
+	 * tables only live as long as the query that bound them, while a prepared
+	 * statement is executed again in later queries and transactions. So this
+	 * is only handed to DuckDB through get_bind_info, for the optimizer, and
+	 * cleared once the statement is executed. Anything else that's needed
+	 * from it is copied into the bind data.
+	 */
+	duckdb::optional_ptr<duckdb::TableCatalogEntry> table;
+	/*
+	 * The scanned relation, whose relcache entry is looked up again every
+	 * time it's used, see GetOpenRelation.
+	 */
+	Oid relid;
+	duckdb::string relation_name;
 	uint64_t cardinality;
-	Snapshot snapshot;
+	/* The number of rows that Postgres expects to match complex_filters, see PostgresScanPushdownComplexFilter */
+	uint64_t filtered_cardinality;
+	/* DuckDB types of all the columns of the table, indexed by attribute number - 1 */
+	duckdb::vector<duckdb::LogicalType> column_types;
+	/* Number of distinct values of every column that ANALYZE found, 0 if unknown, indexed like column_types */
+	duckdb::vector<duckdb::idx_t> distinct_counts;
 
 private:
 	PostgresScanFunctionData(const PostgresScanFunctionData &) = delete;
 	PostgresScanFunctionData &operator=(const PostgresScanFunctionData &) = delete;
 };
 
+/* Statistics that only tell DuckDB how many distinct values a column has */
+duckdb::unique_ptr<duckdb::BaseStatistics> MakeDistinctCountStatistics(const duckdb::LogicalType &type,
+                                                                       duckdb::idx_t distinct_count);
+
 // PostgresScanTableFunction
 
 struct PostgresScanTableFunction : public duckdb::TableFunction {
@@ -94,6 +158,9 @@ struct PostgresScanTableFunction : public duckdb::TableFunction {
 
 	static duckdb::unique_ptr<duckdb::NodeStatistics> PostgresScanCardinality(duckdb::ClientContext &context,
 	                                                                          const duckdb::FunctionData *data);
+	static duckdb::unique_ptr<duckdb::BaseStatistics>
+	PostgresScanStatistics(duckdb::ClientContext &context, const duckdb::FunctionData *data, duckdb::column_t column_id);
+	static duckdb::BindInfo PostgresScanGetBindInfo(const duckdb::optional_ptr<duckdb::FunctionData> data);
 	static duckdb::InsertionOrderPreservingMap<duckdb::string> ToString(duckdb::TableFunctionToStringInput &input);
 };
 
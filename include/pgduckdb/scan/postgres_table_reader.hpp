@@ -2,21 +2,78 @@
 
 #include "pgduckdb/pg/declarations.hpp"
 
+#include <atomic>
+#include <string>
 #include <vector>
 
 #include "pgduckdb/utility/cpp_only_file.hpp" // Must be last include.
 
+namespace duckdb {
+class ArenaAllocator;
+}
+
 namespace pgduckdb {
 
+/*
+ * The parallel worker tuple queues that a single consumer (a DuckDB thread)
+ * reads from. Every queue is claimed by exactly one consumer, so only that
+ * consumer ever reads from it.
+ */
+struct ParallelWorkerQueues {
+	ParallelWorkerQueues();
+
+	/* Indexes into parallel_worker_readers of the claimed queues that are not done yet */
+	std::vector<int> readers;
+	int next_reader;
+	/* Did this consumer claim its initial share of the queues? */
+	bool claimed_share;
+	/*
+	 * Set if the last read returned no tuple because none of the queues had one
+	 * ready, and the consumer should scan part of the leader's share instead.
+	 */
+	bool leader_turn;
+};
+
+/*
+ * Throws if the transaction aborted, in which case Postgres already released
+ * the resources of the scans. Threads that still read from the scans of a
+ * streaming result call this after taking the GlobalProcessLock.
+ */
+void CheckPostgresScansNotAborted();
+
+/* Replans the cached scan queries of the relation, or of all relations if relid is InvalidOid */
+void InvalidateCachedScanPlans(Oid relid);
+
+/*
+ * What a scan of a Postgres table reads: the relation, the columns that it
+ * returns and the filters that DuckDB pushed into it. Scans with the same key
+ * have the same scan query, so they share a cached plan.
+ */
+struct TableScanKey {
+	Oid relid;
+	bool count_tuples_only;
+	std::vector<AttrNumber> output_columns;
+	/* The quals of the scan query, as they appear in its WHERE clause */
+	std::string filters;
+
+	bool operator==(const TableScanKey &other) const;
+};
+
+struct TableScanKeyHash {
+	size_t operator()(const TableScanKey &key) const;
+};
+
 class PostgresTableReader {
 public:
 	PostgresTableReader();
 	~PostgresTableReader();
 	TupleTableSlot *GetNextTuple();
-	void Init(const char *table_scan_query, bool count_tuples_only);
+	void Init(const TableScanKey &scan_key, const char *table_scan_query, bool columnar_worker_transport);
 	void Cleanup();
-	bool GetNextMinimalWorkerTuple(std::vector<uint8_t> &minimal_tuple_buffer);
+	MinimalTuple GetNextMinimalWorkerTuple(ParallelWorkerQueues &queues, duckdb::ArenaAllocator &allocator);
+	TupleTableSlot *GetNextLeaderTuple();
 	TupleTableSlot *InitTupleSlot();
+	TupleDesc GetResultTupleDesc() const;
 	int
 	NumWorkersLaunched() const {
 		return nworkers_launched;
@@ -26,12 +83,14 @@ private:
 	PostgresTableReader(const PostgresTableReader &) = delete;
 	PostgresTableReader &operator=(const PostgresTableReader &) = delete;
 
-	void InitUnsafe(const char *table_scan_query, bool count_tuples_only);
+	void InitUnsafe(const TableScanKey &scan_key, const char *table_scan_query, bool columnar_worker_transport);
 	void InitRunWithParallelScan(PlannedStmt *, bool);
 	void CleanupUnsafe();
 
 	TupleTableSlot *GetNextTupleUnsafe();
-	MinimalTuple GetNextWorkerTuple();
+	TupleTableSlot *GetNextLeaderTupleUnsafe();
+	MinimalTuple GetNextWorkerTuple(ParallelWorkerQueues &queues);
+	bool ClaimWorkerQueues(ParallelWorkerQueues &queues);
 	int ParallelWorkerNumber(Cardinality cardinality);
 	bool CanTableScanRunInParallel(Plan *plan);
 	bool MarkPlanParallelAware(Plan *plan);
@@ -43,7 +102,14 @@ private:
 	TupleTableSlot *slot;
 	int nworkers_launched;
 	int nreaders;
-	int next_parallel_reader;
+	/* Number of threads that read from the worker queues concurrently */
+	int num_consumers;
+	std::atomic<int> next_unclaimed_reader;
+	/* Does the leader scan its own share of the table, like Gather does with parallel_leader_participation? */
+	bool leader_participation;
+	std::atomic<bool> leader_scan_done;
+	/* Queues read by GetNextTuple, which is used when only a single thread consumes the scan */
+	ParallelWorkerQueues single_consumer_queues;
 	bool entered_parallel_mode;
 	bool cleaned_up;
 };
@@ -3,6 +3,13 @@
 extern "C" {
 #include "postgres.h"
 #include "nodes/plannodes.h"
+#include "tcop/dest.h"
 }
 
 const char *MakeDuckdbCopyQuery(PlannedStmt *pstmt, const char *query_string, struct QueryEnvironment *query_env);
+PlannedStmt *PlanDuckdbCopyToStdout(PlannedStmt *pstmt, const char *query_string, struct QueryEnvironment *query_env,
+                                    bool *binary);
+void DuckdbCopyToStdout(PlannedStmt *plan, const char *query_string, struct QueryEnvironment *query_env, bool binary,
+                        QueryCompletion *qc);
+bool IsDuckdbCopyOutReceiver(DestReceiver *dest);
+void DuckdbCopyOutReceiveChunk(DestReceiver *dest, Datum **values, bool **nulls, uint64 count);
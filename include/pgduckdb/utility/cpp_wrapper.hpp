@@ -2,27 +2,42 @@
 
 #include <duckdb/common/error_data.hpp>
 
+#include "pgduckdb/pg/error_data.hpp"
+
 extern "C" {
 #include "postgres.h"
 }
 
 namespace pgduckdb {
 
+/* The SQLSTATE of the Postgres error that PostgresFunctionGuard turned into the DuckDB error, if any */
+inline int
+PostgresErrorCode(const duckdb::ErrorData &edata, int default_sqlerrcode) {
+	auto entry = edata.ExtraInfo().find(pg::SQLERRCODE_EXTRA_INFO);
+	if (entry == edata.ExtraInfo().end()) {
+		return default_sqlerrcode;
+	}
+	return std::stoi(entry->second);
+}
+
 template <typename Func, Func func, typename... FuncArgs>
 typename std::invoke_result<Func, FuncArgs &...>::type
 __CPPFunctionGuard__(const char *func_name, const char *file_name, int line, FuncArgs &...args) {
 	const char *error_message = nullptr;
+	int sqlerrcode = ERRCODE_INTERNAL_ERROR;
 	auto pg_es_start = PG_exception_stack;
 	try {
 		return func(args...);
 	} catch (duckdb::Exception &ex) {
 		duckdb::ErrorData edata(ex.what());
 		error_message = pstrdup(edata.Message().c_str());
+		sqlerrcode = PostgresErrorCode(edata, sqlerrcode);
 	} catch (std::exception &ex) {
 		const auto msg = ex.what();
 		if (msg[0] == '{') {
 			duckdb::ErrorData edata(ex.what());
 			error_message = pstrdup(edata.Message().c_str());
+			sqlerrcode = PostgresErrorCode(edata, sqlerrcode);
 		} else {
 			error_message = pstrdup(ex.what());
 		}
@@ -75,6 +90,7 @@ __CPPFunctionGuard__(const char *func_name, const char *file_name, int line, Fun
 
 	// Simplified version of `elog(ERROR, ...)`, with arguments inlined
 	if (errstart_cold(ERROR, TEXTDOMAIN)) {
+		errcode(sqlerrcode);
 		errmsg_internal("(PGDuckDB/%s) %s", func_name, error_message);
 		errfinish(file_name, line, func_name);
 	}
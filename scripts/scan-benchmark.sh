@@ -0,0 +1,54 @@
+#!/bin/sh
+# Microbenchmark for the conversion of Postgres tuples to DuckDB vectors in
+# the Postgres scan. It creates an int, text, numeric and timestamp heavy
+# table and reports the average latency of a DuckDB query that needs to
+# convert every value of them, both with and without parallel Postgres
+# workers. Run it against two builds to compare them.
+# This uses psql environment variables from the shell, such as:
+# PGUSER, PGPASSWORD, PGHOST, PGPORT, and PGDATABASE
+
+set -eu
+rows=${1:-1000000}
+transactions=${2:-10}
+schema_name=${3:-scan_benchmark}
+
+psql -v ON_ERROR_STOP=1 -q <<EOF
+DROP SCHEMA IF EXISTS $schema_name CASCADE;
+CREATE SCHEMA $schema_name;
+CREATE TABLE $schema_name.ints AS
+    SELECT i::int a, i::bigint b, (i % 30000)::smallint c, (i * 7)::int d,
+           (i * 13)::bigint e, (i % 1000)::int f, (i * 31)::bigint g, (i % 100)::smallint h
+    FROM generate_series(1, $rows) i;
+CREATE TABLE $schema_name.texts AS
+    SELECT md5(i::text) a, md5((i + 1)::text)::varchar b, md5((i + 2)::text)::bpchar(40) c,
+           'row ' || i d, repeat('x', i % 50) e, i::text f
+    FROM generate_series(1, $rows) i;
+CREATE TABLE $schema_name.numerics AS
+    SELECT (i / 100.0)::numeric(9, 2) a, (i * 1.0001)::numeric(18, 4) b, (i * 3.3)::numeric(18, 4) c,
+           (i * 1.000000001)::numeric(38, 10) d, (i / 7.0)::numeric(38, 10) e, (i / 3.0)::numeric f
+    FROM generate_series(1, $rows) i;
+CREATE TABLE $schema_name.timestamps AS
+    SELECT '2000-01-01'::timestamp + i * interval '1 second' a,
+           '2000-01-01'::timestamptz + i * interval '1 minute' b,
+           '2000-01-01'::date + (i % 10000) c,
+           '1970-01-01'::timestamp + i * interval '1 hour' d,
+           '2020-01-01'::timestamptz - i * interval '1 second' e
+    FROM generate_series(1, $rows) i;
+ANALYZE $schema_name.ints, $schema_name.texts, $schema_name.numerics, $schema_name.timestamps;
+EOF
+
+script=$(mktemp)
+trap 'rm -f "$script"' EXIT
+
+for table in ints texts numerics timestamps; do
+    columns=$(psql -At -c "SELECT string_agg(format('max(%I)', attname), ', ' ORDER BY attnum) FROM pg_attribute WHERE attrelid = '$schema_name.$table'::regclass AND attnum > 0 AND NOT attisdropped")
+    for workers in 0 2; do
+        cat >"$script" <<EOF
+SET duckdb.force_execution = true;
+SET duckdb.max_workers_per_postgres_scan = $workers;
+SELECT $columns FROM $schema_name.$table;
+EOF
+        latency=$(pgbench -n -t "$transactions" -f "$script" | sed -n 's/^latency average = //p')
+        echo "$table (max_workers_per_postgres_scan = $workers): $latency"
+    done
+done
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Benchmark for the latency of the first DuckDB query of a new connection,
+# which includes creating the DuckDB instance of the backend. Every
+# transaction opens a new connection and runs a single DuckDB query on a
+# small Postgres table, both with and without duckdb.lazy_initialization. The
+# same query executed by Postgres is included as the baseline cost of the
+# connection itself. Run it against two builds to compare them.
+# This uses psql environment variables from the shell, such as:
+# PGUSER, PGPASSWORD, PGHOST, PGPORT, and PGDATABASE
+
+set -eu
+transactions=${1:-100}
+schema_name=${2:-startup_benchmark}
+
+psql -v ON_ERROR_STOP=1 -q <<EOF
+DROP SCHEMA IF EXISTS $schema_name CASCADE;
+CREATE SCHEMA $schema_name;
+CREATE TABLE $schema_name.t AS SELECT i a FROM generate_series(1, 1000) i;
+ANALYZE $schema_name.t;
+EOF
+
+script=$(mktemp)
+trap 'rm -f "$script"' EXIT
+
+run() {
+    latency=$(pgbench -n -C -t "$transactions" -f "$script" | sed -n 's/^latency average = //p')
+    echo "$1: $latency"
+}
+
+cat >"$script" <<EOF
+SELECT count(*) FROM $schema_name.t;
+EOF
+run "postgres"
+
+for lazy in false true; do
+    cat >"$script" <<EOF
+SET duckdb.lazy_initialization = $lazy;
+SET duckdb.force_execution = true;
+SELECT count(*) FROM $schema_name.t;
+EOF
+    run "duckdb (lazy_initialization = $lazy)"
+done
@@ -39,3 +39,80 @@ RETURNS SETOF duckdb.row
 SET search_path = pg_catalog, pg_temp
 AS 'MODULE_PATHNAME', 'duckdb_only_function'
 LANGUAGE C;
+
+-- The memory that the DuckDB instance of each connection reserved from
+-- duckdb.max_memory_global
+CREATE FUNCTION duckdb.memory_reservations(OUT pid integer, OUT reserved_memory bigint, OUT used_memory bigint)
+RETURNS SETOF record
+SET search_path = pg_catalog, pg_temp
+AS 'MODULE_PATHNAME', 'duckdb_memory_usage'
+LANGUAGE C;
+
+CREATE VIEW duckdb.memory_usage AS
+    SELECT pid, reserved_memory, used_memory FROM duckdb.memory_reservations();
+GRANT SELECT ON duckdb.memory_usage TO PUBLIC;
+
+-- The share of duckdb.max_threads_global of each connection that uses DuckDB
+CREATE FUNCTION duckdb.thread_shares(OUT pid integer, OUT priority integer, OUT threads integer, OUT postgres_workers integer)
+RETURNS SETOF record
+SET search_path = pg_catalog, pg_temp
+AS 'MODULE_PATHNAME', 'duckdb_thread_usage'
+LANGUAGE C;
+
+CREATE VIEW duckdb.thread_usage AS
+    SELECT pid, priority, threads, postgres_workers FROM duckdb.thread_shares();
+GRANT SELECT ON duckdb.thread_usage TO PUBLIC;
+
+-- The connections that execute DuckDB queries, or wait to be admitted to do so
+CREATE FUNCTION duckdb.admission_queue_entries(OUT pid integer, OUT database_oid oid, OUT role_oid oid, OUT state text, OUT state_change timestamptz)
+RETURNS SETOF record
+SET search_path = pg_catalog, pg_temp
+AS 'MODULE_PATHNAME', 'duckdb_admission_queue'
+LANGUAGE C;
+
+CREATE VIEW duckdb.admission_queue AS
+    SELECT q.pid, d.datname, r.rolname, q.state, q.state_change, now() - q.state_change AS duration
+    FROM duckdb.admission_queue_entries() q
+    LEFT JOIN pg_catalog.pg_database d ON d.oid = q.database_oid
+    LEFT JOIN pg_catalog.pg_roles r ON r.oid = q.role_oid;
+GRANT SELECT ON duckdb.admission_queue TO PUBLIC;
+
+CREATE FUNCTION duckdb.admission_statistics(
+    OUT active integer,
+    OUT waiting integer,
+    OUT admitted bigint,
+    OUT queued bigint,
+    OUT timed_out bigint,
+    OUT total_wait_time double precision,
+    OUT max_wait_time double precision)
+RETURNS record
+SET search_path = pg_catalog, pg_temp
+AS 'MODULE_PATHNAME', 'duckdb_admission_stats'
+LANGUAGE C;
+
+CREATE VIEW duckdb.admission_stats AS
+    SELECT * FROM duckdb.admission_statistics();
+GRANT SELECT ON duckdb.admission_stats TO PUBLIC;
+
+-- Let the backends know that duckdb.extensions changed, so that only the ones
+-- of hot standbys need to read duckdb.extensions_table_seq on every query.
+CREATE FUNCTION duckdb._invalidate_extensions()
+RETURNS void
+SET search_path = pg_catalog, pg_temp
+AS 'MODULE_PATHNAME', 'duckdb_invalidate_extensions'
+LANGUAGE C;
+REVOKE ALL ON FUNCTION duckdb._invalidate_extensions() FROM PUBLIC;
+
+CREATE OR REPLACE FUNCTION duckdb._update_extensions_table_seq()
+RETURNS TRIGGER
+SET search_path = pg_catalog, pg_temp
+AS
+$$
+BEGIN
+    -- Hot standbys only notice changes through the sequence. Unlike nextval,
+    -- setval writes every change to the WAL, so they see each one.
+    PERFORM setval('duckdb.extensions_table_seq', nextval('duckdb.extensions_table_seq'));
+    PERFORM duckdb._invalidate_extensions();
+    RETURN NEW;
+END;
+$$ LANGUAGE PLpgSQL;
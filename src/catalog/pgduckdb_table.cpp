@@ -20,16 +20,27 @@ PostgresTable::PostgresTable(duckdb::Catalog &_catalog, duckdb::SchemaCatalogEnt
 }
 
 PostgresTable::~PostgresTable() {
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
 	CloseRelation(rel);
 }
 
 Relation
 PostgresTable::OpenRelation(Oid relid) {
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
 	return pgduckdb::OpenRelation(relid);
 }
 
+Relation
+PostgresTable::TryOpenRelation(Oid relid) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	return pgduckdb::TryOpenRelation(relid);
+}
+
+void
+PostgresTable::CloseRelation(Relation rel) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	pgduckdb::CloseRelation(rel);
+}
+
 void
 PostgresTable::SetTableInfo(duckdb::CreateTableInfo &info, Relation rel) {
 	auto tupleDesc = RelationGetDescr(rel);
@@ -46,14 +57,52 @@ PostgresTable::SetTableInfo(duckdb::CreateTableInfo &info, Relation rel) {
 	}
 }
 
+/*
+ * Only the number of distinct values is taken from the statistics that
+ * ANALYZE stored in pg_statistic. DuckDB uses it to estimate join
+ * cardinalities, so it's fine for it to be approximate. The histogram bounds
+ * and null fraction are not used, because they come from a sample of the
+ * table and might be outdated, while DuckDB would trust them to prune filters
+ * and null checks.
+ *
+ * Returns 0 if there are no statistics for the column.
+ */
+duckdb::idx_t
+PostgresTable::GetDistinctCount(duckdb::column_t column_id) {
+	if (column_id >= columns.LogicalColumnCount()) {
+		return 0;
+	}
+
+	auto distinct_count = EstimateColumnDistinctCount(rel, column_id + 1, cardinality);
+	if (distinct_count < 1) {
+		return 0;
+	}
+
+	if (cardinality >= 1) {
+		distinct_count = std::min(distinct_count, cardinality);
+	}
+
+	return static_cast<duckdb::idx_t>(distinct_count);
+}
+
 duckdb::unique_ptr<duckdb::BaseStatistics>
-PostgresTable::GetStatistics(duckdb::ClientContext &, duckdb::column_t) {
-	throw duckdb::NotImplementedException("GetStatistics not supported yet");
+PostgresTable::GetStatistics(duckdb::ClientContext &, duckdb::column_t column_id) {
+	auto distinct_count = GetDistinctCount(column_id);
+	if (distinct_count == 0) {
+		return nullptr;
+	}
+
+	auto &column = columns.GetColumn(duckdb::LogicalIndex(column_id));
+	return MakeDistinctCountStatistics(column.GetType(), distinct_count);
 }
 
 duckdb::TableFunction
 PostgresTable::GetScanFunction(duckdb::ClientContext &, duckdb::unique_ptr<duckdb::FunctionData> &bind_data) {
-	bind_data = duckdb::make_uniq<PostgresScanFunctionData>(rel, cardinality, snapshot);
+	auto scan_data = duckdb::make_uniq<PostgresScanFunctionData>(*this, rel, cardinality, GetTypes());
+	for (duckdb::column_t column_id = 0; column_id < columns.LogicalColumnCount(); column_id++) {
+		scan_data->distinct_counts.push_back(GetDistinctCount(column_id));
+	}
+	bind_data = std::move(scan_data);
 	return PostgresScanTableFunction();
 }
 
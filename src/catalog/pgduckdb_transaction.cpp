@@ -4,6 +4,9 @@
 #include "pgduckdb/catalog/pgduckdb_table.hpp"
 #include "pgduckdb/scan/postgres_scan.hpp"
 #include "pgduckdb/pg/relations.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_metadata_cache.hpp"
+#include "pgduckdb/pgduckdb_process_lock.hpp"
 
 #include "duckdb/parser/parsed_data/create_table_info.hpp"
 #include "duckdb/parser/parsed_data/create_schema_info.hpp"
@@ -31,6 +34,92 @@ SchemaItems::SchemaItems(duckdb::unique_ptr<PostgresSchema> &&_schema, const duc
     : name(_name), schema(std::move(_schema)), tables() {
 }
 
+namespace {
+
+/*
+ * Converting the columns of a Postgres table to DuckDB columns is relatively
+ * expensive, and most queries read the same tables over and over again. So
+ * the columns are cached for the rest of the backend's lifetime, until
+ * Postgres tells us that the table (or its schema) changed.
+ */
+struct CachedTable {
+	Oid relid;
+	bool valid;
+	/* The conversion of the column types depends on these too */
+	uint64_t metadata_cache_version;
+	bool convert_unsupported_numeric_to_double;
+	duckdb::ColumnList columns;
+};
+
+/* Indexed by schema name and then by table name */
+duckdb::unordered_map<duckdb::string, duckdb::unordered_map<duckdb::string, CachedTable>> cached_tables;
+
+bool
+IsCachedTableUsable(const CachedTable &table) {
+	return table.valid && table.metadata_cache_version == CacheVersion() &&
+	       table.convert_unsupported_numeric_to_double == duckdb_convert_unsupported_numeric_to_double;
+}
+
+/*
+ * Opens the relation of a cached table and fills in its columns. Returns
+ * nullptr if the cache can't be used for it.
+ */
+Relation
+OpenCachedTable(const duckdb::string &schema_name, const duckdb::string &table_name, duckdb::CreateTableInfo &info) {
+	/* Invalidation callbacks can run in any thread that calls into Postgres, but always under this lock */
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	auto schema_it = cached_tables.find(schema_name);
+	if (schema_it == cached_tables.end()) {
+		return nullptr;
+	}
+	auto table_it = schema_it->second.find(table_name);
+	if (table_it == schema_it->second.end() || !IsCachedTableUsable(table_it->second)) {
+		return nullptr;
+	}
+
+	/*
+	 * Locking the relation processes any pending invalidations, so only after
+	 * that we know if the table was dropped, renamed or altered in the meantime.
+	 */
+	auto &table = table_it->second;
+	Relation rel = PostgresTable::TryOpenRelation(table.relid);
+	if (!rel) {
+		return nullptr;
+	}
+	if (!IsCachedTableUsable(table)) {
+		PostgresTable::CloseRelation(rel);
+		return nullptr;
+	}
+
+	info.columns = table.columns.Copy();
+	return rel;
+}
+
+void
+CacheTable(const duckdb::string &schema_name, const duckdb::string &table_name, Oid relid,
+           const duckdb::ColumnList &columns) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	auto &table = cached_tables[schema_name][table_name];
+	table.relid = relid;
+	table.valid = true;
+	table.metadata_cache_version = CacheVersion();
+	table.convert_unsupported_numeric_to_double = duckdb_convert_unsupported_numeric_to_double;
+	table.columns = columns.Copy();
+}
+
+} // namespace
+
+void
+InvalidateCachedTables(Oid relid) {
+	for (auto &[schema_name, tables] : cached_tables) {
+		for (auto &[table_name, table] : tables) {
+			if (!IsValidOid(relid) || table.relid == relid) {
+				table.valid = false;
+			}
+		}
+	}
+}
+
 duckdb::optional_ptr<duckdb::CatalogEntry>
 SchemaItems::GetTable(const duckdb::string &entry_name) {
 	auto it = tables.find(entry_name);
@@ -38,17 +127,21 @@ SchemaItems::GetTable(const duckdb::string &entry_name) {
 		return it->second.get();
 	}
 
-	Oid rel_oid = GetRelidFromSchemaAndTable(name.c_str(), entry_name.c_str());
+	duckdb::CreateTableInfo info;
+	info.table = entry_name;
 
-	if (!IsValidOid(rel_oid)) {
-		return nullptr; // Table could not be found
-	}
+	Relation rel = OpenCachedTable(name, entry_name, info);
+	if (!rel) {
+		Oid rel_oid = GetRelidFromSchemaAndTable(name.c_str(), entry_name.c_str());
 
-	Relation rel = PostgresTable::OpenRelation(rel_oid);
+		if (!IsValidOid(rel_oid)) {
+			return nullptr; // Table could not be found
+		}
 
-	duckdb::CreateTableInfo info;
-	info.table = entry_name;
-	PostgresTable::SetTableInfo(info, rel);
+		rel = PostgresTable::OpenRelation(rel_oid);
+		PostgresTable::SetTableInfo(info, rel);
+		CacheTable(name, entry_name, rel_oid, info.columns);
+	}
 
 	auto cardinality = EstimateRelSize(rel);
 	tables.emplace(entry_name, duckdb::make_uniq<PostgresTable>(schema->catalog, *schema, info, rel, cardinality,
@@ -9,4 +9,9 @@ const char *
 GetErrorDataMessage(ErrorData *error_data) {
 	return error_data->message;
 }
+
+int
+GetErrorDataSqlErrcode(ErrorData *error_data) {
+	return error_data->sqlerrcode;
+}
 } // namespace pgduckdb::pg
@@ -1,15 +1,23 @@
 #include "pgduckdb/pg/relations.hpp"
 
+#include "pgduckdb/catalog/pgduckdb_transaction.hpp"
+#include "pgduckdb/pgduckdb_planner.hpp"
 #include "pgduckdb/pgduckdb_utils.hpp"
+#include "pgduckdb/scan/postgres_table_reader.hpp"
 
 extern "C" {
 #include "postgres.h"
 #include "access/htup_details.h" // GETSTRUCT
 #include "access/relation.h"     // relation_open and relation_close
 #include "catalog/namespace.h"   // makeRangeVarFromNameList, RangeVarGetRelid
+#include "catalog/pg_statistic.h"
 #include "optimizer/plancat.h"   // estimate_rel_size
+#include "optimizer/planner.h"   // standard_planner
+#include "tcop/tcopprot.h"       // pg_parse_query
 #include "utils/builtins.h"
+#include "utils/inval.h" // CacheRegisterRelcacheCallback
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/rls.h"
 #include "utils/resowner.h"    // CurrentResourceOwner and TopTransactionResourceOwner
@@ -95,6 +103,70 @@ OpenRelation(Oid relationId) {
 	return rel;
 }
 
+Relation
+TryOpenRelation(Oid relationId) {
+	/* See comment in OpenRelation */
+	ResourceOwner saveResourceOwner = CurrentResourceOwner;
+	CurrentResourceOwner = TopTransactionResourceOwner;
+	auto rel = PostgresFunctionGuard(try_relation_open, relationId, AccessShareLock);
+	CurrentResourceOwner = saveResourceOwner;
+	return rel;
+}
+
+Relation
+GetOpenRelation(Oid relationId) {
+	/* See comment in OpenRelation */
+	ResourceOwner saveResourceOwner = CurrentResourceOwner;
+	CurrentResourceOwner = TopTransactionResourceOwner;
+	auto rel = PostgresFunctionGuard(RelationIdGetRelation, relationId);
+	if (rel) {
+		PostgresFunctionGuard(RelationClose, rel);
+	}
+	CurrentResourceOwner = saveResourceOwner;
+
+	if (!rel) {
+		throw duckdb::InternalException("Relation with OID %u is not open", relationId);
+	}
+	return rel;
+}
+
+/*
+ * Invalidates everything that pg_duckdb caches about the relation, or about
+ * all relations if relid is InvalidOid: the DuckDB columns of Postgres
+ * tables, the plans of scan queries and the DuckDB statements that were
+ * prepared while planning.
+ */
+static void
+InvalidateRelationCaches(Oid relid) {
+	InvalidateCachedTables(relid);
+	InvalidateCachedScanPlans(relid);
+	InvalidatePlannedStatements(relid);
+}
+
+static void
+RelationInvalidationCallback(Datum /*arg*/, Oid relid) {
+	InvalidateRelationCaches(relid);
+}
+
+/*
+ * Renaming a schema doesn't invalidate the relations in it, even though their
+ * qualified name changes. So any change to a schema invalidates all relations.
+ */
+static void
+#if PG_VERSION_NUM >= 190000
+NamespaceInvalidationCallback(Datum /*arg*/, SysCacheIdentifier /*cache_id*/, uint32 /*hash_value*/) {
+#else
+NamespaceInvalidationCallback(Datum /*arg*/, int /*cache_id*/, uint32 /*hash_value*/) {
+#endif
+	InvalidateRelationCaches(InvalidOid);
+}
+
+void
+RegisterRelationInvalidationCallback() {
+	CacheRegisterRelcacheCallback(RelationInvalidationCallback, (Datum)0);
+	CacheRegisterSyscacheCallback(NAMESPACEOID, NamespaceInvalidationCallback, (Datum)0);
+}
+
 void
 CloseRelation(Relation rel) {
 	/*
@@ -123,6 +195,32 @@ EstimateRelSize(Relation rel) {
 	return cardinality;
 }
 
+static double
+PGEstimateColumnDistinctCount(Relation rel, AttrNumber attnum, double reltuples) {
+	/* Partitioned tables only have statistics that include their partitions */
+	bool inherited = rel->rd_rel->relkind == RELKIND_PARTITIONED_TABLE;
+	HeapTuple tuple = SearchSysCache3(STATRELATTINH, ObjectIdGetDatum(RelationGetRelid(rel)), Int16GetDatum(attnum),
+	                                  BoolGetDatum(inherited));
+	if (!HeapTupleIsValid(tuple)) {
+		return 0;
+	}
+
+	double stadistinct = ((Form_pg_statistic)GETSTRUCT(tuple))->stadistinct;
+	ReleaseSysCache(tuple);
+
+	/* A negative stadistinct is the negated fraction of the rows that are distinct */
+	if (stadistinct < 0) {
+		return -stadistinct * reltuples;
+	}
+
+	return stadistinct;
+}
+
+double
+EstimateColumnDistinctCount(Relation rel, AttrNumber attnum, double reltuples) {
+	return PostgresFunctionGuard(PGEstimateColumnDistinctCount, rel, attnum, reltuples);
+}
+
 static Oid
 PGGetRelidFromSchemaAndTable(const char *schema_name, const char *entry_name) {
 	List *name_list = NIL;
@@ -167,6 +265,48 @@ GenerateQualifiedRelationName(Relation rel) {
 	return PostgresFunctionGuard(GenerateQualifiedRelationName_Unsafe, rel);
 }
 
+static double
+PGEstimateFilteredRelSize(Relation rel, const char *quals) {
+	MemoryContext estimate_context = AllocSetContextCreate(CurrentMemoryContext, "PGDuckDB filtered size estimate",
+	                                                       ALLOCSET_SMALL_SIZES);
+	MemoryContext old_context = MemoryContextSwitchTo(estimate_context);
+	double rows = 0;
+
+	PG_TRY();
+	{
+		const char *query_string =
+		    psprintf("SELECT FROM %s WHERE %s", GenerateQualifiedRelationName_Unsafe(rel), quals);
+		RawStmt *raw_parsetree = linitial_node(RawStmt, pg_parse_query(query_string));
+#if PG_VERSION_NUM >= 150000
+		List *query_list = pg_analyze_and_rewrite_fixedparams(raw_parsetree, query_string, nullptr, 0, nullptr);
+#else
+		List *query_list = pg_analyze_and_rewrite(raw_parsetree, query_string, nullptr, 0, nullptr);
+#endif
+		Query *query = linitial_node(Query, query_list);
+
+		/* Only the estimate is needed, so skip the planner hooks (including our own) */
+#if PG_VERSION_NUM >= 190000
+		PlannedStmt *planned_stmt = standard_planner(query, query_string, 0, nullptr, nullptr);
+#else
+		PlannedStmt *planned_stmt = standard_planner(query, query_string, 0, nullptr);
+#endif
+		rows = planned_stmt->planTree->plan_rows;
+	}
+	PG_FINALLY();
+	{
+		MemoryContextSwitchTo(old_context);
+		MemoryContextDelete(estimate_context);
+	}
+	PG_END_TRY();
+
+	return rows;
+}
+
+double
+EstimateFilteredRelSize(Relation rel, const char *quals) {
+	return PostgresFunctionGuard(PGEstimateFilteredRelSize, rel, quals);
+}
+
 const char *
 QuoteIdentifier(const char *ident) {
 	return PostgresFunctionGuard(quote_identifier, ident);
@@ -177,6 +317,11 @@ GetRelationName(Relation rel) {
 	return RelationGetRelationName(rel);
 }
 
+Oid
+GetRelationOid(Relation rel) {
+	return RelationGetRelid(rel);
+}
+
 Oid
 GetOid(Form_pg_class rel) {
 	return rel->oid;
@@ -8,9 +8,15 @@ extern "C" {
 #include "miscadmin.h"
 }
 
+#include "pgduckdb/pgduckdb_admission.hpp"
 #include "pgduckdb/pgduckdb_background_worker.hpp"
+#include "pgduckdb/pgduckdb_generations.hpp"
+#include "pgduckdb/pgduckdb_memory_governor.hpp"
+#include "pgduckdb/pgduckdb_shared_engine.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
 #include "pgduckdb/pgduckdb_node.hpp"
 #include "pgduckdb/pgduckdb_xact.hpp"
+#include "pgduckdb/pg/relations.hpp"
 
 extern "C" {
 
@@ -37,6 +43,12 @@ _PG_init(void) {
 	DuckdbInitHooks();
 	DuckdbInitNode();
 	pgduckdb::InitBackgroundWorkersShmem();
+	pgduckdb::InitMemoryGovernorShmem();
+	pgduckdb::InitThreadGovernorShmem();
+	pgduckdb::InitAdmissionShmem();
+	pgduckdb::InitGenerationsShmem();
+	pgduckdb::InitSharedEngine();
 	pgduckdb::RegisterDuckdbXactCallback();
+	pgduckdb::RegisterRelationInvalidationCallback();
 }
 } // extern "C"
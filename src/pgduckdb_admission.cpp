@@ -0,0 +1,525 @@
+#include "pgduckdb/pgduckdb_admission.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+
+extern "C" {
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "postmaster/autovacuum.h"
+#include "replication/walsender.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/timestamp.h"
+#include "utils/wait_event.h"
+#if PG_VERSION_NUM >= 190000
+#include "storage/waiteventset.h"
+#endif
+}
+
+namespace pgduckdb {
+
+typedef enum DuckdbAdmissionState {
+	ADMISSION_IDLE = 0,
+	ADMISSION_WAITING,
+	ADMISSION_ACTIVE,
+} DuckdbAdmissionState;
+
+typedef struct DuckdbQueryAdmission {
+	pid_t pid; /* 0 if the slot is not used by any backend */
+	Oid database_id;
+	Oid role_id;
+	DuckdbAdmissionState state;
+	uint64 ticket;     /* waiting backends of the same database and role are admitted in ticket order */
+	TimestampTz since; /* when the backend started waiting, or was admitted */
+	Latch *latch;
+} DuckdbQueryAdmission;
+
+/*
+ * Every backend that executes DuckDB queries gets admitted first, so that
+ * the number of backends executing DuckDB queries stays within the limits of
+ * duckdb.max_active_queries_per_database and duckdb.max_active_queries_per_role.
+ * Backends that would go over a limit wait on their latch, which is set
+ * whenever another backend finishes its queries.
+ *
+ * The admissions are indexed by the number of the PGPROC of the backend.
+ * Checking the limits goes through all of them, so they are protected by an
+ * LWLock rather than a spinlock.
+ */
+typedef struct AdmissionShmemStruct {
+	LWLock lock; /* protects all the fields below */
+#if PG_VERSION_NUM < 190000
+	int tranche_id;
+#endif
+
+	uint64 next_ticket;
+	int64 admitted_queries;
+	int64 queued_queries;
+	int64 timed_out_queries;
+	int64 total_wait_time; /* in microseconds */
+	int64 max_wait_time;   /* in microseconds */
+	int num_admissions;
+	DuckdbQueryAdmission admissions[1]; /* actually num_admissions long */
+} AdmissionShmemStruct;
+
+static AdmissionShmemStruct *Admission;
+
+/* Shows up as the wait event of backends that wait for the lock */
+static const char *ADMISSION_LWLOCK_TRANCHE_NAME = "DuckdbAdmission";
+
+/* The number of queries of this backend that hold on to its admission */
+static int admitted_queries = 0;
+static bool set_up_release_admission_hook = false;
+
+static int
+NumAdmissions() {
+#if PG_VERSION_NUM >= 150000
+	return MaxBackends;
+#else
+	/* See NumReservations in pgduckdb_memory_governor.cpp */
+	return MaxConnections + autovacuum_max_workers + 1 + max_worker_processes + max_wal_senders;
+#endif
+}
+
+static int
+MyAdmissionIndex() {
+#if PG_VERSION_NUM >= 170000
+	return MyProcNumber;
+#else
+	return MyProc->pgprocno;
+#endif
+}
+
+static Size
+AdmissionShmemSize() {
+	return add_size(offsetof(AdmissionShmemStruct, admissions),
+	                mul_size(NumAdmissions(), sizeof(DuckdbQueryAdmission)));
+}
+
+static void
+InitAdmissionStruct() {
+	MemSet(Admission, 0, AdmissionShmemSize());
+#if PG_VERSION_NUM >= 190000
+	LWLockInitialize(&Admission->lock, LWLockNewTrancheId(ADMISSION_LWLOCK_TRANCHE_NAME));
+#else
+	Admission->tranche_id = LWLockNewTrancheId();
+	LWLockInitialize(&Admission->lock, Admission->tranche_id);
+#endif
+	Admission->num_admissions = NumAdmissions();
+}
+
+#if PG_VERSION_NUM >= 190000
+
+static void
+AdmissionShmemRequest(void * /*opaque_arg*/) {
+	ShmemStructOpts struct_opts = {
+	    .name = "DuckdbAdmission Data",
+	    .size = AdmissionShmemSize(),
+	    .ptr = (void **)&Admission,
+	};
+	ShmemRequestStructWithOpts(&struct_opts);
+}
+
+static void
+AdmissionShmemInit(void * /*opaque_arg*/) {
+	InitAdmissionStruct();
+}
+
+#else
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void
+AdmissionShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+#endif
+
+	RequestAddinShmemSpace(AdmissionShmemSize());
+}
+
+static void
+AdmissionShmemStartup(void) {
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	bool found;
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	Admission = (AdmissionShmemStruct *)ShmemInitStruct("DuckdbAdmission Data", AdmissionShmemSize(), &found);
+	if (!found) {
+		InitAdmissionStruct();
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	/* Tranche names are only known to the backends that registered them */
+	LWLockRegisterTranche(Admission->tranche_id, ADMISSION_LWLOCK_TRANCHE_NAME);
+}
+
+#endif
+
+void
+InitAdmissionShmem(void) {
+#if PG_VERSION_NUM >= 190000
+	/* See InitBackgroundWorkersShmem on why this is static */
+	static const ShmemCallbacks callbacks = {
+	    .request_fn = AdmissionShmemRequest,
+	    .init_fn = AdmissionShmemInit,
+	};
+	RegisterShmemCallbacks(&callbacks);
+#else
+#if PG_VERSION_NUM >= 150000
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = AdmissionShmemRequest;
+#else
+	AdmissionShmemRequest();
+#endif
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = AdmissionShmemStartup;
+#endif
+}
+
+static bool
+IsAdmissionControlEnabled() {
+	return (duckdb_max_active_queries_per_database > 0 || duckdb_max_active_queries_per_role > 0) &&
+	       Admission != NULL;
+}
+
+static uint32
+AdmissionWaitEvent() {
+#if PG_VERSION_NUM >= 170000
+	static uint32 wait_event = 0;
+	if (wait_event == 0) {
+		wait_event = WaitEventExtensionNew("DuckdbQueryAdmission");
+	}
+	return wait_event;
+#else
+	return PG_WAIT_EXTENSION;
+#endif
+}
+
+/* Wakes up the waiting backends, so they can check if they can be admitted now. Must be called with the lock held */
+static void
+WakeUpWaitingBackends() {
+	for (int i = 0; i < Admission->num_admissions; i++) {
+		auto &admission = Admission->admissions[i];
+		if (admission.state == ADMISSION_WAITING) {
+			SetLatch(admission.latch);
+		}
+	}
+}
+
+/* Must be called with the lock held */
+static void
+SetIdle(DuckdbQueryAdmission *admission) {
+	bool was_active = admission->state == ADMISSION_ACTIVE;
+	admission->state = ADMISSION_IDLE;
+	admission->since = 0;
+	if (was_active) {
+		WakeUpWaitingBackends();
+	}
+}
+
+static void
+ReleaseAdmissionSlot(int /*code*/, Datum /*arg*/) {
+	auto &admission = Admission->admissions[MyAdmissionIndex()];
+	LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+	SetIdle(&admission);
+	admission.pid = 0;
+	LWLockRelease(&Admission->lock);
+}
+
+/* Returns the admission slot of this backend, or NULL if its queries are not subject to admission control */
+static DuckdbQueryAdmission *
+MyAdmission() {
+	if (!IsAdmissionControlEnabled() || MyProc == NULL) {
+		return NULL;
+	}
+
+	int index = MyAdmissionIndex();
+	if (index < 0 || index >= Admission->num_admissions) {
+		return NULL;
+	}
+
+	if (!set_up_release_admission_hook) {
+		before_shmem_exit(ReleaseAdmissionSlot, 0);
+		set_up_release_admission_hook = true;
+	}
+	return &Admission->admissions[index];
+}
+
+/*
+ * Can the waiting backend be admitted, without going over any of the limits
+ * and without overtaking a backend of the same database and role that has
+ * been waiting longer? Must be called with the lock held.
+ */
+static bool
+CanBeAdmitted(DuckdbQueryAdmission *admission) {
+	int database_queries = 0;
+	int role_queries = 0;
+	for (int i = 0; i < Admission->num_admissions; i++) {
+		auto &other = Admission->admissions[i];
+		if (other.state == ADMISSION_ACTIVE) {
+			database_queries += other.database_id == admission->database_id;
+			role_queries += other.role_id == admission->role_id;
+		} else if (other.state == ADMISSION_WAITING && other.ticket < admission->ticket &&
+		           other.database_id == admission->database_id && other.role_id == admission->role_id) {
+			return false;
+		}
+	}
+
+	if (duckdb_max_active_queries_per_database > 0 && database_queries >= duckdb_max_active_queries_per_database) {
+		return false;
+	}
+	return duckdb_max_active_queries_per_role == 0 || role_queries < duckdb_max_active_queries_per_role;
+}
+
+/* Must be called with the lock held */
+static void
+RecordWaitTime(DuckdbQueryAdmission *admission, TimestampTz now) {
+	int64 wait_time = now - admission->since;
+	Admission->queued_queries++;
+	Admission->total_wait_time += wait_time;
+	Admission->max_wait_time = Max(Admission->max_wait_time, wait_time);
+}
+
+void
+AdmitDuckdbQuery(void) {
+	if (admitted_queries > 0) {
+		admitted_queries++;
+		return;
+	}
+
+	auto admission = MyAdmission();
+	if (!admission) {
+		admitted_queries++;
+		return;
+	}
+
+	LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+	admission->pid = MyProcPid;
+	admission->database_id = MyDatabaseId;
+	admission->role_id = GetSessionUserId();
+	admission->latch = MyLatch;
+	admission->ticket = Admission->next_ticket++;
+	admission->state = ADMISSION_WAITING;
+	admission->since = GetCurrentTimestamp();
+	bool admitted = CanBeAdmitted(admission);
+	if (admitted) {
+		admission->state = ADMISSION_ACTIVE;
+		Admission->admitted_queries++;
+	}
+	LWLockRelease(&Admission->lock);
+
+	if (admitted) {
+		admitted_queries++;
+		return;
+	}
+
+	TimestampTz wait_start = admission->since;
+	PG_TRY();
+	{
+		while (true) {
+			long timeout_ms = 1000;
+			TimestampTz now = GetCurrentTimestamp();
+			if (duckdb_admission_timeout > 0) {
+				long remaining_ms = TimestampDifferenceMilliseconds(now, TimestampTzPlusMilliseconds(
+				                                                             wait_start, duckdb_admission_timeout));
+				if (remaining_ms <= 0) {
+					LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+					Admission->timed_out_queries++;
+					LWLockRelease(&Admission->lock);
+					ereport(ERROR, (errcode(ERRCODE_QUERY_CANCELED),
+					                errmsg("canceling DuckDB query because it waited longer than "
+					                       "duckdb.admission_timeout for other DuckDB queries to finish")));
+				}
+				timeout_ms = Min(timeout_ms, remaining_ms);
+			}
+
+			LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+			admitted = CanBeAdmitted(admission);
+			if (admitted) {
+				RecordWaitTime(admission, now);
+				admission->state = ADMISSION_ACTIVE;
+				admission->since = now;
+				Admission->admitted_queries++;
+			}
+			LWLockRelease(&Admission->lock);
+
+			if (admitted) {
+				break;
+			}
+
+			(void)WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH, timeout_ms,
+			                AdmissionWaitEvent());
+			ResetLatch(MyLatch);
+			ProcessCancelInterrupts();
+		}
+	}
+	PG_CATCH();
+	{
+		/* Don't hold up the backends that are waiting behind us */
+		LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+		RecordWaitTime(admission, GetCurrentTimestamp());
+		SetIdle(admission);
+		WakeUpWaitingBackends();
+		LWLockRelease(&Admission->lock);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	admitted_queries++;
+}
+
+/*
+ * The DuckDB CustomScan holds cancel interrupts while it executes, so
+ * CHECK_FOR_INTERRUPTS doesn't act on pg_cancel_backend or statement_timeout.
+ * While a backend waits for admission nothing of the query has run yet
+ * though, so it can still be canceled like any other Postgres wait.
+ */
+void
+ProcessCancelInterrupts(void) {
+	if (!QueryCancelPending) {
+		CHECK_FOR_INTERRUPTS();
+		return;
+	}
+
+	uint32 holdoff = QueryCancelHoldoffCount;
+	QueryCancelHoldoffCount = 0;
+	CHECK_FOR_INTERRUPTS();
+	QueryCancelHoldoffCount = holdoff;
+}
+
+void
+ReleaseDuckdbQueryAdmission(void) {
+	if (admitted_queries == 0 || --admitted_queries > 0) {
+		return;
+	}
+
+	auto admission = MyAdmission();
+	if (!admission) {
+		return;
+	}
+
+	LWLockAcquire(&Admission->lock, LW_EXCLUSIVE);
+	SetIdle(admission);
+	LWLockRelease(&Admission->lock);
+}
+
+void
+ReleaseAllDuckdbQueryAdmissions(void) {
+	if (admitted_queries > 0) {
+		admitted_queries = 1;
+		ReleaseDuckdbQueryAdmission();
+	}
+}
+
+} // namespace pgduckdb
+
+extern "C" {
+
+DECLARE_PG_FUNCTION(duckdb_admission_queue) {
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL()) {
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext old_context = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		TupleDesc tupdesc;
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+			elog(ERROR, "return type must be a row type");
+		}
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* Copy all admissions at once, so that they are consistent with each other */
+		auto admission_shmem = pgduckdb::Admission;
+		int num_admissions = admission_shmem ? admission_shmem->num_admissions : 0;
+		auto admissions = (pgduckdb::DuckdbQueryAdmission *)palloc(Max(num_admissions, 1) *
+		                                                           sizeof(pgduckdb::DuckdbQueryAdmission));
+		int num_used = 0;
+		if (admission_shmem) {
+			LWLockAcquire(&admission_shmem->lock, LW_SHARED);
+			for (int i = 0; i < num_admissions; i++) {
+				if (admission_shmem->admissions[i].state != pgduckdb::ADMISSION_IDLE) {
+					admissions[num_used++] = admission_shmem->admissions[i];
+				}
+			}
+			LWLockRelease(&admission_shmem->lock);
+		}
+
+		funcctx->user_fctx = admissions;
+		funcctx->max_calls = num_used;
+		MemoryContextSwitchTo(old_context);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	if (funcctx->call_cntr < funcctx->max_calls) {
+		auto admissions = (pgduckdb::DuckdbQueryAdmission *)funcctx->user_fctx;
+		auto &admission = admissions[funcctx->call_cntr];
+
+		Datum values[5];
+		bool nulls[5] = {false, false, false, false, false};
+		values[0] = Int32GetDatum(admission.pid);
+		values[1] = ObjectIdGetDatum(admission.database_id);
+		values[2] = ObjectIdGetDatum(admission.role_id);
+		values[3] = CStringGetTextDatum(admission.state == pgduckdb::ADMISSION_ACTIVE ? "active" : "waiting");
+		values[4] = TimestampTzGetDatum(admission.since);
+		HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+DECLARE_PG_FUNCTION(duckdb_admission_stats) {
+	TupleDesc tupdesc;
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+		elog(ERROR, "return type must be a row type");
+	}
+
+	int active = 0;
+	int waiting = 0;
+	int64 admitted = 0;
+	int64 queued = 0;
+	int64 timed_out = 0;
+	int64 total_wait_time = 0;
+	int64 max_wait_time = 0;
+	auto admission_shmem = pgduckdb::Admission;
+	if (admission_shmem) {
+		LWLockAcquire(&admission_shmem->lock, LW_SHARED);
+		for (int i = 0; i < admission_shmem->num_admissions; i++) {
+			active += admission_shmem->admissions[i].state == pgduckdb::ADMISSION_ACTIVE;
+			waiting += admission_shmem->admissions[i].state == pgduckdb::ADMISSION_WAITING;
+		}
+		admitted = admission_shmem->admitted_queries;
+		queued = admission_shmem->queued_queries;
+		timed_out = admission_shmem->timed_out_queries;
+		total_wait_time = admission_shmem->total_wait_time;
+		max_wait_time = admission_shmem->max_wait_time;
+		LWLockRelease(&admission_shmem->lock);
+	}
+
+	Datum values[7];
+	bool nulls[7] = {false, false, false, false, false, false, false};
+	values[0] = Int32GetDatum(active);
+	values[1] = Int32GetDatum(waiting);
+	values[2] = Int64GetDatum(admitted);
+	values[3] = Int64GetDatum(queued);
+	values[4] = Int64GetDatum(timed_out);
+	/* Wait times are reported in milliseconds, like pg_stat_statements does */
+	values[5] = Float8GetDatum(total_wait_time / 1000.0);
+	values[6] = Float8GetDatum(max_wait_time / 1000.0);
+	HeapTuple tuple = heap_form_tuple(BlessTupleDesc(tupdesc), values, nulls);
+	PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
+} // extern "C"
@@ -45,6 +45,7 @@ extern "C" {
 #include "pgduckdb/pgduckdb_duckdb.hpp"
 #include "pgduckdb/pgduckdb_background_worker.hpp"
 #include "pgduckdb/pgduckdb_fdw.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
 #include "pgduckdb/pgduckdb_userdata_cache.hpp"
 #include "pgduckdb/utility/copy.hpp"
@@ -1057,24 +1058,33 @@ DuckdbHandleViewStmtPost(Node *parsetree) {
 	pgduckdb::ClaimCurrentCommandId(true);
 }
 
+/*
+ * Executes the COPY in DuckDB if possible, in which case this sets executed.
+ * Otherwise it returns the plan for DuckdbCopyToStdout, if that should
+ * execute the COPY.
+ */
+static PlannedStmt *
+DuckdbCopy_Cpp(PlannedStmt *pstmt, const char *query_string, struct QueryEnvironment *query_env, QueryCompletion *qc,
+               bool &executed, bool &binary) {
+	auto copy_query = PostgresFunctionGuard(MakeDuckdbCopyQuery, pstmt, query_string, query_env);
+	if (copy_query) {
+		auto res = pgduckdb::DuckDBQueryOrThrow(copy_query);
+		auto chunk = res->Fetch();
+		auto processed = chunk->GetValue(0, 0).GetValue<uint64_t>();
+		if (qc) {
+			SetQueryCompletion(qc, CMDTAG_COPY, processed);
+		}
+		executed = true;
+		return nullptr;
+	}
+
+	return PostgresFunctionGuard(PlanDuckdbCopyToStdout, pstmt, query_string, query_env, &binary);
+}
+
 static void
 DuckdbUtilityHook_Cpp(PlannedStmt *pstmt, const char *query_string, bool read_only_tree, ProcessUtilityContext context,
                       ParamListInfo params, struct QueryEnvironment *query_env, DestReceiver *dest,
                       QueryCompletion *qc) {
-	Node *parsetree = pstmt->utilityStmt;
-	if (IsA(parsetree, CopyStmt)) {
-		auto copy_query = PostgresFunctionGuard(MakeDuckdbCopyQuery, pstmt, query_string, query_env);
-		if (copy_query) {
-			auto res = pgduckdb::DuckDBQueryOrThrow(copy_query);
-			auto chunk = res->Fetch();
-			auto processed = chunk->GetValue(0, 0).GetValue<uint64_t>();
-			if (qc) {
-				SetQueryCompletion(qc, CMDTAG_COPY, processed);
-			}
-			return;
-		}
-	}
-
 	/*
 	 * We need this prev_top_level_ddl variable because its possible that the
 	 * first DDL command then triggers a second DDL command. The first of which
@@ -1149,6 +1159,22 @@ DuckdbUtilityHook(PlannedStmt *pstmt, const char *query_string, bool read_only_t
 		return prev_process_utility_hook(pstmt, query_string, read_only_tree, context, params, query_env, dest, qc);
 	}
 
+	if (IsA(pstmt->utilityStmt, CopyStmt)) {
+		bool executed = false;
+		bool binary = false;
+		PlannedStmt *copy_to_stdout_plan =
+		    InvokeCPPFunc(DuckdbCopy_Cpp, pstmt, query_string, query_env, qc, executed, binary);
+		if (executed) {
+			return;
+		}
+
+		/* The executor runs outside of InvokeCPPFunc, like for any other query, so without the process lock */
+		if (copy_to_stdout_plan) {
+			DuckdbCopyToStdout(copy_to_stdout_plan, query_string, query_env, binary, qc);
+			return;
+		}
+	}
+
 	InvokeCPPFunc(DuckdbUtilityHook_Cpp, pstmt, query_string, read_only_tree, context, params, query_env, dest, qc);
 }
 
@@ -1163,6 +1189,10 @@ DuckdbInitUtilityHook() {
  */
 void
 DuckdbTruncateTable(Oid relation_oid) {
+	if (PostgresFunctionGuard(pgduckdb::IsLocalStorageTable, relation_oid)) {
+		pgduckdb::AttachLocalStorage(true);
+	}
+
 	auto name = PostgresFunctionGuard(pgduckdb_relation_name, relation_oid);
 	pgduckdb::DuckDBQueryOrThrow(std::string("TRUNCATE ") + name);
 }
@@ -1287,10 +1317,15 @@ DECLARE_PG_FUNCTION(duckdb_create_table_trigger) {
 	if (is_temporary) {
 		pgduckdb::RegisterDuckdbTempTable(relid);
 	} else {
-		if (!pgduckdb::IsMotherDuckEnabled()) {
+		if (!pgduckdb::IsMotherDuckEnabled() && !pgduckdb::duckdb_local_storage) {
 			elog(ERROR, "Only TEMP tables are supported in DuckDB if MotherDuck support is not enabled");
 		}
 
+		if (pgduckdb::duckdb_local_storage) {
+			/* The CREATE TABLE is forwarded to the DuckDB database file, so it's attached for writing */
+			pgduckdb::AttachLocalStorage(true);
+		}
+
 		Oid saved_userid;
 		int sec_context;
 		const char *postgres_schema_name = get_namespace_name_or_temp(get_rel_namespace(relid));
@@ -1323,13 +1358,15 @@ DECLARE_PG_FUNCTION(duckdb_create_table_trigger) {
 			elog(ERROR, "SPI_exec failed: error code %s", SPI_result_code_string(ret));
 		}
 
-		ObjectAddress table_address = {
-		    .classId = RelationRelationId,
-		    .objectId = relid,
-		    .objectSubId = 0,
-		};
-		pgduckdb::RecordDependencyOnMDServer(&table_address);
-		ATExecChangeOwner(relid, pgduckdb::MotherDuckPostgresUserOid(), false, AccessExclusiveLock);
+		if (!pgduckdb::duckdb_local_storage) {
+			ObjectAddress table_address = {
+			    .classId = RelationRelationId,
+			    .objectId = relid,
+			    .objectSubId = 0,
+			};
+			pgduckdb::RecordDependencyOnMDServer(&table_address);
+			ATExecChangeOwner(relid, pgduckdb::MotherDuckPostgresUserOid(), false, AccessExclusiveLock);
+		}
 	}
 
 	AtEOXact_GUC(false, save_nestlevel);
@@ -1573,8 +1610,15 @@ DECLARE_PG_FUNCTION(duckdb_drop_trigger) {
 	 * actually cause the tables to be dropped in MotherDuck as well, even if
 	 * the DROP is only meant to replace the existing Postgres shell table with
 	 * a new version.
+	 *
+	 * With duckdb.local_storage the tables are stored in the DuckDB database
+	 * file of this Postgres database instead, so there they're always dropped.
 	 */
-	if (pgduckdb::IsMotherDuckEnabled() && !pgduckdb::doing_motherduck_sync) {
+	if ((pgduckdb::IsMotherDuckEnabled() || pgduckdb::duckdb_local_storage) && !pgduckdb::doing_motherduck_sync) {
+		if (pgduckdb::duckdb_local_storage && SPI_processed > 0) {
+			pgduckdb::AttachLocalStorage(true);
+		}
+
 		for (uint64_t proc = 0; proc < SPI_processed; ++proc) {
 			if (!connection) {
 				/* We're going to run multiple queries in DuckDB, so we need to
@@ -1777,6 +1821,10 @@ DECLARE_PG_FUNCTION(duckdb_alter_table_trigger) {
 	/* Forcibly allow whatever writes Postgres did for this command */
 	pgduckdb::ClaimCurrentCommandId(true);
 
+	if (pgduckdb::IsLocalStorageTable(relid)) {
+		pgduckdb::AttachLocalStorage(true);
+	}
+
 	/* We're going to run multiple queries in DuckDB, so we need to start a
 	 * transaction to ensure ACID guarantees hold. */
 	auto connection = pgduckdb::DuckDBManager::GetConnection(true);
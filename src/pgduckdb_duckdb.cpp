@@ -15,8 +15,12 @@
 #include "pgduckdb/pg/transactions.hpp"
 #include "pgduckdb/pgduckdb_background_worker.hpp"
 #include "pgduckdb/pgduckdb_fdw.hpp"
+#include "pgduckdb/pgduckdb_generations.hpp"
 #include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
+#include "pgduckdb/pgduckdb_memory_governor.hpp"
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
+#include "pgduckdb/pgduckdb_planner.hpp"
 #include "pgduckdb/pgduckdb_extensions.hpp"
 #include "pgduckdb/pgduckdb_secrets_helper.hpp"
 #include "pgduckdb/pgduckdb_unsupported_type_optimizer.hpp"
@@ -30,6 +34,7 @@
 extern "C" {
 #include "postgres.h"
 
+#include "access/xlog.h" // RecoveryInProgress
 #include "catalog/namespace.h"
 #include "common/file_perm.h"
 #include "lib/stringinfo.h"
@@ -120,7 +125,12 @@ DuckDBManager::Initialize() {
 	SET_DUCKDB_OPTION(temp_directory);
 	SET_DUCKDB_OPTION(extension_directory);
 
-	if (duckdb_maximum_memory > 0) {
+	auto reserved_memory = ReserveInitialDuckdbMemory();
+	if (reserved_memory.IsValid()) {
+		config.options.maximum_memory = reserved_memory.GetIndex();
+		elog(DEBUG2, "[PGDuckDB] Set DuckDB option: 'maximum_memory'=%lluB reserved from duckdb.max_memory_global",
+		     (unsigned long long)reserved_memory.GetIndex());
+	} else if (duckdb_maximum_memory > 0) {
 		// Convert the memory limit from MB (as set by Postgres GUC_UNIT_MB, which is actually MiB; see
 		// memory_unit_conversion_table in guc.c) to a string with the "MiB" suffix, as required by DuckDB's memory
 		// parser. This ensures the value is interpreted correctly by DuckDB.
@@ -186,6 +196,10 @@ DuckDBManager::Initialize() {
 	auto &dbconfig = duckdb::DBConfig::GetConfig(*database->instance);
 	duckdb::StorageExtension::Register(dbconfig, "pgduckdb", duckdb::make_shared_ptr<PostgresStorageExtension>());
 
+	if (duckdb_local_storage) {
+		RegisterLocalStorageFileSystem(*database->instance);
+	}
+
 	// Register the unsupported type optimizer to run after all other optimizations
 	duckdb::OptimizerExtension::Register(dbconfig, UnsupportedTypeOptimizer::GetOptimizerExtension());
 
@@ -208,9 +222,6 @@ DuckDBManager::Initialize() {
 	pgduckdb::DuckDBQueryOrThrow(context, "ATTACH DATABASE 'pgduckdb' (TYPE pgduckdb)");
 	pgduckdb::DuckDBQueryOrThrow(context, "ATTACH DATABASE ':memory:' AS pg_temp;");
 
-	// Force initialize the SecretManager while LocalFileSystem is still permitted.
-	pgduckdb::DuckDBQueryOrThrow(context, "SELECT count(*) FROM duckdb_secrets();");
-
 	if (pgduckdb::IsMotherDuckEnabled()) {
 		auto timeout = FindMotherDuckBackgroundCatalogRefreshInactivityTimeout();
 		if (timeout != nullptr) {
@@ -220,10 +231,14 @@ DuckDBManager::Initialize() {
 		}
 	}
 
-	if (duckdb_autoinstall_known_extensions) {
-		InstallExtensions(context);
+	/*
+	 * Extensions can only be loaded while external access is still enabled,
+	 * so that disables lazy initialization.
+	 */
+	deferred_state_pending = duckdb_lazy_initialization && duckdb_enable_external_access;
+	if (!deferred_state_pending) {
+		LoadDeferredState(context);
 	}
-	LoadExtensions(context);
 
 	/* Set allowed_directories and enable_external_access AFTER loading extensions
 	 * (extensions need filesystem access to install/load). Set allowed_directories
@@ -255,9 +270,14 @@ DuckDBManager::Initialize() {
 
 void
 DuckDBManager::Reset() {
+	DropPlannedDuckdbStatements();
 	manager_instance.connection = nullptr;
 	delete manager_instance.database;
 	manager_instance.database = nullptr;
+	manager_instance.loaded_extensions_generation = 0;
+	manager_instance.loaded_extensions_table_seq = 0;
+	manager_instance.applied_disabled_filesystems.clear();
+	manager_instance.applied_azure_transport_option_type.clear();
 	UnclaimBgwSessionHint();
 }
 
@@ -268,6 +288,21 @@ GetSeqLastValue(const char *seq_name) {
 	return PostgresFunctionGuard(DirectFunctionCall1Coll, pg_sequence_last_value, InvalidOid, table_seq_oid);
 }
 
+/*
+ * The generation of duckdb.extensions is only bumped by the transactions of
+ * this server, so a hot standby doesn't notice the changes that it replays
+ * from the primary. There the trigger of the table bumping its sequence is
+ * used instead, like before the generation existed. Returns 0 when the
+ * server is not a standby, so that the sequence isn't read on every query.
+ */
+static int64
+ExtensionsTableSeqOnStandby() {
+	if (!RecoveryInProgress()) {
+		return 0;
+	}
+	return GetSeqLastValue("extensions_table_seq");
+}
+
 void
 DuckDBManager::LoadSecrets(duckdb::ClientContext &context) {
 	auto queries = InvokeCPPFunc(pg::ListDuckDBCreateSecretQueries);
@@ -288,6 +323,29 @@ DuckDBManager::DropSecrets(duckdb::ClientContext &context) {
 	}
 }
 
+/*
+ * Loads the state of the DuckDB instance that queries which only read
+ * Postgres tables don't need: the DuckDB extensions of duckdb.extensions, and
+ * the secrets. This is done when the instance is created, unless
+ * duckdb.lazy_initialization defers it to the first query that needs it.
+ */
+void
+DuckDBManager::LoadDeferredState(duckdb::ClientContext &context) {
+	// Force initialize the SecretManager while LocalFileSystem is still permitted.
+	pgduckdb::DuckDBQueryOrThrow(context, "SELECT count(*) FROM duckdb_secrets();");
+
+	const auto extensions_generation = GetExtensionsGeneration();
+	const auto extensions_table_seq = ExtensionsTableSeqOnStandby();
+	if (duckdb_autoinstall_known_extensions) {
+		InstallExtensions(context);
+	}
+	LoadExtensions(context);
+	loaded_extensions_generation = extensions_generation;
+	loaded_extensions_table_seq = extensions_table_seq;
+
+	deferred_state_pending = false;
+}
+
 void
 DuckDBManager::LoadExtensions(duckdb::ClientContext &context) {
 	auto duckdb_extensions = ReadDuckdbExtensions();
@@ -331,9 +389,15 @@ DisabledFileSystems() {
 }
 
 void
-DuckDBManager::RefreshConnectionState(duckdb::ClientContext &context) {
+DuckDBManager::RefreshConnectionState(duckdb::ClientContext &context, bool needs_extensions) {
 	std::string disabled_filesystems = DisabledFileSystems();
-	if (disabled_filesystems != "") {
+	if (deferred_state_pending && (needs_extensions || disabled_filesystems != "")) {
+		/* Loading extensions and secrets needs the LocalFileSystem, which might be disabled below */
+		LoadDeferredState(context);
+	}
+
+	/* The settings below only need to be sent to DuckDB when they changed since the last query */
+	if (disabled_filesystems != "" && disabled_filesystems != applied_disabled_filesystems) {
 		/*
 		 * DuckDB does not allow us to disable this setting on the
 		 * database after the DuckDB connection is created for a non
@@ -345,18 +409,40 @@ DuckDBManager::RefreshConnectionState(duckdb::ClientContext &context) {
 		 */
 		pgduckdb::DuckDBQueryOrThrow(context, "SET disabled_filesystems=" +
 		                                          duckdb::KeywordHelper::WriteQuoted(disabled_filesystems));
+		applied_disabled_filesystems = disabled_filesystems;
+	}
+
+	/*
+	 * Unlike DuckDB's default, let hash joins push a few thousand keys into the
+	 * scan of the other side. For Postgres scans these become an IN list, for
+	 * which Postgres can use an index instead of scanning the whole table.
+	 */
+	duckdb::Value dynamic_or_filter_threshold;
+	if (!context.TryGetCurrentSetting("dynamic_or_filter_threshold", dynamic_or_filter_threshold) ||
+	    dynamic_or_filter_threshold.GetValue<int64_t>() != duckdb_dynamic_or_filter_threshold) {
+		pgduckdb::DuckDBQueryOrThrow(context, "SET dynamic_or_filter_threshold=" +
+		                                          std::to_string(duckdb_dynamic_or_filter_threshold));
 	}
 
-	if (strlen(duckdb_azure_transport_option_type) > 0) {
+	if (strlen(duckdb_azure_transport_option_type) > 0 &&
+	    applied_azure_transport_option_type != duckdb_azure_transport_option_type) {
 		pgduckdb::DuckDBQueryOrThrow(context,
 		                             "SET azure_transport_option_type=" +
 		                                 duckdb::KeywordHelper::WriteQuoted(duckdb_azure_transport_option_type));
+		applied_azure_transport_option_type = duckdb_azure_transport_option_type;
 	}
 
-	const auto extensions_table_last_seq = GetSeqLastValue("extensions_table_seq");
-	if (IsExtensionsSeqLessThan(extensions_table_last_seq)) {
+	if (deferred_state_pending) {
+		return;
+	}
+
+	const auto extensions_generation = GetExtensionsGeneration();
+	const auto extensions_table_seq = ExtensionsTableSeqOnStandby();
+	if (extensions_generation != loaded_extensions_generation ||
+	    extensions_table_seq != loaded_extensions_table_seq) {
 		LoadExtensions(context);
-		UpdateExtensionsSeq(extensions_table_last_seq);
+		loaded_extensions_generation = extensions_generation;
+		loaded_extensions_table_seq = extensions_table_seq;
 	}
 
 	if (!secrets_valid) {
@@ -384,13 +470,19 @@ DuckDBManager::CreateConnection() {
 	return connection;
 }
 
-/* Returns the cached connection to the global DuckDB instance. */
+/*
+ * Returns the cached connection to the global DuckDB instance. Pass
+ * needs_extensions=false for queries that only read Postgres tables, which
+ * with duckdb.lazy_initialization don't load the extensions and secrets yet.
+ */
 duckdb::Connection *
-DuckDBManager::GetConnection(bool force_transaction) {
+DuckDBManager::GetConnection(bool force_transaction, bool needs_extensions) {
 	pgduckdb::RequireDuckdbExecution();
+	MaterializeStreamingDuckdbScans();
 
 	auto &instance = Get();
 	auto &context = *instance.connection->context;
+	ReserveDuckdbMemory(*instance.database->instance);
 
 	if (!context.transaction.HasActiveTransaction()) {
 		if (IsSubTransaction()) {
@@ -411,7 +503,7 @@ DuckDBManager::GetConnection(bool force_transaction) {
 		}
 	}
 
-	instance.RefreshConnectionState(context);
+	instance.RefreshConnectionState(context, needs_extensions);
 
 	return instance.connection.get();
 }
@@ -27,6 +27,7 @@ extern "C" {
 #include "pgduckdb/pg/string_utils.hpp"
 #include "pgduckdb/pgduckdb_background_worker.hpp"
 #include "pgduckdb/pgduckdb_fdw.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
 #include "pgduckdb/pgduckdb_secrets_helper.hpp"
 #include "pgduckdb/pgduckdb_userdata_cache.hpp"
 
@@ -248,6 +249,10 @@ ValidateMotherduckServerFdw(List *options_list, Oid context) {
 	// TODO: take a global lock to make this check
 	ValidateHasNoMotherduckForeignServer();
 
+	if (pgduckdb::duckdb_local_storage) {
+		elog(ERROR, "Cannot create a MotherDuck server, because duckdb.local_storage is enabled");
+	}
+
 	ValidateMdOptions(options_list, context);
 
 	// Validate tables_owner_role
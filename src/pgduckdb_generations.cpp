@@ -0,0 +1,173 @@
+#include "pgduckdb/pgduckdb_generations.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+
+extern "C" {
+#include "postgres.h"
+#include "access/xact.h"
+#include "fmgr.h"
+#include "port/atomics.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+}
+
+namespace pgduckdb {
+
+/*
+ * Counters that are bumped whenever state that every DuckDB instance copies
+ * from Postgres changes. Backends compare them to the generation they last
+ * loaded, so checking for changes doesn't need any catalog access.
+ */
+typedef struct GenerationsShmemStruct {
+	pg_atomic_uint64 extensions;
+} GenerationsShmemStruct;
+
+static GenerationsShmemStruct *Generations;
+
+/* Does the current transaction need to bump the generation of duckdb.extensions when it commits? */
+static bool bump_extensions_at_commit = false;
+static bool registered_xact_callback = false;
+
+static Size
+GenerationsShmemSize() {
+	return sizeof(GenerationsShmemStruct);
+}
+
+static void
+InitGenerationsStruct() {
+	/* Backends start at generation 0, so the first generation makes them load everything */
+	pg_atomic_init_u64(&Generations->extensions, 1);
+}
+
+#if PG_VERSION_NUM >= 190000
+
+static void
+GenerationsShmemRequest(void * /*opaque_arg*/) {
+	ShmemStructOpts struct_opts = {
+	    .name = "DuckdbGenerations Data",
+	    .size = GenerationsShmemSize(),
+	    .ptr = (void **)&Generations,
+	};
+	ShmemRequestStructWithOpts(&struct_opts);
+}
+
+static void
+GenerationsShmemInit(void * /*opaque_arg*/) {
+	InitGenerationsStruct();
+}
+
+#else
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void
+GenerationsShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+#endif
+
+	RequestAddinShmemSpace(GenerationsShmemSize());
+}
+
+static void
+GenerationsShmemStartup(void) {
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	bool found;
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	Generations = (GenerationsShmemStruct *)ShmemInitStruct("DuckdbGenerations Data", GenerationsShmemSize(), &found);
+	if (!found) {
+		InitGenerationsStruct();
+	}
+	LWLockRelease(AddinShmemInitLock);
+}
+
+#endif
+
+void
+InitGenerationsShmem(void) {
+#if PG_VERSION_NUM >= 190000
+	/* See InitBackgroundWorkersShmem on why this is static */
+	static const ShmemCallbacks callbacks = {
+	    .request_fn = GenerationsShmemRequest,
+	    .init_fn = GenerationsShmemInit,
+	};
+	RegisterShmemCallbacks(&callbacks);
+#else
+#if PG_VERSION_NUM >= 150000
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = GenerationsShmemRequest;
+#else
+	GenerationsShmemRequest();
+#endif
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = GenerationsShmemStartup;
+#endif
+}
+
+uint64_t
+GetExtensionsGeneration(void) {
+	return pg_atomic_read_u64(&Generations->extensions);
+}
+
+static void
+GenerationsXactCallback(XactEvent event, void * /*arg*/) {
+	if (!bump_extensions_at_commit) {
+		return;
+	}
+
+	switch (event) {
+	case XACT_EVENT_COMMIT:
+	case XACT_EVENT_PARALLEL_COMMIT:
+		pg_atomic_fetch_add_u64(&Generations->extensions, 1);
+		bump_extensions_at_commit = false;
+		break;
+	case XACT_EVENT_PRE_PREPARE:
+		/*
+		 * The change only becomes visible at COMMIT PREPARED, which might run
+		 * in another backend or after a restart, where this callback can't
+		 * bump the generation anymore.
+		 */
+		ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+		                errmsg("cannot PREPARE a transaction that changed duckdb.extensions")));
+		break;
+	case XACT_EVENT_ABORT:
+	case XACT_EVENT_PARALLEL_ABORT:
+		bump_extensions_at_commit = false;
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Bumps the generation right away, so that this backend loads the changed
+ * extensions in its next query already. Other backends can't see the change
+ * until the transaction commits though, so it's bumped again at that point.
+ */
+void
+BumpExtensionsGeneration(void) {
+	if (!registered_xact_callback) {
+		RegisterXactCallback(GenerationsXactCallback, NULL);
+		registered_xact_callback = true;
+	}
+
+	pg_atomic_fetch_add_u64(&Generations->extensions, 1);
+	bump_extensions_at_commit = true;
+}
+
+} // namespace pgduckdb
+
+extern "C" {
+
+DECLARE_PG_FUNCTION(duckdb_invalidate_extensions) {
+	pgduckdb::BumpExtensionsGeneration();
+	PG_RETURN_VOID();
+}
+
+} // extern "C"
@@ -122,14 +122,27 @@ bool duckdb_unsafe_allow_execution_inside_functions = false;
 bool duckdb_unsafe_allow_mixed_transactions = false;
 bool duckdb_convert_unsupported_numeric_to_double = false;
 bool duckdb_log_pg_explain = false;
+bool duckdb_columnar_worker_transport = true;
+int duckdb_dynamic_or_filter_threshold = 4096;
+int duckdb_max_cached_scan_plans = 1024;
 int duckdb_threads_for_postgres_scan = 2;
 int duckdb_max_workers_per_postgres_scan = 2;
 char *duckdb_motherduck_session_hint = strdup("");
 char *duckdb_postgres_role = strdup("");
 bool duckdb_force_motherduck_views = false;
+bool duckdb_lazy_initialization = false;
+bool duckdb_local_storage = false;
 
 int duckdb_threads = -1;
 int duckdb_maximum_memory = 4096; /* 4GB in MB */
+int duckdb_max_memory_global = 0;
+int duckdb_max_threads_global = 0;
+int duckdb_thread_priority = 1;
+int duckdb_max_active_queries_per_database = 0;
+int duckdb_max_active_queries_per_role = 0;
+int duckdb_admission_timeout = 0;
+char *duckdb_shared_engine_database = strdup("");
+bool duckdb_use_shared_engine = true;
 char *duckdb_disabled_filesystems = strdup("");
 char *duckdb_allowed_directories = strdup("");
 bool duckdb_enable_external_access = true;
@@ -170,6 +183,15 @@ InitGUC() {
 	DefineCustomVariable("duckdb.max_workers_per_postgres_scan",
 	                     "Maximum number of PostgreSQL workers used for a single Postgres scan",
 	                     &duckdb_max_workers_per_postgres_scan, 0, MAX_PARALLEL_WORKER_LIMIT);
+	DefineCustomVariable("duckdb.columnar_worker_transport",
+	                     "Let PostgreSQL workers of a Postgres scan send their results as DuckDB columnar batches",
+	                     &duckdb_columnar_worker_transport);
+	DefineCustomVariable("duckdb.dynamic_or_filter_threshold",
+	                     "Maximum number of join keys that a hash join pushes into the scan of the other side",
+	                     &duckdb_dynamic_or_filter_threshold, 0, INT_MAX);
+	DefineCustomVariable("duckdb.max_cached_scan_plans",
+	                     "Maximum number of Postgres scan plans that a connection keeps for later scans",
+	                     &duckdb_max_cached_scan_plans, 0, INT_MAX);
 
 	DefineCustomVariable("duckdb.postgres_role",
 	                     "Which postgres role should be allowed to use DuckDB execution, use the secrets and create "
@@ -180,6 +202,11 @@ InitGUC() {
 	                     "Force all views to be created in MotherDuck, even if they don't use MotherDuck tables",
 	                     &duckdb_force_motherduck_views);
 
+	DefineCustomVariable("duckdb.lazy_initialization",
+	                     "Only load the DuckDB extensions and secrets once a query needs them, instead of when the "
+	                     "DuckDB instance is created",
+	                     &duckdb_lazy_initialization, PGC_SUSET);
+
 	/* GUCs acting on DuckDB instance */
 	DefineCustomDuckDBVariable("duckdb.enable_external_access", "Allow the DuckDB to access external state.",
 	                           &duckdb_enable_external_access, PGC_SUSET);
@@ -208,6 +235,11 @@ InitGUC() {
 	    "The maximum memory DuckDB can use in MB (e.g., 4096 for 4GB), alias for duckdb.max_memory",
 	    &duckdb_maximum_memory, 0, INT_MAX, PGC_SUSET, GUC_UNIT_MB);
 
+	DefineCustomVariable("duckdb.max_memory_global",
+	                     "The maximum memory the DuckDB instances of all connections can use together in MB, "
+	                     "0 to disable",
+	                     &duckdb_max_memory_global, 0, INT_MAX, PGC_POSTMASTER, GUC_UNIT_MB);
+
 	DefineCustomDuckDBVariable(
 	    "duckdb.temporary_directory",
 	    "Set the directory to which DuckDB write temp files, alias for duckdb.temporary_directory",
@@ -230,6 +262,42 @@ InitGUC() {
 	                           "Maximum number of DuckDB threads per Postgres backend, alias for duckdb.threads",
 	                           &duckdb_threads, -1, 1024, PGC_SUSET);
 
+	DefineCustomVariable("duckdb.max_threads_global",
+	                     "The maximum number of DuckDB threads and Postgres scan workers of all connections together, "
+	                     "0 to disable",
+	                     &duckdb_max_threads_global, 0, INT_MAX, PGC_POSTMASTER);
+	DefineCustomVariable("duckdb.thread_priority",
+	                     "The share of duckdb.max_threads_global that a connection gets, relative to the other "
+	                     "connections",
+	                     &duckdb_thread_priority, 1, 100, PGC_SUSET);
+
+	DefineCustomVariable("duckdb.max_active_queries_per_database",
+	                     "The maximum number of connections that execute DuckDB queries in the same database at the "
+	                     "same time, 0 to disable",
+	                     &duckdb_max_active_queries_per_database, 0, INT_MAX, PGC_SIGHUP);
+	DefineCustomVariable("duckdb.max_active_queries_per_role",
+	                     "The maximum number of connections of the same role that execute DuckDB queries at the same "
+	                     "time, 0 to disable",
+	                     &duckdb_max_active_queries_per_role, 0, INT_MAX, PGC_SIGHUP);
+	DefineCustomVariable("duckdb.admission_timeout",
+	                     "How long a DuckDB query waits for other DuckDB queries to finish before it fails, 0 to wait "
+	                     "forever",
+	                     &duckdb_admission_timeout, 0, INT_MAX, PGC_USERSET, GUC_UNIT_MS);
+
+	DefineCustomVariable("duckdb.shared_engine_database",
+	                     "The database that the background worker of the shared DuckDB engine connects to, empty to "
+	                     "disable the shared engine",
+	                     &duckdb_shared_engine_database, PGC_POSTMASTER, GUC_SUPERUSER_ONLY);
+	DefineCustomVariable("duckdb.use_shared_engine",
+	                     "Execute DuckDB queries that don't read Postgres tables in the shared DuckDB engine, when "
+	                     "it's running",
+	                     &duckdb_use_shared_engine);
+
+	DefineCustomVariable("duckdb.local_storage",
+	                     "Store the tables that use the duckdb access method in a DuckDB database file in the data "
+	                     "directory, instead of in MotherDuck",
+	                     &duckdb_local_storage, PGC_POSTMASTER);
+
 	DefineCustomDuckDBVariable("duckdb.default_collation",
 	                           "The default collation to use for DuckDB queries, e.g., 'en_us'",
 	                           &duckdb_default_collation, PGC_SUSET);
@@ -10,6 +10,8 @@
 extern "C" {
 #include "postgres.h"
 
+#include "access/parallel.h"
+#include "executor/executor.h"
 #include "catalog/pg_namespace.h"
 #include "commands/extension.h"
 #include "nodes/nodes.h"
@@ -35,10 +37,12 @@ extern "C" {
 #include "pgduckdb/vendor/pg_explain.hpp"
 #include "pgduckdb/vendor/pg_list.hpp"
 #include "pgduckdb/pgduckdb_node.hpp"
+#include "pgduckdb/scan/postgres_columnar_batch.hpp"
 #include "pgduckdb/utility/cpp_wrapper.hpp"
 
 static planner_hook_type prev_planner_hook = NULL;
 static ExecutorStart_hook_type prev_executor_start_hook = NULL;
+static ExecutorRun_hook_type prev_executor_run_hook = NULL;
 static ExecutorFinish_hook_type prev_executor_finish_hook = NULL;
 static ExplainOneQuery_hook_type prev_explain_one_query_hook = NULL;
 static emit_log_hook_type prev_emit_log_hook = NULL;
@@ -210,6 +214,15 @@ NeedsDuckdbExecution(Query *query) {
 	return ContainsDuckdbItems((Node *)query, NULL);
 }
 
+/*
+ * A query that only reads Postgres tables, with Postgres functions, can't use
+ * any DuckDB extension or secret. All other queries are assumed to need them.
+ */
+bool
+NeedsDuckdbExtensions(const Query *query) {
+	return !duckdb_lazy_initialization || ContainsDuckdbItems((Node *)query, NULL);
+}
+
 bool
 IsCatalogTable(Relation rel) {
 	auto namespace_oid = RelationGetNamespace(rel);
@@ -380,6 +393,13 @@ DuckdbExecutorStartHook_Cpp(QueryDesc *queryDesc) {
 static void
 DuckdbExecutorStartHook(QueryDesc *queryDesc, int eflags) {
 	pgduckdb::executor_nest_level++;
+	if (IsParallelWorker()) {
+		prev_executor_start_hook(queryDesc, eflags);
+		/* This might be a worker of one of our Postgres scans, which should send columnar batches */
+		InvokeCPPFunc(pgduckdb::MaybeUseColumnarWorkerTransport, queryDesc);
+		return;
+	}
+
 	if (!pgduckdb::IsExtensionRegistered()) {
 		pgduckdb::MarkStatementNotTopLevel();
 		prev_executor_start_hook(queryDesc, eflags);
@@ -391,6 +411,34 @@ DuckdbExecutorStartHook(QueryDesc *queryDesc, int eflags) {
 	InvokeCPPFunc(DuckdbExecutorStartHook_Cpp, queryDesc);
 }
 
+/*
+ * Plain SELECTs that are fully executed by DuckDB send their rows to the
+ * DestReceiver in bulk, instead of pulling them through the executor one by
+ * one.
+ */
+#if PG_VERSION_NUM >= 180000
+static void
+DuckdbExecutorRunHook(QueryDesc *queryDesc, ScanDirection direction, uint64 count) {
+	if (CanRunDuckdbQueryInBulk(queryDesc, direction, count)) {
+		DuckdbExecutorRunInBulk(queryDesc);
+		return;
+	}
+
+	prev_executor_run_hook(queryDesc, direction, count);
+}
+#else
+static void
+DuckdbExecutorRunHook(QueryDesc *queryDesc, ScanDirection direction, uint64 count, bool execute_once) {
+	if (execute_once && !queryDesc->already_executed && CanRunDuckdbQueryInBulk(queryDesc, direction, count)) {
+		queryDesc->already_executed = true;
+		DuckdbExecutorRunInBulk(queryDesc);
+		return;
+	}
+
+	prev_executor_run_hook(queryDesc, direction, count, execute_once);
+}
+#endif
+
 /*
  * Claim the current command id for non-obvious DuckDB writes.
  *
@@ -518,6 +566,9 @@ DuckdbInitHooks(void) {
 	prev_executor_start_hook = ExecutorStart_hook ? ExecutorStart_hook : standard_ExecutorStart;
 	ExecutorStart_hook = DuckdbExecutorStartHook;
 
+	prev_executor_run_hook = ExecutorRun_hook ? ExecutorRun_hook : standard_ExecutorRun;
+	ExecutorRun_hook = DuckdbExecutorRunHook;
+
 	prev_executor_finish_hook = ExecutorFinish_hook ? ExecutorFinish_hook : standard_ExecutorFinish;
 	ExecutorFinish_hook = DuckdbExecutorFinishHook;
 
@@ -0,0 +1,250 @@
+#include "pgduckdb/pgduckdb_local_storage.hpp"
+
+#include <atomic>
+#include <filesystem>
+
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/local_file_system.hpp"
+
+#include "pgduckdb/pgduckdb_duckdb.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_metadata_cache.hpp"
+#include "pgduckdb/pgduckdb_table_am.hpp"
+#include "pgduckdb/pgduckdb_utils.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+#include "pgduckdb/vendor/pg_list.hpp"
+
+extern "C" {
+#include "postgres.h"
+
+#include "catalog/pg_am.h"
+#include "catalog/pg_class.h"
+#include "miscadmin.h" // DataDir, MyDatabaseId
+#include "nodes/nodeFuncs.h"
+#include "storage/lmgr.h"
+#include "utils/lsyscache.h"
+}
+
+namespace pgduckdb {
+
+/*
+ * The DuckDB database file is opened through paths with this prefix, which
+ * are handled by LocalStorageFileSystem instead of DuckDB its own
+ * LocalFileSystem. The "://" keeps DuckDB from taking the prefix for the name
+ * of a storage extension.
+ */
+static const char *LOCAL_STORAGE_PREFIX = "pgduckdb-local://";
+
+/* Is the DuckDB database file attached in the current transaction, and can it be written? */
+static bool local_storage_attached = false;
+static bool local_storage_writable = false;
+
+/*
+ * The number of LocalStorageFileAccess scopes that are active. The file
+ * system only opens files while there's at least one, so that the queries of
+ * users can't access the DuckDB database file through the prefix directly.
+ */
+static std::atomic<int> local_storage_access_scopes {0};
+
+LocalStorageFileAccess::LocalStorageFileAccess() {
+	local_storage_access_scopes++;
+}
+
+LocalStorageFileAccess::~LocalStorageFileAccess() {
+	local_storage_access_scopes--;
+}
+
+static std::string
+LocalStorageDirectory() {
+	return std::string(DataDir) + "/pg_duckdb/databases";
+}
+
+static std::string
+LocalStoragePath() {
+	return LocalStorageDirectory() + "/" + std::to_string(MyDatabaseId) + ".duckdb";
+}
+
+/*
+ * A LocalFileSystem that can only access the DuckDB database file of the
+ * current Postgres database, and the WAL and other files that DuckDB creates
+ * next to it. Users without raw file access get LocalFileSystem added to
+ * duckdb.disabled_filesystems, which this file system is not affected by. So
+ * that doesn't keep their queries from using tables in local storage, while
+ * they still can't access any other files.
+ */
+class LocalStorageFileSystem : public duckdb::LocalFileSystem {
+public:
+	explicit LocalStorageFileSystem(std::string database_path_p) : database_path(std::move(database_path_p)) {
+	}
+
+	std::string
+	GetName() const override {
+		return "PgDuckdbLocalStorageFileSystem";
+	}
+
+	bool
+	CanHandleFile(const std::string &path) override {
+		return duckdb::StringUtil::StartsWith(path, LOCAL_STORAGE_PREFIX);
+	}
+
+	duckdb::unique_ptr<duckdb::FileHandle>
+	OpenFile(const std::string &path, duckdb::FileOpenFlags flags,
+	         duckdb::optional_ptr<duckdb::FileOpener> opener = nullptr) override {
+		return LocalFileSystem::OpenFile(LocalPath(path), flags, opener);
+	}
+
+	bool
+	FileExists(const std::string &path, duckdb::optional_ptr<duckdb::FileOpener> opener = nullptr) override {
+		return LocalFileSystem::FileExists(LocalPath(path), opener);
+	}
+
+	void
+	RemoveFile(const std::string &path, duckdb::optional_ptr<duckdb::FileOpener> opener = nullptr) override {
+		LocalFileSystem::RemoveFile(LocalPath(path), opener);
+	}
+
+	bool
+	TryRemoveFile(const std::string &path, duckdb::optional_ptr<duckdb::FileOpener> opener = nullptr) override {
+		return LocalFileSystem::TryRemoveFile(LocalPath(path), opener);
+	}
+
+	void
+	MoveFile(const std::string &source, const std::string &target,
+	         duckdb::optional_ptr<duckdb::FileOpener> opener = nullptr) override {
+		LocalFileSystem::MoveFile(LocalPath(source), LocalPath(target), opener);
+	}
+
+private:
+	std::string
+	LocalPath(const std::string &path) const {
+		if (local_storage_access_scopes == 0) {
+			throw duckdb::PermissionException("\"%s\" can only be accessed by the local storage of pg_duckdb", path);
+		}
+
+		auto local_path = path.substr(strlen(LOCAL_STORAGE_PREFIX));
+		bool next_to_database = duckdb::StringUtil::StartsWith(local_path, database_path) &&
+		                        local_path.find('/', database_path.size()) == std::string::npos;
+		if (!next_to_database) {
+			throw duckdb::PermissionException("Cannot access \"%s\" through the local storage of pg_duckdb", path);
+		}
+		return local_path;
+	}
+
+	std::string database_path;
+};
+
+void
+RegisterLocalStorageFileSystem(duckdb::DatabaseInstance &instance) {
+	instance.GetFileSystem().RegisterSubSystem(duckdb::make_uniq<LocalStorageFileSystem>(LocalStoragePath()));
+}
+
+bool
+IsLocalStorageTable(Oid relid) {
+	if (!duckdb_local_storage) {
+		return false;
+	}
+
+	const char *am_name = DuckdbTableAmGetName(relid);
+	return am_name != nullptr && strcmp(am_name, "duckdb") == 0 &&
+	       get_rel_persistence(relid) == RELPERSISTENCE_PERMANENT;
+}
+
+bool
+ReadsLocalStorageTable(Node *node, void *context) {
+	if (node == NULL || !duckdb_local_storage)
+		return false;
+
+	if (IsA(node, Query)) {
+		Query *query = (Query *)node;
+		foreach_node(RangeTblEntry, rte, query->rtable) {
+			if (rte->rtekind == RTE_RELATION && rte->relkind == RELKIND_RELATION && IsLocalStorageTable(rte->relid)) {
+				return true;
+			}
+		}
+
+#if PG_VERSION_NUM >= 160000
+		return query_tree_walker(query, ReadsLocalStorageTable, context, 0);
+#else
+		return query_tree_walker(query, (bool (*)())((void *)ReadsLocalStorageTable), context, 0);
+#endif
+	}
+
+#if PG_VERSION_NUM >= 160000
+	return expression_tree_walker(node, ReadsLocalStorageTable, context);
+#else
+	return expression_tree_walker(node, (bool (*)())((void *)ReadsLocalStorageTable), context);
+#endif
+}
+
+void
+AttachLocalStorage(bool for_write) {
+	if (local_storage_attached && (local_storage_writable || !for_write)) {
+		return;
+	}
+
+	if (!duckdb_enable_external_access) {
+		throw duckdb::PermissionException("duckdb.local_storage cannot be used when duckdb.enable_external_access "
+		                                  "is disabled");
+	}
+
+	auto connection = DuckDBManager::GetConnection();
+	LocalStorageFileAccess file_access;
+	if (local_storage_attached) {
+		/* Attached for reading earlier in the transaction, which other processes might do too */
+		local_storage_attached = false;
+		DuckDBQueryOrThrow(*connection, std::string("DETACH DATABASE IF EXISTS ") + LOCAL_STORAGE_DATABASE);
+	}
+
+	/*
+	 * DuckDB locks the file while it's attached, and fails instead of waiting
+	 * when another process has it open for writing. So the backends of the
+	 * database take turns through a Postgres lock instead, which is only
+	 * released at the end of the transaction after DetachLocalStorage closed
+	 * the file again. Any number of them can open the file for reading at the
+	 * same time though.
+	 */
+	PostgresFunctionGuard(LockDatabaseObject, AccessMethodRelationId, DuckdbTableAmOid(), 0,
+	                      for_write ? ExclusiveLock : ShareLock);
+
+	std::string path = LOCAL_STORAGE_PREFIX + LocalStoragePath();
+	if (!for_write && !std::filesystem::exists(LocalStoragePath())) {
+		/* No table was ever created in local storage, and DuckDB can't create the file read-only */
+		for_write = true;
+		PostgresFunctionGuard(LockDatabaseObject, AccessMethodRelationId, DuckdbTableAmOid(), 0, ExclusiveLock);
+	}
+
+	std::filesystem::create_directories(LocalStorageDirectory());
+	std::string attach_options = for_write ? " (TYPE duckdb)" : " (TYPE duckdb, READ_ONLY)";
+	DuckDBQueryOrThrow(*connection, "ATTACH IF NOT EXISTS " + duckdb::KeywordHelper::WriteQuoted(path) + " AS " +
+	                                    LOCAL_STORAGE_DATABASE + attach_options);
+	local_storage_attached = true;
+	local_storage_writable = for_write;
+}
+
+void
+AttachLocalStorageForQuery(const Query *query) {
+	if (!ReadsLocalStorageTable((Node *)query, NULL)) {
+		return;
+	}
+	AttachLocalStorage(query->commandType != CMD_SELECT || query->hasModifyingCTE);
+}
+
+void
+DetachLocalStorage(duckdb::ClientContext &context) {
+	if (!local_storage_attached) {
+		return;
+	}
+
+	/* Don't try again during the abort of the transaction, if this fails at commit */
+	local_storage_attached = false;
+	LocalStorageFileAccess file_access;
+	DuckDBQueryOrThrow(context, std::string("DETACH DATABASE IF EXISTS ") + LOCAL_STORAGE_DATABASE);
+}
+
+bool
+IsLocalStorageAttached() {
+	return local_storage_attached;
+}
+
+} // namespace pgduckdb
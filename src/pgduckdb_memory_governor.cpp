@@ -0,0 +1,386 @@
+#include "duckdb.hpp"
+#include "duckdb/storage/buffer/buffer_pool.hpp"
+
+#include "pgduckdb/pg/error_data.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_memory_governor.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+
+#include <algorithm>
+
+extern "C" {
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "postmaster/autovacuum.h"
+#include "replication/walsender.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+}
+
+namespace pgduckdb {
+
+/*
+ * Without any queries running, a backend keeps a reservation of up to this
+ * much memory, so that its DuckDB instance can hold on to a few cached
+ * buffers and start its next query right away. It's only kept if the backend
+ * could reserve that much in the first place, so it's part of the global
+ * budget like any other reservation.
+ */
+static const int64 IDLE_DUCKDB_MEMORY_RESERVATION = 64 * 1024 * 1024;
+
+typedef struct DuckdbMemoryReservation {
+	pid_t pid;            /* 0 if the slot is not used by any backend */
+	int64 reserved_bytes; /* the memory limit of the DuckDB instance of the backend */
+	int64 used_bytes;     /* the memory the DuckDB instance used when it last reserved or released memory */
+} DuckdbMemoryReservation;
+
+/*
+ * Every backend that uses DuckDB reserves part of duckdb.max_memory_global
+ * for its DuckDB instance, and uses that as its memory limit. While running
+ * queries a backend reserves as much as duckdb.max_memory allows, but never
+ * more than what the other backends left over. At the end of the transaction
+ * it gives back everything it's not using anymore. That way one busy backend
+ * can use the memory that idle backends don't need.
+ *
+ * The reservations are indexed by the number of the PGPROC of the backend.
+ */
+typedef struct MemoryGovernorShmemStruct {
+	slock_t lock; /* protects all the fields below */
+
+	int64 total_reserved_bytes;
+	int num_reservations;
+	DuckdbMemoryReservation reservations[1]; /* actually num_reservations long */
+} MemoryGovernorShmemStruct;
+
+static MemoryGovernorShmemStruct *MemoryGovernor;
+
+/* Did this backend reserve memory for the queries of the current transaction? */
+static bool reserved_for_transaction = false;
+static bool set_up_release_reservation_hook = false;
+
+static int
+NumReservations() {
+#if PG_VERSION_NUM >= 150000
+	return MaxBackends;
+#else
+	/*
+	 * Like InitializeMaxBackends, which did not run yet when the shared memory
+	 * is requested.
+	 */
+	return MaxConnections + autovacuum_max_workers + 1 + max_worker_processes + max_wal_senders;
+#endif
+}
+
+static int
+MyReservationIndex() {
+#if PG_VERSION_NUM >= 170000
+	return MyProcNumber;
+#else
+	return MyProc->pgprocno;
+#endif
+}
+
+static Size
+MemoryGovernorShmemSize() {
+	return add_size(offsetof(MemoryGovernorShmemStruct, reservations),
+	                mul_size(NumReservations(), sizeof(DuckdbMemoryReservation)));
+}
+
+static void
+InitMemoryGovernorStruct() {
+	MemSet(MemoryGovernor, 0, MemoryGovernorShmemSize());
+	SpinLockInit(&MemoryGovernor->lock);
+	MemoryGovernor->num_reservations = NumReservations();
+}
+
+#if PG_VERSION_NUM >= 190000
+
+static void
+MemoryGovernorShmemRequest(void * /*opaque_arg*/) {
+	ShmemStructOpts struct_opts = {
+	    .name = "DuckdbMemoryGovernor Data",
+	    .size = MemoryGovernorShmemSize(),
+	    .ptr = (void **)&MemoryGovernor,
+	};
+	ShmemRequestStructWithOpts(&struct_opts);
+}
+
+static void
+MemoryGovernorShmemInit(void * /*opaque_arg*/) {
+	InitMemoryGovernorStruct();
+}
+
+#else
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void
+MemoryGovernorShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+#endif
+
+	RequestAddinShmemSpace(MemoryGovernorShmemSize());
+}
+
+static void
+MemoryGovernorShmemStartup(void) {
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	bool found;
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	MemoryGovernor =
+	    (MemoryGovernorShmemStruct *)ShmemInitStruct("DuckdbMemoryGovernor Data", MemoryGovernorShmemSize(), &found);
+	if (!found) {
+		InitMemoryGovernorStruct();
+	}
+	LWLockRelease(AddinShmemInitLock);
+}
+
+#endif
+
+void
+InitMemoryGovernorShmem(void) {
+#if PG_VERSION_NUM >= 190000
+	/* See InitBackgroundWorkersShmem on why this is static */
+	static const ShmemCallbacks callbacks = {
+	    .request_fn = MemoryGovernorShmemRequest,
+	    .init_fn = MemoryGovernorShmemInit,
+	};
+	RegisterShmemCallbacks(&callbacks);
+#else
+#if PG_VERSION_NUM >= 150000
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = MemoryGovernorShmemRequest;
+#else
+	MemoryGovernorShmemRequest();
+#endif
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = MemoryGovernorShmemStartup;
+#endif
+}
+
+static bool
+IsMemoryGovernorEnabled() {
+	return duckdb_max_memory_global > 0 && MemoryGovernor != NULL;
+}
+
+static void
+ReleaseReservation(int /*code*/, Datum /*arg*/) {
+	int index = MyReservationIndex();
+	SpinLockAcquire(&MemoryGovernor->lock);
+	auto &reservation = MemoryGovernor->reservations[index];
+	MemoryGovernor->total_reserved_bytes -= reservation.reserved_bytes;
+	reservation.pid = 0;
+	reservation.reserved_bytes = 0;
+	reservation.used_bytes = 0;
+	SpinLockRelease(&MemoryGovernor->lock);
+}
+
+/* Returns the reservation of this backend, or NULL if its memory is not governed */
+static DuckdbMemoryReservation *
+MyReservation() {
+	if (!IsMemoryGovernorEnabled() || MyProc == NULL) {
+		return NULL;
+	}
+
+	int index = MyReservationIndex();
+	if (index < 0 || index >= MemoryGovernor->num_reservations) {
+		return NULL;
+	}
+
+	if (!set_up_release_reservation_hook) {
+		before_shmem_exit(ReleaseReservation, 0);
+		set_up_release_reservation_hook = true;
+	}
+	return &MemoryGovernor->reservations[index];
+}
+
+static int64
+MaxBackendMemory() {
+	int64 global_limit = (int64)duckdb_max_memory_global * 1024 * 1024;
+	if (duckdb_maximum_memory <= 0) {
+		return global_limit;
+	}
+	return std::min((int64)duckdb_maximum_memory * 1024 * 1024, global_limit);
+}
+
+/* The part of its current reservation that a backend keeps at the end of a transaction */
+static int64
+IdleReservation(int64 used_bytes, int64 reserved_bytes) {
+	return std::max(used_bytes, std::min({IDLE_DUCKDB_MEMORY_RESERVATION, MaxBackendMemory(), reserved_bytes}));
+}
+
+/*
+ * The least memory a backend needs to run its queries. With less than that
+ * DuckDB would only fail halfway through a query, so the backend gets a clear
+ * error up front instead.
+ */
+static int64
+MinimumReservation() {
+	return std::min(IDLE_DUCKDB_MEMORY_RESERVATION, MaxBackendMemory());
+}
+
+/*
+ * Reserves as much memory as this backend is allowed to use, but no more than
+ * the other backends have left over. The reservation never gets smaller than
+ * what the DuckDB instance is already using, though, because DuckDB can't
+ * give that back in the middle of a transaction. Throws if the other backends
+ * left over less than MinimumReservation, in which case the reservation stays
+ * as it was. Returns the new reservation.
+ */
+static int64
+Reserve(DuckdbMemoryReservation *reservation, int64 used_bytes) {
+	int64 global_limit = (int64)duckdb_max_memory_global * 1024 * 1024;
+	SpinLockAcquire(&MemoryGovernor->lock);
+	int64 reserved_by_others = MemoryGovernor->total_reserved_bytes - reservation->reserved_bytes;
+	int64 available = std::max(global_limit - reserved_by_others, used_bytes);
+	int64 reserved_bytes = std::min(MaxBackendMemory(), available);
+	if (reserved_bytes < MinimumReservation()) {
+		SpinLockRelease(&MemoryGovernor->lock);
+		throw duckdb::Exception(
+		    duckdb::ExceptionType::OUT_OF_MEMORY,
+		    "Could not reserve DuckDB memory for this connection, because other connections reserved " +
+		        std::to_string(reserved_by_others / (1024 * 1024)) +
+		        "MB of duckdb.max_memory_global. Try again once their queries finished, or increase "
+		        "duckdb.max_memory_global.",
+		    {{pg::SQLERRCODE_EXTRA_INFO, std::to_string(ERRCODE_INSUFFICIENT_RESOURCES)}});
+	}
+	MemoryGovernor->total_reserved_bytes = reserved_by_others + reserved_bytes;
+	reservation->pid = MyProcPid;
+	reservation->reserved_bytes = reserved_bytes;
+	reservation->used_bytes = used_bytes;
+	SpinLockRelease(&MemoryGovernor->lock);
+	return reserved_bytes;
+}
+
+duckdb::optional_idx
+ReserveInitialDuckdbMemory(void) {
+	auto reservation = MyReservation();
+	if (!reservation) {
+		return duckdb::optional_idx();
+	}
+
+	int64 reserved_bytes = Reserve(reservation, 0);
+	reserved_for_transaction = true;
+	return reserved_bytes;
+}
+
+void
+ReserveDuckdbMemory(duckdb::DatabaseInstance &instance) {
+	if (reserved_for_transaction) {
+		return;
+	}
+
+	auto reservation = MyReservation();
+	if (!reservation) {
+		return;
+	}
+
+	auto &buffer_pool = instance.GetBufferPool();
+	int64 reserved_bytes = Reserve(reservation, buffer_pool.GetUsedMemory());
+	reserved_for_transaction = true;
+	buffer_pool.SetLimit(reserved_bytes, "Failed to apply the DuckDB memory reservation of this connection");
+}
+
+void
+ReleaseDuckdbMemory(duckdb::DatabaseInstance &instance) {
+	if (!reserved_for_transaction) {
+		return;
+	}
+	reserved_for_transaction = false;
+
+	auto reservation = MyReservation();
+	if (!reservation) {
+		return;
+	}
+
+	/*
+	 * This runs while the transaction is already committed or aborted, so
+	 * this must not fail. If DuckDB can't shrink to the smaller limit for
+	 * some reason, we keep the current reservation until the next one.
+	 */
+	try {
+		auto &buffer_pool = instance.GetBufferPool();
+		int64 used_bytes = buffer_pool.GetUsedMemory();
+		int64 reserved_bytes = IdleReservation(used_bytes, reservation->reserved_bytes);
+		buffer_pool.SetLimit(reserved_bytes, "Failed to release the DuckDB memory reservation of this connection");
+
+		SpinLockAcquire(&MemoryGovernor->lock);
+		MemoryGovernor->total_reserved_bytes += reserved_bytes - reservation->reserved_bytes;
+		reservation->reserved_bytes = reserved_bytes;
+		reservation->used_bytes = used_bytes;
+		SpinLockRelease(&MemoryGovernor->lock);
+	} catch (std::exception &ex) {
+		elog(DEBUG1, "[PGDuckDB] Could not release the DuckDB memory reservation: %s", ex.what());
+	}
+}
+
+} // namespace pgduckdb
+
+extern "C" {
+
+DECLARE_PG_FUNCTION(duckdb_memory_usage) {
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL()) {
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext old_context = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		TupleDesc tupdesc;
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+			elog(ERROR, "return type must be a row type");
+		}
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* Copy all reservations at once, so that they add up to the total */
+		auto governor = pgduckdb::MemoryGovernor;
+		int num_reservations = governor ? governor->num_reservations : 0;
+		auto reservations = (pgduckdb::DuckdbMemoryReservation *)palloc(
+		    Max(num_reservations, 1) * sizeof(pgduckdb::DuckdbMemoryReservation));
+		int num_used = 0;
+		if (governor) {
+			SpinLockAcquire(&governor->lock);
+			for (int i = 0; i < num_reservations; i++) {
+				if (governor->reservations[i].pid != 0) {
+					reservations[num_used++] = governor->reservations[i];
+				}
+			}
+			SpinLockRelease(&governor->lock);
+		}
+
+		funcctx->user_fctx = reservations;
+		funcctx->max_calls = num_used;
+		MemoryContextSwitchTo(old_context);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	if (funcctx->call_cntr < funcctx->max_calls) {
+		auto reservations = (pgduckdb::DuckdbMemoryReservation *)funcctx->user_fctx;
+		auto &reservation = reservations[funcctx->call_cntr];
+
+		Datum values[3];
+		bool nulls[3] = {false, false, false};
+		values[0] = Int32GetDatum(reservation.pid);
+		values[1] = Int64GetDatum(reservation.reserved_bytes);
+		values[2] = Int64GetDatum(reservation.used_bytes);
+		HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+} // extern "C"
@@ -433,6 +433,10 @@ IsDuckdbTable(Relation relation) {
 bool
 IsMotherDuckTable(Form_pg_class relation) {
 	Assert(cache.valid);
+	if (duckdb_local_storage) {
+		/* These tables are stored locally instead, see IsLocalStorageTable */
+		return false;
+	}
 	return IsDuckdbTable(relation) && relation->relpersistence == RELPERSISTENCE_PERMANENT;
 }
 
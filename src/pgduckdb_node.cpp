@@ -2,25 +2,44 @@
 #include "duckdb.hpp"
 #include "duckdb/common/exception/conversion_exception.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 
+#include "pgduckdb/pgduckdb_admission.hpp"
 #include "pgduckdb/pgduckdb_hooks.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
 #include "pgduckdb/pgduckdb_planner.hpp"
+#include "pgduckdb/pgduckdb_process_lock.hpp"
+#include "pgduckdb/pgduckdb_shared_engine.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
 #include "pgduckdb/pgduckdb_types.hpp"
+#include "pgduckdb/pgduckdb_utils.hpp"
 #include "pgduckdb/vendor/pg_explain.hpp"
 #include "pgduckdb/pg/explain.hpp"
+#include "pgduckdb/pg/relations.hpp"
 
 extern "C" {
 #include "postgres.h"
 #include "miscadmin.h"
+#include "access/xact.h"
+#include "executor/executor.h"
+#include "executor/instrument.h"
 #include "tcop/pquery.h"
 #include "nodes/params.h"
+#include "utils/memutils.h"
 #include "utils/ruleutils.h"
 }
 
 #include "pgduckdb/pgduckdb_node.hpp"
 #include "pgduckdb/pgduckdb_duckdb.hpp"
+#include "pgduckdb/scan/postgres_table_reader.hpp"
+#include "pgduckdb/utility/copy.hpp"
 #include "pgduckdb/utility/cpp_wrapper.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 bool duckdb_explain_analyze = false;
 bool duckdb_explain_ctas = false;
 duckdb::ExplainFormat duckdb_explain_format = duckdb::ExplainFormat::DEFAULT;
@@ -39,26 +58,176 @@ typedef struct DuckdbScanState {
 	const Query *query;
 	ParamListInfo params;
 	duckdb::Connection *duckdb_connection;
-	duckdb::PreparedStatement *prepared_statement;
+	std::shared_ptr<duckdb::PreparedStatement> prepared_statement;
+	/* The relations that prepared_statement reads, if it was prepared while planning */
+	List *planned_relations;
 	bool is_executed;
 	bool fetch_next;
 	duckdb::unique_ptr<duckdb::QueryResult> query_results;
 	duckdb::idx_t column_count;
 	duckdb::unique_ptr<duckdb::DataChunk> current_data_chunk;
 	duckdb::idx_t current_row;
+	duckdb::idx_t current_chunk_size;
+	/*
+	 * The values of current_data_chunk, converted to Postgres Datums column by
+	 * column. The converted values are allocated in chunk_context, which is
+	 * reset whenever a new chunk is fetched.
+	 */
+	Datum **column_values;
+	bool **column_nulls;
+	MemoryContext chunk_context;
+	/* Is query_results a streaming result that still reads from Postgres tables? */
+	bool streams_postgres_scans;
+	bool blocks_duckdb_threads;
+	/* Has query_results returned its last chunk? */
+	bool result_complete;
+	/* Was the query admitted, and does it count towards the DuckDB threads that this backend uses? */
+	bool admitted;
+	bool holds_threads;
+	/* The parameters that the DuckDB query was executed with */
+	duckdb::unique_ptr<duckdb::case_insensitive_map_t<duckdb::BoundParameterData>> bound_parameters;
+	/*
+	 * If the scan is going to be rescanned, see WillRewindScan, the chunks of
+	 * the DuckDB result are kept in result_buffer. A rescan with unchanged
+	 * parameters then replays those, starting at next_buffered_chunk, before
+	 * fetching any remaining chunks from query_results.
+	 */
+	bool buffer_result;
+	duckdb::unique_ptr<duckdb::ColumnDataCollection> result_buffer;
+	duckdb::idx_t next_buffered_chunk;
 } DuckdbScanState;
 
+/*
+ * The scans whose streaming DuckDB result still reads from Postgres tables.
+ * DuckDB keeps producing the next rows of such a result in its own threads,
+ * also while Postgres handles the rows that were already returned. So in
+ * between fetches, including while a cursor is idle, the main thread keeps
+ * the other threads from taking the GlobalProcessLock, which makes sure the
+ * DuckDB threads don't run Postgres code at the same time. The main thread
+ * doesn't hold the lock itself during that time. So the DuckDB threads must
+ * not touch any process state without the lock either, not even the process
+ * latch, which the main thread waits on while it returns rows to the client.
+ * That's why they don't wait on it for worker tuples, see
+ * WaitForWorkerTuples.
+ */
+static std::vector<DuckdbScanState *> streaming_postgres_scans;
+
+static void
+BlockDuckdbThreads(DuckdbScanState *state) {
+	if (!state->blocks_duckdb_threads) {
+		pgduckdb::GlobalProcessLock::GetLock().BlockOtherThreads();
+		state->blocks_duckdb_threads = true;
+	}
+}
+
+static void
+UnblockDuckdbThreads(DuckdbScanState *state) {
+	if (state->blocks_duckdb_threads) {
+		pgduckdb::GlobalProcessLock::GetLock().UnblockOtherThreads();
+		state->blocks_duckdb_threads = false;
+	}
+}
+
+/*
+ * Resizes the DuckDB thread pool to the current share of this backend of
+ * duckdb.max_threads_global. Stopping threads waits for their current task,
+ * which might be waiting for the GlobalProcessLock, so this is skipped while
+ * any of the streaming scans blocks them from taking it.
+ */
+static void
+RebalanceThreads(DuckdbScanState *state) {
+	for (auto streaming_state : streaming_postgres_scans) {
+		if (streaming_state->blocks_duckdb_threads) {
+			return;
+		}
+	}
+	pgduckdb::RebalanceDuckdbThreads(*state->duckdb_connection->context);
+}
+
+/* Called once DuckDB doesn't execute the query anymore */
+static void
+ReleaseQueryResources(DuckdbScanState *state) {
+	if (state->holds_threads) {
+		state->holds_threads = false;
+		pgduckdb::ReleaseDuckdbThreads();
+	}
+	if (state->admitted) {
+		state->admitted = false;
+		pgduckdb::ReleaseDuckdbQueryAdmission();
+	}
+}
+
+/*
+ * Interrupts the streaming result and consumes what's left of it. That way
+ * DuckDB cleans up the Postgres scans of the query right away, instead of
+ * whenever the next query happens to run on the connection.
+ *
+ * This runs while the query is being cleaned up, possibly during an abort, so
+ * errors are only reported as a warning. The error that the interrupt itself
+ * causes is expected.
+ */
+static void
+InterruptStreamingResult(DuckdbScanState *state) {
+	UnblockDuckdbThreads(state);
+	state->duckdb_connection->Interrupt();
+	try {
+		duckdb::unique_ptr<duckdb::DataChunk> chunk;
+		do {
+			chunk = state->query_results->Fetch();
+		} while (chunk && chunk->size() > 0);
+	} catch (std::exception &ex) {
+		duckdb::ErrorData error(ex);
+		if (error.Type() != duckdb::ExceptionType::INTERRUPT) {
+			elog(WARNING, "(PGDuckDB/InterruptStreamingResult) Could not stop the DuckDB query: %s",
+			     error.Message().c_str());
+		}
+	}
+}
+
+static void
+UnregisterStreamingPostgresScans(DuckdbScanState *state) {
+	UnblockDuckdbThreads(state);
+	state->streams_postgres_scans = false;
+	streaming_postgres_scans.erase(std::remove(streaming_postgres_scans.begin(), streaming_postgres_scans.end(), state),
+	                               streaming_postgres_scans.end());
+}
+
+/* Drops the result of the DuckDB query, so that the next fetch executes it again */
+static void
+ResetQueryResult(DuckdbScanState *state) {
+	if (state->streams_postgres_scans) {
+		InterruptStreamingResult(state);
+		UnregisterStreamingPostgresScans(state);
+	}
+
+	state->query_results.reset();
+	state->current_data_chunk.reset();
+	state->result_buffer.reset();
+	state->is_executed = false;
+	state->result_complete = false;
+	ReleaseQueryResources(state);
+}
+
 static void
 CleanupDuckdbScanState(DuckdbScanState *state) {
+	ResetQueryResult(state);
+
 	MemoryContextReset(state->css.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
 	ExecClearTuple(state->css.ss.ss_ScanTupleSlot);
 
-	state->query_results.reset();
-	state->current_data_chunk.reset();
+	if (state->chunk_context) {
+		MemoryContextReset(state->chunk_context);
+	}
+
+	state->bound_parameters.reset();
+	state->prepared_statement.reset();
 
-	if (state->prepared_statement) {
-		delete state->prepared_statement;
-		state->prepared_statement = nullptr;
+	if (state->planned_relations) {
+		std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
+		foreach_ptr(RelationData, rel, state->planned_relations) {
+			pgduckdb::CloseRelation(rel);
+		}
+		state->planned_relations = NIL;
 	}
 }
 
@@ -82,8 +251,21 @@ Duckdb_CreateCustomScanState(CustomScan *cscan) {
 	return (Node *)custom_scan_state;
 }
 
+/*
+ * Is the scan that starts now going to be rewound? Postgres does so for a
+ * cursor WITH HOLD when its transaction commits, to store all of its rows,
+ * see PersistHoldablePortal. It doesn't pass EXEC_FLAG_REWIND for that,
+ * only for scrollable cursors, and those have a Material node on top of the
+ * scan that buffers the rows itself.
+ */
+static bool
+WillRewindScan() {
+	return ActivePortal && pgduckdb::executor_nest_level <= 1 && (ActivePortal->cursorOptions & CURSOR_OPT_HOLD) &&
+	       !(ActivePortal->cursorOptions & CURSOR_OPT_SCROLL);
+}
+
 static void
-Duckdb_BeginCustomScan_Cpp(CustomScanState *cscanstate, EState *estate, int /*eflags*/) {
+Duckdb_BeginCustomScan_Cpp(CustomScanState *cscanstate, EState *estate, int eflags) {
 	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)cscanstate;
 
 	StringInfo explain_prefix = makeStringInfo();
@@ -112,8 +294,14 @@ Duckdb_BeginCustomScan_Cpp(CustomScanState *cscanstate, EState *estate, int /*ef
 		}
 	}
 
-	duckdb::unique_ptr<duckdb::PreparedStatement> prepared_query =
-	    DuckdbPrepare(duckdb_scan_state->query, explain_prefix->data);
+	/* Unless this is an EXPLAIN, the statement that was prepared while planning can be used */
+	std::shared_ptr<duckdb::PreparedStatement> prepared_query =
+	    GetPlannedDuckdbStatement(duckdb_scan_state->custom_scan, &duckdb_scan_state->planned_relations);
+
+	if (!prepared_query || is_explain_query) {
+		prepared_query = std::shared_ptr<duckdb::PreparedStatement>(
+		    DuckdbPrepare(duckdb_scan_state->query, explain_prefix->data).release());
+	}
 
 	if (prepared_query->HasError()) {
 		throw duckdb::Exception(duckdb::ExceptionType::EXECUTOR,
@@ -145,11 +333,30 @@ Duckdb_BeginCustomScan_Cpp(CustomScanState *cscanstate, EState *estate, int /*ef
 		}
 	}
 
-	duckdb_scan_state->duckdb_connection = pgduckdb::DuckDBManager::GetConnection();
-	duckdb_scan_state->prepared_statement = prepared_query.release();
+	/*
+	 * A statement that was prepared while planning doesn't attach the DuckDB
+	 * database file of duckdb.local_storage again, which the transaction that
+	 * planned it detached when it finished.
+	 */
+	pgduckdb::AttachLocalStorageForQuery(duckdb_scan_state->query);
+
+	duckdb_scan_state->duckdb_connection =
+	    pgduckdb::DuckDBManager::GetConnection(false, pgduckdb::NeedsDuckdbExtensions(duckdb_scan_state->query));
+	duckdb_scan_state->prepared_statement = std::move(prepared_query);
 	duckdb_scan_state->params = estate->es_param_list_info;
 	duckdb_scan_state->is_executed = false;
 	duckdb_scan_state->fetch_next = true;
+	duckdb_scan_state->column_values = nullptr;
+	duckdb_scan_state->column_nulls = nullptr;
+	duckdb_scan_state->streams_postgres_scans = false;
+	duckdb_scan_state->blocks_duckdb_threads = false;
+	duckdb_scan_state->result_complete = false;
+	duckdb_scan_state->admitted = false;
+	duckdb_scan_state->holds_threads = false;
+	duckdb_scan_state->buffer_result = WillRewindScan();
+	duckdb_scan_state->next_buffered_chunk = 0;
+	duckdb_scan_state->chunk_context =
+	    AllocSetContextCreate(estate->es_query_cxt, "DuckDB result chunk", ALLOCSET_DEFAULT_SIZES);
 	duckdb_scan_state->css.ss.ps.ps_ResultTupleDesc = duckdb_scan_state->css.ss.ss_ScanTupleSlot->tts_tupleDescriptor;
 	HOLD_CANCEL_INTERRUPTS();
 }
@@ -159,12 +366,27 @@ Duckdb_BeginCustomScan(CustomScanState *cscanstate, EState *estate, int eflags)
 	InvokeCPPFunc(Duckdb_BeginCustomScan_Cpp, cscanstate, estate, eflags);
 }
 
-static void
-ExecuteQuery(DuckdbScanState *state) {
+/*
+ * Can a query that reads from Postgres tables stream its result? Only plain
+ * SELECTs and cursors do. Other statements, like CTAS, run their own Postgres
+ * code with the rows of the result, and queries inside functions run while
+ * their caller does the same. Subtransactions are not allowed by DuckDB
+ * anyway, once the query has started.
+ */
+static bool
+CanStreamPostgresScans() {
+	return ActivePortal && ActivePortal->commandTag == CMDTAG_SELECT && pgduckdb::executor_nest_level <= 1 &&
+	       !IsSubTransaction();
+}
+
+/* Converts the current values of the Postgres parameters that the DuckDB query uses */
+static duckdb::unique_ptr<duckdb::case_insensitive_map_t<duckdb::BoundParameterData>>
+BindQueryParameters(DuckdbScanState *state) {
 	auto &prepared = *state->prepared_statement;
 	auto pg_params = state->params;
 	const auto num_params = pg_params ? pg_params->numParams : 0;
-	duckdb::case_insensitive_map_t<duckdb::BoundParameterData> named_values;
+	auto bound_parameters = duckdb::make_uniq<duckdb::case_insensitive_map_t<duckdb::BoundParameterData>>();
+	auto &named_values = *bound_parameters;
 
 	for (int i = 0; i < num_params; i++) {
 		ParamExternData *pg_param;
@@ -194,14 +416,43 @@ ExecuteQuery(DuckdbScanState *state) {
 		named_values[duckdb::to_string(i + 1)] = duckdb::BoundParameterData(duckdb_param);
 	}
 
-	// Set `allow_stream_result` to false if the query contains a Postgres table to force a fully materialized DuckDB
-	// result. This is required for cases like CTAS from a Postgres table, where allowing streaming results could lead
-	// to race conditions on Postgres resources.
-	// Checkout discussion: https://github.com/duckdb/pg_duckdb/discussions/866
-	bool allow_stream_result = !pgduckdb::ContainsPostgresTable((Node *)state->query, NULL);
-	auto pending = prepared.PendingQuery(named_values, allow_stream_result);
+	return bound_parameters;
+}
+
+static bool
+SameQueryParameters(const duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &a,
+                    const duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+
+	for (auto &[name, parameter] : a) {
+		auto it = b.find(name);
+		if (it == b.end()) {
+			return false;
+		}
+
+		auto &value = parameter.GetValue();
+		auto &other_value = it->second.GetValue();
+		if (value.type() != other_value.type() || !duckdb::Value::NotDistinctFrom(value, other_value)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Executes the query in the DuckDB instance of this backend */
+static duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteLocally(DuckdbScanState *state, bool allow_stream_result) {
+	auto &prepared = *state->prepared_statement;
+	if (!state->holds_threads) {
+		state->holds_threads = true;
+		pgduckdb::AcquireDuckdbThreads();
+		RebalanceThreads(state);
+	}
+	auto pending = prepared.PendingQuery(*state->bound_parameters, allow_stream_result);
 	if (pending->HasError()) {
-		return pending->ThrowError();
+		pending->ThrowError();
 	}
 
 	duckdb::PendingExecutionResult execution_result = duckdb::PendingExecutionResult::RESULT_NOT_READY;
@@ -211,6 +462,8 @@ ExecuteQuery(DuckdbScanState *state) {
 			break;
 		}
 
+		RebalanceThreads(state);
+
 		if (QueryCancelPending) {
 			auto &connection = state->duckdb_connection;
 			// Send an interrupt
@@ -243,12 +496,181 @@ ExecuteQuery(DuckdbScanState *state) {
 	}
 
 	if (execution_result == duckdb::PendingExecutionResult::EXECUTION_ERROR) {
-		return pending->ThrowError();
+		pending->ThrowError();
 	}
 
-	state->query_results = pending->Execute();
+	return pending->Execute();
+}
+
+static void
+ExecuteQuery(DuckdbScanState *state) {
+	state->bound_parameters = BindQueryParameters(state);
+
+	// Set `allow_stream_result` to false if the query contains a Postgres table and isn't a plain SELECT, to force a
+	// fully materialized DuckDB result. This is required for cases like CTAS from a Postgres table, where allowing
+	// streaming results could lead to race conditions on Postgres resources.
+	// Checkout discussion: https://github.com/duckdb/pg_duckdb/discussions/866
+	bool reads_postgres_tables = pgduckdb::ContainsPostgresTable((Node *)state->query, NULL);
+	bool allow_stream_result = !reads_postgres_tables || CanStreamPostgresScans();
+	if (!state->admitted) {
+		PostgresFunctionGuard(pgduckdb::AdmitDuckdbQuery);
+		state->admitted = true;
+	}
+
+	state->query_results.reset();
+	if (!reads_postgres_tables && pgduckdb::CanUseSharedEngine(state->query)) {
+		state->query_results = pgduckdb::ExecuteInSharedEngine(state->query, *state->bound_parameters,
+		                                                        *state->prepared_statement,
+		                                                        *state->duckdb_connection->context);
+	}
+	if (!state->query_results) {
+		state->query_results = ExecuteLocally(state, allow_stream_result);
+	}
 	state->column_count = state->query_results->ColumnCount();
 	state->is_executed = true;
+	state->result_complete = false;
+	if (state->query_results->type != duckdb::QueryResultType::STREAM_RESULT) {
+		/* The result is fully materialized, so DuckDB is done with the query */
+		ReleaseQueryResources(state);
+	}
+
+	if (state->buffer_result) {
+		auto &buffer_manager = duckdb::BufferManager::GetBufferManager(*state->duckdb_connection->context);
+		state->result_buffer =
+		    duckdb::make_uniq<duckdb::ColumnDataCollection>(buffer_manager, state->query_results->types);
+		state->next_buffered_chunk = 0;
+	}
+
+	if (reads_postgres_tables && state->query_results->type == duckdb::QueryResultType::STREAM_RESULT) {
+		state->streams_postgres_scans = true;
+		streaming_postgres_scans.push_back(state);
+		BlockDuckdbThreads(state);
+	}
+}
+
+/*
+ * Converts all the values of the current chunk to Postgres at once, so the
+ * rows of the chunk can be returned without any further conversion. Columns
+ * with a vectorized conversion are converted in one go, the others value by
+ * value.
+ */
+static void
+ConvertCurrentDataChunk(DuckdbScanState *state) {
+	auto &chunk = *state->current_data_chunk;
+	TupleTableSlot *slot = state->css.ss.ss_ScanTupleSlot;
+	TupleDesc tupdesc = slot->tts_tupleDescriptor;
+
+	if (!state->column_values) {
+		MemoryContext query_context = state->css.ss.ps.state->es_query_cxt;
+		state->column_values = (Datum **)MemoryContextAlloc(query_context, sizeof(Datum *) * state->column_count);
+		state->column_nulls = (bool **)MemoryContextAlloc(query_context, sizeof(bool *) * state->column_count);
+		for (idx_t col = 0; col < state->column_count; col++) {
+			state->column_values[col] =
+			    (Datum *)MemoryContextAlloc(query_context, sizeof(Datum) * STANDARD_VECTOR_SIZE);
+			state->column_nulls[col] = (bool *)MemoryContextAlloc(query_context, sizeof(bool) * STANDARD_VECTOR_SIZE);
+		}
+	}
+
+	MemoryContextReset(state->chunk_context);
+	MemoryContext old_context = MemoryContextSwitchTo(state->chunk_context);
+
+	for (idx_t col = 0; col < state->column_count; col++) {
+		Oid oid = TupleDescAttr(tupdesc, col)->atttypid;
+		Datum *values = state->column_values[col];
+		bool *nulls = state->column_nulls[col];
+		if (pgduckdb::ConvertDuckToPostgresColumn(chunk.data[col], chunk.size(), oid, values, nulls)) {
+			continue;
+		}
+
+		for (idx_t row = 0; row < chunk.size(); row++) {
+			// FIXME: we should not use the Value API here, it's complicating the LIST conversion logic
+			auto value = chunk.GetValue(col, row);
+			if (value.IsNull()) {
+				values[row] = (Datum)0;
+				nulls[row] = true;
+				continue;
+			}
+
+			/* The Value conversion stores its result in the slot, so we take it from there */
+			if (!pgduckdb::ConvertDuckToPostgresValue(slot, value, col)) {
+				throw duckdb::ConversionException("Value conversion failed");
+			}
+			values[row] = slot->tts_values[col];
+			nulls[row] = false;
+		}
+	}
+
+	MemoryContextSwitchTo(old_context);
+}
+
+/*
+ * Fetches the next chunk of the DuckDB result and converts it to Postgres.
+ * Returns false once the result is exhausted.
+ */
+static bool
+FetchNextChunk(DuckdbScanState *state) {
+	if (!state->is_executed) {
+		ExecuteQuery(state);
+	}
+
+	state->current_row = 0;
+	if (state->result_buffer && state->next_buffered_chunk < state->result_buffer->ChunkCount()) {
+		/* Replay the chunks that were already fetched before a rescan */
+		state->current_data_chunk = duckdb::make_uniq<duckdb::DataChunk>();
+		state->current_data_chunk->Initialize(duckdb::Allocator::DefaultAllocator(), state->result_buffer->Types());
+		state->result_buffer->FetchChunk(state->next_buffered_chunk++, *state->current_data_chunk);
+	} else {
+		if (state->result_complete) {
+			state->current_chunk_size = 0;
+			return false;
+		}
+
+		/* DuckDB threads can only scan Postgres tables while we're waiting for the next chunk */
+		UnblockDuckdbThreads(state);
+		if (state->holds_threads) {
+			RebalanceThreads(state);
+		}
+		state->current_data_chunk = state->query_results->Fetch();
+		if (!state->current_data_chunk || state->current_data_chunk->size() == 0) {
+			state->current_data_chunk.reset();
+			state->current_chunk_size = 0;
+			state->result_complete = true;
+			ReleaseQueryResources(state);
+			if (state->streams_postgres_scans) {
+				/* The query is done, so DuckDB already cleaned up its scans */
+				UnregisterStreamingPostgresScans(state);
+			}
+			return false;
+		}
+
+		if (state->streams_postgres_scans) {
+			BlockDuckdbThreads(state);
+		}
+
+		if (state->result_buffer) {
+			/* Appending can fill up the last buffered chunk, which was already returned */
+			state->result_buffer->Append(*state->current_data_chunk);
+			state->next_buffered_chunk = state->result_buffer->ChunkCount();
+		}
+	}
+
+	state->current_chunk_size = state->current_data_chunk->size();
+	ConvertCurrentDataChunk(state);
+
+	/* All values are converted, so DuckDB its memory for the chunk can be freed already */
+	state->current_data_chunk.reset();
+	return true;
+}
+
+/* Stores an already converted row of the current chunk in the slot */
+static inline void
+StoreChunkRow(DuckdbScanState *state, TupleTableSlot *slot, idx_t row) {
+	ExecClearTuple(slot);
+	for (idx_t col = 0; col < state->column_count; col++) {
+		slot->tts_values[col] = state->column_values[col][row];
+		slot->tts_isnull[col] = state->column_nulls[col][row];
+	}
+	ExecStoreVirtualTuple(slot);
 }
 
 static TupleTableSlot *
@@ -256,57 +678,27 @@ Duckdb_ExecCustomScan_Cpp(CustomScanState *node) {
 	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)node;
 	try {
 		TupleTableSlot *slot = duckdb_scan_state->css.ss.ss_ScanTupleSlot;
-		MemoryContext old_context;
 
 		if (ActivePortal && ActivePortal->commandTag == CMDTAG_EXPLAIN) {
 			ExecClearTuple(slot);
 			return slot;
 		}
 
-		bool already_executed = duckdb_scan_state->is_executed;
-		if (!already_executed) {
-			ExecuteQuery(duckdb_scan_state);
-		}
-
 		if (duckdb_scan_state->fetch_next) {
-			duckdb_scan_state->current_data_chunk = duckdb_scan_state->query_results->Fetch();
-			duckdb_scan_state->current_row = 0;
-			duckdb_scan_state->fetch_next = false;
-			if (!duckdb_scan_state->current_data_chunk || duckdb_scan_state->current_data_chunk->size() == 0) {
-				MemoryContextReset(duckdb_scan_state->css.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
+			if (!FetchNextChunk(duckdb_scan_state)) {
 				ExecClearTuple(slot);
 				return slot;
 			}
+			duckdb_scan_state->fetch_next = false;
 		}
 
-		MemoryContextReset(duckdb_scan_state->css.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
-		ExecClearTuple(slot);
-
-		/* MemoryContext used for allocation */
-		old_context = MemoryContextSwitchTo(duckdb_scan_state->css.ss.ps.ps_ExprContext->ecxt_per_tuple_memory);
-
-		for (idx_t col = 0; col < duckdb_scan_state->column_count; col++) {
-			// FIXME: we should not use the Value API here, it's complicating the LIST conversion logic
-			auto value = duckdb_scan_state->current_data_chunk->GetValue(col, duckdb_scan_state->current_row);
-			if (value.IsNull()) {
-				slot->tts_isnull[col] = true;
-			} else {
-				slot->tts_isnull[col] = false;
-				if (!pgduckdb::ConvertDuckToPostgresValue(slot, value, col)) {
-					throw duckdb::ConversionException("Value conversion failed");
-				}
-			}
-		}
-
-		MemoryContextSwitchTo(old_context);
+		StoreChunkRow(duckdb_scan_state, slot, duckdb_scan_state->current_row);
 
 		duckdb_scan_state->current_row++;
-		if (duckdb_scan_state->current_row >= duckdb_scan_state->current_data_chunk->size()) {
-			duckdb_scan_state->current_data_chunk.reset();
+		if (duckdb_scan_state->current_row >= duckdb_scan_state->current_chunk_size) {
 			duckdb_scan_state->fetch_next = true;
 		}
 
-		ExecStoreVirtualTuple(slot);
 		return slot;
 	} catch (std::exception &ex) {
 		/*
@@ -329,6 +721,121 @@ Duckdb_ExecCustomScan(CustomScanState *node) {
 	return InvokeCPPFunc(Duckdb_ExecCustomScan_Cpp, node);
 }
 
+static bool
+Duckdb_FetchNextChunk_Cpp(DuckdbScanState *duckdb_scan_state) {
+	try {
+		return FetchNextChunk(duckdb_scan_state);
+	} catch (std::exception &ex) {
+		/* Same as in Duckdb_ExecCustomScan_Cpp */
+		CleanupDuckdbScanState(duckdb_scan_state);
+		throw;
+	}
+}
+
+/*
+ * Can the rows of this query be sent to its DestReceiver in bulk by
+ * DuckdbExecutorRunInBulk? That's only the case for plain SELECTs that are
+ * fully executed by DuckDB, and that fetch all their rows at once.
+ */
+bool
+CanRunDuckdbQueryInBulk(QueryDesc *query_desc, ScanDirection direction, uint64 count) {
+	PlanState *planstate = query_desc->planstate;
+	if (!IsA(planstate, CustomScanState) || ((CustomScanState *)planstate)->methods != &duckdb_scan_exec_methods) {
+		return false;
+	}
+
+	if (query_desc->operation != CMD_SELECT || query_desc->plannedstmt->hasReturning ||
+	    query_desc->plannedstmt->parallelModeNeeded) {
+		return false;
+	}
+
+	if (!ScanDirectionIsForward(direction) || count != 0) {
+		return false;
+	}
+
+	/*
+	 * A cursor that already returned some of the rows continues one row at a
+	 * time, so that the rest of the current chunk is not skipped.
+	 */
+	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)planstate;
+	if (duckdb_scan_state->is_executed || duckdb_scan_state->current_row != 0) {
+		return false;
+	}
+
+	/* EXPLAIN ANALYZE needs to see every row pass through the node */
+	if (planstate->instrument || planstate->ps_ProjInfo || query_desc->estate->es_junkFilter) {
+		return false;
+	}
+
+	return !(ActivePortal && ActivePortal->commandTag == CMDTAG_EXPLAIN);
+}
+
+/*
+ * Replacement for standard_ExecutorRun for queries that pass
+ * CanRunDuckdbQueryInBulk. Instead of pulling every row through
+ * ExecProcNode, the rows of each converted DuckDB chunk are handed to the
+ * DestReceiver in a tight loop. For a client connection that receiver builds
+ * the DataRow messages, for SQL functions and cursors it's a tuplestore.
+ */
+void
+DuckdbExecutorRunInBulk(QueryDesc *query_desc) {
+	EState *estate = query_desc->estate;
+	DestReceiver *dest = query_desc->dest;
+	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)query_desc->planstate;
+	TupleTableSlot *slot = duckdb_scan_state->css.ss.ss_ScanTupleSlot;
+
+	MemoryContext old_context = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	if (query_desc->totaltime) {
+		InstrStartNode(query_desc->totaltime);
+	}
+
+	estate->es_processed = 0;
+	estate->es_direction = ForwardScanDirection;
+	dest->rStartup(dest, CMD_SELECT, query_desc->tupDesc);
+
+	bool copy_out = IsDuckdbCopyOutReceiver(dest);
+	bool receiver_done = false;
+	while (!receiver_done && InvokeCPPFunc(Duckdb_FetchNextChunk_Cpp, duckdb_scan_state)) {
+		if (copy_out) {
+			/* COPY TO STDOUT takes a whole chunk at once, it resets its own memory for every row */
+			ResetPerTupleExprContext(estate);
+			DuckdbCopyOutReceiveChunk(dest, duckdb_scan_state->column_values, duckdb_scan_state->column_nulls,
+			                          duckdb_scan_state->current_chunk_size);
+			estate->es_processed += duckdb_scan_state->current_chunk_size;
+			continue;
+		}
+
+		for (idx_t row = 0; row < duckdb_scan_state->current_chunk_size; row++) {
+			ResetPerTupleExprContext(estate);
+			StoreChunkRow(duckdb_scan_state, slot, row);
+			if (!dest->receiveSlot(slot, dest)) {
+				receiver_done = true;
+				break;
+			}
+			estate->es_processed++;
+		}
+	}
+
+	/* Rows that the receiver did not want anymore are skipped */
+	duckdb_scan_state->fetch_next = true;
+	ExecClearTuple(slot);
+
+	ExecShutdownNode(query_desc->planstate);
+
+#if PG_VERSION_NUM >= 160000
+	estate->es_total_processed += estate->es_processed;
+#endif
+
+	dest->rShutdown(dest);
+
+	if (query_desc->totaltime) {
+		InstrStopNode(query_desc->totaltime, estate->es_processed);
+	}
+
+	MemoryContextSwitchTo(old_context);
+}
+
 static void
 Duckdb_EndCustomScan_Cpp(CustomScanState *node) {
 	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)node;
@@ -355,10 +862,88 @@ Duckdb_EndCustomScan(CustomScanState *node) {
 	InvokeCPPFunc(Duckdb_EndCustomScan_Cpp, node);
 }
 
+/*
+ * The DuckDB query keeps its prepared statement across rescans. If the values
+ * of its parameters did not change and the chunks it already returned were
+ * buffered, those are replayed. Otherwise the query is executed again, with
+ * the current parameter values.
+ */
+static void
+Duckdb_ReScanCustomScan_Cpp(CustomScanState *node) {
+	DuckdbScanState *duckdb_scan_state = (DuckdbScanState *)node;
+	duckdb_scan_state->fetch_next = true;
+	duckdb_scan_state->current_row = 0;
+	duckdb_scan_state->current_chunk_size = 0;
+	ExecClearTuple(duckdb_scan_state->css.ss.ss_ScanTupleSlot);
+
+	if (!duckdb_scan_state->is_executed) {
+		return;
+	}
+
+	if (duckdb_scan_state->result_buffer && node->ss.ps.chgParam == NULL) {
+		auto parameters = BindQueryParameters(duckdb_scan_state);
+		if (SameQueryParameters(*parameters, *duckdb_scan_state->bound_parameters)) {
+			duckdb_scan_state->next_buffered_chunk = 0;
+			return;
+		}
+	}
+
+	ResetQueryResult(duckdb_scan_state);
+}
+
 void
-Duckdb_ReScanCustomScan(CustomScanState * /*node*/) {
+Duckdb_ReScanCustomScan(CustomScanState *node) {
+	InvokeCPPFunc(Duckdb_ReScanCustomScan_Cpp, node);
 }
 
+namespace pgduckdb {
+
+/*
+ * Running another query on the DuckDB connection closes any streaming result
+ * of it, and the DuckDB threads of that query could not get the
+ * GlobalProcessLock while we block them from taking it. So before that happens, the streaming
+ * results that still read from Postgres tables are materialized instead.
+ */
+void
+MaterializeStreamingDuckdbScans() {
+	auto states = streaming_postgres_scans;
+	for (auto state : states) {
+		if (!state->blocks_duckdb_threads) {
+			/* We're in the middle of fetching from this one */
+			continue;
+		}
+
+		UnregisterStreamingPostgresScans(state);
+		auto &stream_result = static_cast<duckdb::StreamQueryResult &>(*state->query_results);
+		state->query_results = stream_result.Materialize();
+	}
+}
+
+/*
+ * Called when the transaction aborts. ExecutorEnd is not called for a failed
+ * portal, so the streaming results that still read from Postgres tables need
+ * to be stopped here. Postgres already released the resources of their scans,
+ * which the DuckDB threads notice through CheckPostgresScansNotAborted.
+ */
+void
+AbortStreamingDuckdbScans() {
+	for (auto state : streaming_postgres_scans) {
+		InterruptStreamingResult(state);
+		state->streams_postgres_scans = false;
+		state->query_results.reset();
+		state->current_data_chunk.reset();
+		state->prepared_statement.reset();
+		/* The resource owner of the transaction closes these */
+		state->planned_relations = NIL;
+		/* ReleaseAllDuckdbThreads and ReleaseAllDuckdbQueryAdmissions release these */
+		state->admitted = false;
+		state->holds_threads = false;
+	}
+	streaming_postgres_scans.clear();
+}
+
+} // namespace pgduckdb
+
 static void
 Duckdb_ExplainCustomScan_Cpp(CustomScanState *node, ExplainState *es) {
 	/*
@@ -433,6 +1018,7 @@ DuckdbInitNode() {
 	duckdb_scan_scan_methods.CustomName = "DuckDBScan";
 	duckdb_scan_scan_methods.CreateCustomScanState = Duckdb_CreateCustomScanState;
 	RegisterCustomScanMethods(&duckdb_scan_scan_methods);
+	RegisterPlannedDuckdbStatementNode();
 
 	/* setup exec methods */
 	memset(&duckdb_scan_exec_methods, 0, sizeof(duckdb_scan_exec_methods));
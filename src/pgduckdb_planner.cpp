@@ -4,8 +4,11 @@
 
 #include "pgduckdb/catalog/pgduckdb_transaction.hpp"
 #include "pgduckdb/scan/postgres_scan.hpp"
+#include "pgduckdb/pg/relations.hpp"
+#include "pgduckdb/pgduckdb_process_lock.hpp"
 #include "pgduckdb/pgduckdb_types.hpp"
 #include "pgduckdb/pgduckdb_planner.hpp"
+#include "pgduckdb/pgduckdb_utils.hpp"
 
 extern "C" {
 #include "postgres.h"
@@ -13,6 +16,8 @@ extern "C" {
 #include "access/xact.h"
 #include "catalog/pg_type.h"
 #include "nodes/makefuncs.h"
+#include "nodes/extensible.h"
+#include "nodes/nodeFuncs.h"
 #include "nodes/nodes.h"
 #include "nodes/params.h"
 #include "optimizer/optimizer.h"
@@ -24,6 +29,7 @@ extern "C" {
 #include "parser/parse_relation.h"
 #include "utils/acl.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 
 #include "pgduckdb/pgduckdb_ruleutils.h"
@@ -34,13 +40,20 @@ extern "C" {
 }
 
 #include "pgduckdb/pgduckdb_duckdb.hpp"
+#include "pgduckdb/pgduckdb_hooks.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
 #include "pgduckdb/pgduckdb_node.hpp"
 #include "pgduckdb/vendor/pg_list.hpp"
 #include "pgduckdb/utility/cpp_wrapper.hpp"
 #include "pgduckdb/pgduckdb_types.hpp"
 
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
 duckdb::unique_ptr<duckdb::PreparedStatement>
 DuckdbPrepare(const Query *query, const char *explain_prefix) {
+	pgduckdb::AttachLocalStorageForQuery(query);
 	Query *copied_query = (Query *)copyObjectImpl(query);
 	const char *query_string = pgduckdb_get_querydef(copied_query);
 
@@ -50,10 +63,236 @@ DuckdbPrepare(const Query *query, const char *explain_prefix) {
 
 	elog(DEBUG2, "(PGDuckDB/DuckdbPrepare) Preparing: %s", query_string);
 
-	auto con = pgduckdb::DuckDBManager::GetConnection();
+	auto con = pgduckdb::DuckDBManager::GetConnection(false, pgduckdb::NeedsDuckdbExtensions(query));
 	return con->context->Prepare(query_string);
 }
 
+/*
+ * The DuckDB statement that was prepared while planning. Executing a plan
+ * uses its statement directly, instead of deparsing and preparing the query
+ * a second time. For the generic plan of a prepared statement that means
+ * only the parameters are bound on every execution.
+ *
+ * A statement is bound to the Postgres relations that it reads, including
+ * their relcache entries, so like the plan of a prepared statement it can't
+ * be used anymore once one of those changes. DuckDB rebinds a prepared
+ * statement by itself when one of its own catalogs changed. The search_path
+ * is fixed already when deparsing the query, because all names are
+ * qualified, and changing it replans any cached plan.
+ */
+struct PlannedDuckdbStatement {
+	PlannedDuckdbStatement(duckdb::unique_ptr<duckdb::PreparedStatement> prepared_statement, std::vector<Oid> relids);
+	~PlannedDuckdbStatement();
+
+	std::shared_ptr<duckdb::PreparedStatement> prepared_statement;
+	std::vector<Oid> relids;
+	bool valid;
+};
+
+/* All statements that are still referenced by a plan, so that they can be invalidated */
+static std::unordered_set<PlannedDuckdbStatement *> planned_statements;
+
+void
+InvalidatePlannedStatements(Oid relid) {
+	for (auto statement : planned_statements) {
+		if (relid == InvalidOid ||
+		    std::find(statement->relids.begin(), statement->relids.end(), relid) != statement->relids.end()) {
+			statement->valid = false;
+		}
+	}
+}
+
+PlannedDuckdbStatement::PlannedDuckdbStatement(duckdb::unique_ptr<duckdb::PreparedStatement> _prepared_statement,
+                                               std::vector<Oid> _relids)
+    : prepared_statement(_prepared_statement.release()), relids(std::move(_relids)), valid(true) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
+	planned_statements.insert(this);
+}
+
+PlannedDuckdbStatement::~PlannedDuckdbStatement() {
+	std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
+	planned_statements.erase(this);
+}
+
+/*
+ * The statements belong to the DuckDB instance that prepared them, so they
+ * can't be used anymore once it's reset.
+ */
+void
+DropPlannedDuckdbStatements() {
+	std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
+	for (auto statement : planned_statements) {
+		statement->valid = false;
+		statement->prepared_statement.reset();
+	}
+}
+
+/*
+ * Plans are copied around freely, e.g. when the plan cache saves them. So the
+ * CustomScan refers to its statement through this node in custom_private,
+ * and every copy of the node holds a reference to the statement until the
+ * memory context that the copy lives in is reset. That way the statement
+ * lives exactly as long as the plans that can execute it, whether that's a
+ * CachedPlan, the plan of a single query, or the plan of an SPI statement.
+ */
+typedef struct PlannedDuckdbStatementNode {
+	ExtensibleNode node;
+	/* Deleted by ReleasePlannedStatement when the memory context of the node is reset */
+	std::shared_ptr<PlannedDuckdbStatement> *statement;
+} PlannedDuckdbStatementNode;
+
+#define PLANNED_DUCKDB_STATEMENT_NODE_NAME "PlannedDuckdbStatement"
+
+static void
+ReleasePlannedStatement(void *arg) {
+	delete static_cast<std::shared_ptr<PlannedDuckdbStatement> *>(arg);
+}
+
+static void
+AttachPlannedStatement(PlannedDuckdbStatementNode *node, const std::shared_ptr<PlannedDuckdbStatement> &statement) {
+	MemoryContext context = GetMemoryChunkContext(node);
+	auto callback = static_cast<MemoryContextCallback *>(MemoryContextAlloc(context, sizeof(MemoryContextCallback)));
+	node->statement = new std::shared_ptr<PlannedDuckdbStatement>(statement);
+	callback->func = ReleasePlannedStatement;
+	callback->arg = node->statement;
+	MemoryContextRegisterResetCallback(context, callback);
+}
+
+static void
+CopyPlannedStatementNode(ExtensibleNode *new_node, const ExtensibleNode *old_node) {
+	auto old_statement = reinterpret_cast<const PlannedDuckdbStatementNode *>(old_node)->statement;
+	auto new_statement_node = reinterpret_cast<PlannedDuckdbStatementNode *>(new_node);
+	new_statement_node->statement = nullptr;
+	if (old_statement) {
+		AttachPlannedStatement(new_statement_node, *old_statement);
+	}
+}
+
+static bool
+EqualPlannedStatementNode(const ExtensibleNode *a, const ExtensibleNode *b) {
+	auto a_statement = reinterpret_cast<const PlannedDuckdbStatementNode *>(a)->statement;
+	auto b_statement = reinterpret_cast<const PlannedDuckdbStatementNode *>(b)->statement;
+	if (!a_statement || !b_statement) {
+		return a_statement == b_statement;
+	}
+	return a_statement->get() == b_statement->get();
+}
+
+/* The statement can't be serialized, a plan that's read back prepares the query again */
+static void
+OutPlannedStatementNode(StringInfo, const ExtensibleNode *) {
+}
+
+static void
+ReadPlannedStatementNode(ExtensibleNode *node) {
+	reinterpret_cast<PlannedDuckdbStatementNode *>(node)->statement = nullptr;
+}
+
+static const ExtensibleNodeMethods planned_statement_node_methods = {
+    PLANNED_DUCKDB_STATEMENT_NODE_NAME, sizeof(PlannedDuckdbStatementNode),
+    CopyPlannedStatementNode,           EqualPlannedStatementNode,
+    OutPlannedStatementNode,            ReadPlannedStatementNode,
+};
+
+void
+RegisterPlannedDuckdbStatementNode() {
+	RegisterExtensibleNodeMethods(&planned_statement_node_methods);
+}
+
+static bool
+CollectRelations(Node *node, void *context) {
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Query)) {
+		auto relids = static_cast<std::vector<Oid> *>(context);
+		Query *query = (Query *)node;
+		foreach_node(RangeTblEntry, rte, query->rtable) {
+			if (rte->rtekind == RTE_RELATION &&
+			    std::find(relids->begin(), relids->end(), rte->relid) == relids->end()) {
+				relids->push_back(rte->relid);
+			}
+		}
+
+#if PG_VERSION_NUM >= 160000
+		return query_tree_walker(query, CollectRelations, context, 0);
+#else
+		return query_tree_walker(query, (bool (*)())((void *)CollectRelations), context, 0);
+#endif
+	}
+
+#if PG_VERSION_NUM >= 160000
+	return expression_tree_walker(node, CollectRelations, context);
+#else
+	return expression_tree_walker(node, (bool (*)())((void *)CollectRelations), context);
+#endif
+}
+
+/* Creates the node that refers to the statement for the plan of the query */
+static Node *
+MakePlannedStatementNode(Query *query, duckdb::unique_ptr<duckdb::PreparedStatement> prepared_query) {
+	std::vector<Oid> relids;
+	CollectRelations((Node *)query, &relids);
+
+	auto node = (PlannedDuckdbStatementNode *)newNode(sizeof(PlannedDuckdbStatementNode), T_ExtensibleNode);
+	node->node.extnodename = PLANNED_DUCKDB_STATEMENT_NODE_NAME;
+	node->statement = nullptr;
+	AttachPlannedStatement(node, std::make_shared<PlannedDuckdbStatement>(std::move(prepared_query), relids));
+	return (Node *)node;
+}
+
+/*
+ * Returns the statement that was prepared when planning the CustomScan, or
+ * nullptr if it can't be used anymore.
+ *
+ * The relations that the statement reads are opened and appended to
+ * *relations. They need to stay open while the statement is executed, just
+ * like the Postgres catalog of DuckDB keeps them open for a statement that is
+ * prepared from scratch, and should be closed with CloseRelation after that.
+ * The Postgres scans of the statement look up the relcache entries of these
+ * relations again on every execution.
+ */
+std::shared_ptr<duckdb::PreparedStatement>
+GetPlannedDuckdbStatement(const CustomScan *custom_scan, List **relations) {
+	if (list_length(custom_scan->custom_private) < 2) {
+		return nullptr;
+	}
+
+	auto node = (PlannedDuckdbStatementNode *)lsecond(custom_scan->custom_private);
+	if (!node->statement) {
+		return nullptr;
+	}
+
+	std::lock_guard<pgduckdb::ProcessLock> lock(pgduckdb::GlobalProcessLock::GetLock());
+	auto &statement = **node->statement;
+
+	/*
+	 * Like AcquireExecutorLocks does for cached plans: locking the relations
+	 * processes any pending invalidations, after which we know if the
+	 * statement is still valid.
+	 */
+	List *opened_relations = NIL;
+	for (Oid relid : statement.relids) {
+		Relation rel = pgduckdb::TryOpenRelation(relid);
+		if (!rel) {
+			statement.valid = false;
+			break;
+		}
+		opened_relations = lappend(opened_relations, rel);
+	}
+
+	if (!statement.valid) {
+		foreach_ptr(RelationData, rel, opened_relations) {
+			pgduckdb::CloseRelation(rel);
+		}
+		return nullptr;
+	}
+
+	*relations = list_concat(*relations, opened_relations);
+	/* Shares ownership with the plan, so the statement outlives its execution even if the plan is freed */
+	return std::shared_ptr<duckdb::PreparedStatement>(*node->statement, statement.prepared_statement.get());
+}
+
 static Plan *
 CreatePlan(Query *query, bool throw_error) {
 	int elevel = throw_error ? ERROR : WARNING;
@@ -116,7 +355,7 @@ CreatePlan(Query *query, bool throw_error) {
 		ReleaseSysCache(tp);
 	}
 
-	duckdb_node->custom_private = list_make1(query);
+	duckdb_node->custom_private = list_make2(query, MakePlannedStatementNode(query, std::move(prepared_query)));
 	duckdb_node->methods = &duckdb_scan_scan_methods;
 
 	return (Plan *)duckdb_node;
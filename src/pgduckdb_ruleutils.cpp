@@ -41,8 +41,11 @@ extern "C" {
 #include "pgduckdb/pgduckdb.h"
 #include "pgduckdb/pgduckdb_table_am.hpp"
 #include "pgduckdb/pgduckdb_duckdb.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
 #include "pgduckdb/pgduckdb_userdata_cache.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
 
 extern "C" {
 bool outermost_query = true;
@@ -485,6 +488,19 @@ pgduckdb_db_and_schema(const char *postgres_schema_name, const char *duckdb_tabl
 		return list_make2((void *)"pg_temp", (void *)"main");
 	}
 
+	if (pgduckdb::duckdb_local_storage) {
+		/*
+		 * The DuckDB query that uses these names needs the database file to be
+		 * attached. Queries and DDL that change the tables attached it for
+		 * writing already.
+		 */
+		InvokeCPPFunc(pgduckdb::AttachLocalStorage, false);
+		if (strcmp("public", postgres_schema_name) == 0) {
+			return list_make2((void *)pgduckdb::LOCAL_STORAGE_DATABASE, (void *)"main");
+		}
+		return list_make2((void *)pgduckdb::LOCAL_STORAGE_DATABASE, (void *)postgres_schema_name);
+	}
+
 	if (strcmp("public", postgres_schema_name) == 0) {
 		/* Use the "main" schema in DuckDB for tables in the public schema in Postgres */
 		auto dbname = pgduckdb::DuckDBManager::Get().GetDefaultDBName().c_str();
@@ -649,6 +665,8 @@ pgduckdb_get_tabledef(Oid relation_oid) {
 		// allowed
 	} else if (relation->rd_rel->relpersistence != RELPERSISTENCE_PERMANENT) {
 		elog(ERROR, "Only TEMP and non-UNLOGGED tables are supported in DuckDB");
+	} else if (pgduckdb::duckdb_local_storage) {
+		// allowed, local tables keep their owner
 	} else if (relation->rd_rel->relowner != pgduckdb::MotherDuckPostgresUserOid()) {
 		elog(ERROR, "MotherDuck tables must be owned by the duckb.postgres_role");
 	}
@@ -0,0 +1,853 @@
+#include "duckdb.hpp"
+#include "duckdb/common/serializer/binary_deserializer.hpp"
+#include "duckdb/common/serializer/binary_serializer.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
+
+#include "pgduckdb/pg/error_data.hpp"
+#include "pgduckdb/pgduckdb_admission.hpp"
+#include "pgduckdb/pgduckdb_duckdb.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_hooks.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
+#include "pgduckdb/pgduckdb_metadata_cache.hpp"
+#include "pgduckdb/pgduckdb_shared_engine.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
+#include "pgduckdb/pgduckdb_utils.hpp"
+
+extern "C" {
+#include "postgres.h"
+#include "access/xact.h"
+#include "catalog/pg_class.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "postmaster/autovacuum.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/interrupt.h"
+#include "replication/walsender.h"
+#include "storage/dsm.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/snapmgr.h"
+#include "utils/wait_event.h"
+#if PG_VERSION_NUM >= 190000
+#include "storage/waiteventset.h"
+#endif
+
+#include "pgduckdb/pgduckdb_ruleutils.h"
+}
+
+#include "pgduckdb/vendor/pg_list.hpp"
+
+#include <string>
+#include <vector>
+
+namespace pgduckdb {
+
+#define PGDUCKDB_SHARED_ENGINE_NAME "pg_duckdb shared engine"
+
+/*
+ * The size of the queue that the shared engine sends the result chunks of a
+ * query through. Chunks that don't fit are sent in multiple parts.
+ */
+static const Size SHARED_ENGINE_QUEUE_SIZE = 1024 * 1024;
+
+/* The types of the messages that the shared engine sends back */
+static const char SHARED_ENGINE_CHUNK = 'D';
+static const char SHARED_ENGINE_COMPLETE = 'C';
+static const char SHARED_ENGINE_ERROR = 'E';
+
+/*
+ * A backend submits a query to the shared engine by creating a DSM segment
+ * that contains the deparsed query, its parameters and the queue that the
+ * results are sent back through. It then puts the handle of that segment in
+ * its slot, and sets the latch of the shared engine. The slots are indexed
+ * by the number of the PGPROC of the backend.
+ */
+typedef struct SharedEngineShmemStruct {
+	slock_t lock; /* protects all the fields below */
+
+	pid_t worker_pid; /* 0 if the shared engine is not running */
+	Latch *worker_latch;
+	Oid database_id;
+	int num_requests;
+	dsm_handle requests[1]; /* actually num_requests long, DSM_HANDLE_INVALID for empty slots */
+} SharedEngineShmemStruct;
+
+static SharedEngineShmemStruct *SharedEngine;
+
+/*
+ * The layout of the DSM segment of a request, the fields are followed by the
+ * query, settings, parameters and queue.
+ */
+typedef struct SharedEngineRequest {
+	/* Set once the backend detached, so that the shared engine stops executing the query */
+	pg_atomic_uint32 backend_detached;
+	Size query_size;
+	Size settings_size;
+	Size parameters_size; /* 0 if the query has no parameters */
+} SharedEngineRequest;
+
+/*
+ * The settings of the backend that the shared engine applies before it
+ * executes a query, because they change its result. Their values are sent
+ * in this order, each terminated by a NUL byte.
+ */
+static const char *SHARED_ENGINE_SETTINGS[] = {"TimeZone", "default_collation"};
+
+/* Is this process the shared engine itself? */
+static bool is_shared_engine = false;
+
+static int
+NumRequests() {
+#if PG_VERSION_NUM >= 150000
+	return MaxBackends;
+#else
+	/* See NumReservations in pgduckdb_memory_governor.cpp */
+	return MaxConnections + autovacuum_max_workers + 1 + max_worker_processes + max_wal_senders;
+#endif
+}
+
+static int
+MyRequestIndex() {
+#if PG_VERSION_NUM >= 170000
+	return MyProcNumber;
+#else
+	return MyProc->pgprocno;
+#endif
+}
+
+static Size
+SharedEngineShmemSize() {
+	return add_size(offsetof(SharedEngineShmemStruct, requests), mul_size(NumRequests(), sizeof(dsm_handle)));
+}
+
+static void
+InitSharedEngineStruct() {
+	MemSet(SharedEngine, 0, SharedEngineShmemSize());
+	SpinLockInit(&SharedEngine->lock);
+	SharedEngine->num_requests = NumRequests();
+	for (int i = 0; i < SharedEngine->num_requests; i++) {
+		SharedEngine->requests[i] = DSM_HANDLE_INVALID;
+	}
+}
+
+#if PG_VERSION_NUM >= 190000
+
+static void
+SharedEngineShmemRequest(void * /*opaque_arg*/) {
+	ShmemStructOpts struct_opts = {
+	    .name = "DuckdbSharedEngine Data",
+	    .size = SharedEngineShmemSize(),
+	    .ptr = (void **)&SharedEngine,
+	};
+	ShmemRequestStructWithOpts(&struct_opts);
+}
+
+static void
+SharedEngineShmemInit(void * /*opaque_arg*/) {
+	InitSharedEngineStruct();
+}
+
+#else
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void
+SharedEngineShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+#endif
+
+	RequestAddinShmemSpace(SharedEngineShmemSize());
+}
+
+static void
+SharedEngineShmemStartup(void) {
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	bool found;
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	SharedEngine =
+	    (SharedEngineShmemStruct *)ShmemInitStruct("DuckdbSharedEngine Data", SharedEngineShmemSize(), &found);
+	if (!found) {
+		InitSharedEngineStruct();
+	}
+	LWLockRelease(AddinShmemInitLock);
+}
+
+#endif
+
+void
+InitSharedEngine(void) {
+#if PG_VERSION_NUM >= 190000
+	/* See InitBackgroundWorkersShmem on why this is static */
+	static const ShmemCallbacks callbacks = {
+	    .request_fn = SharedEngineShmemRequest,
+	    .init_fn = SharedEngineShmemInit,
+	};
+	RegisterShmemCallbacks(&callbacks);
+#else
+#if PG_VERSION_NUM >= 150000
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = SharedEngineShmemRequest;
+#else
+	SharedEngineShmemRequest();
+#endif
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = SharedEngineShmemStartup;
+#endif
+
+	if (IsEmptyString(duckdb_shared_engine_database)) {
+		return;
+	}
+
+	BackgroundWorker worker;
+	memset(&worker, 0, sizeof(worker));
+	worker.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION;
+	worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+	snprintf(worker.bgw_library_name, BGW_MAXLEN, "pg_duckdb");
+	snprintf(worker.bgw_function_name, BGW_MAXLEN, "pgduckdb_shared_engine_main");
+	snprintf(worker.bgw_name, BGW_MAXLEN, PGDUCKDB_SHARED_ENGINE_NAME);
+	snprintf(worker.bgw_type, BGW_MAXLEN, PGDUCKDB_SHARED_ENGINE_NAME);
+	worker.bgw_restart_time = 10;
+	RegisterBackgroundWorker(&worker);
+}
+
+static uint32
+SharedEngineWaitEvent() {
+#if PG_VERSION_NUM >= 170000
+	static uint32 wait_event = 0;
+	if (wait_event == 0) {
+		wait_event = WaitEventExtensionNew("DuckdbSharedEngine");
+	}
+	return wait_event;
+#else
+	return PG_WAIT_EXTENSION;
+#endif
+}
+
+static std::string
+SerializeChunk(duckdb::DataChunk &chunk) {
+	duckdb::MemoryStream stream;
+	duckdb::BinarySerializer serializer(stream);
+	serializer.Begin();
+	chunk.Serialize(serializer);
+	serializer.End();
+	return std::string((const char *)stream.GetData(), stream.GetPosition());
+}
+
+static void
+DeserializeChunk(const char *data, Size size, duckdb::DataChunk &chunk) {
+	duckdb::MemoryStream stream((duckdb::data_ptr_t)data, size);
+	duckdb::BinaryDeserializer deserializer(stream);
+	deserializer.Begin();
+	chunk.Deserialize(deserializer);
+	deserializer.End();
+}
+
+/*
+ * The parameters are sent as a chunk with a single row, whose first half of
+ * the columns contains their names and the second half their values.
+ */
+static std::string
+SerializeParameters(const duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &parameters) {
+	duckdb::vector<duckdb::LogicalType> types(parameters.size(), duckdb::LogicalType::VARCHAR);
+	for (auto &parameter : parameters) {
+		auto &type = parameter.second.GetValue().type();
+		/* A vector can't be of the NULL type, so NULLs are sent as VARCHAR */
+		types.push_back(type.id() == duckdb::LogicalTypeId::SQLNULL ? duckdb::LogicalType::VARCHAR : type);
+	}
+
+	duckdb::DataChunk chunk;
+	chunk.Initialize(duckdb::Allocator::DefaultAllocator(), types);
+	duckdb::idx_t column = 0;
+	for (auto &parameter : parameters) {
+		chunk.SetValue(column, 0, duckdb::Value(parameter.first));
+		chunk.SetValue(parameters.size() + column, 0,
+		               parameter.second.GetValue().DefaultCastAs(types[parameters.size() + column]));
+		column++;
+	}
+	chunk.SetCardinality(1);
+	return SerializeChunk(chunk);
+}
+
+static duckdb::case_insensitive_map_t<duckdb::BoundParameterData>
+DeserializeParameters(const char *data, Size size) {
+	duckdb::case_insensitive_map_t<duckdb::BoundParameterData> parameters;
+	if (size == 0) {
+		return parameters;
+	}
+
+	duckdb::DataChunk chunk;
+	DeserializeChunk(data, size, chunk);
+	auto num_parameters = chunk.ColumnCount() / 2;
+	for (duckdb::idx_t column = 0; column < num_parameters; column++) {
+		auto name = chunk.GetValue(column, 0).ToString();
+		auto value = chunk.GetValue(num_parameters + column, 0);
+		if (value.IsNull()) {
+			value = duckdb::Value();
+		}
+		parameters[name] = duckdb::BoundParameterData(value);
+	}
+	return parameters;
+}
+
+static char *
+RequestQuery(SharedEngineRequest *request) {
+	return (char *)request + MAXALIGN(sizeof(SharedEngineRequest));
+}
+
+static char *
+RequestSettings(SharedEngineRequest *request) {
+	return RequestQuery(request) + MAXALIGN(request->query_size);
+}
+
+static char *
+RequestParameters(SharedEngineRequest *request) {
+	return RequestSettings(request) + MAXALIGN(request->settings_size);
+}
+
+static shm_mq *
+RequestQueue(SharedEngineRequest *request) {
+	return (shm_mq *)(RequestParameters(request) + MAXALIGN(request->parameters_size));
+}
+
+/*
+ * The shared engine executes the queries of the backend under its own user,
+ * and with its own secrets and settings. So only superusers use it, because
+ * they'd be allowed to do everything the shared engine does anyway.
+ */
+static pid_t
+SharedEngineForThisBackend() {
+	if (!SharedEngine || is_shared_engine || !duckdb_use_shared_engine || !superuser()) {
+		return 0;
+	}
+
+	SpinLockAcquire(&SharedEngine->lock);
+	pid_t worker_pid = SharedEngine->database_id == MyDatabaseId ? SharedEngine->worker_pid : 0;
+	SpinLockRelease(&SharedEngine->lock);
+	return worker_pid;
+}
+
+static bool
+ReadsTemporaryTable(Node *node, void *context) {
+	if (node == NULL)
+		return false;
+
+	if (IsA(node, Query)) {
+		Query *query = (Query *)node;
+		foreach_node(RangeTblEntry, rte, query->rtable) {
+			if (rte->rtekind == RTE_RELATION && get_rel_persistence(rte->relid) == RELPERSISTENCE_TEMP) {
+				return true;
+			}
+		}
+
+#if PG_VERSION_NUM >= 160000
+		return query_tree_walker(query, ReadsTemporaryTable, context, 0);
+#else
+		return query_tree_walker(query, (bool (*)())((void *)ReadsTemporaryTable), context, 0);
+#endif
+	}
+
+#if PG_VERSION_NUM >= 160000
+	return expression_tree_walker(node, ReadsTemporaryTable, context);
+#else
+	return expression_tree_walker(node, (bool (*)())((void *)ReadsTemporaryTable), context);
+#endif
+}
+
+bool
+CanUseSharedEngine(const Query *query) {
+	if (query->commandType != CMD_SELECT || query->rowMarks != NIL || query->hasModifyingCTE) {
+		return false;
+	}
+
+	if (SharedEngineForThisBackend() == 0) {
+		return false;
+	}
+
+	return !ContainsPostgresTable((Node *)query, NULL) && !ReadsTemporaryTable((Node *)query, NULL) &&
+	       !ReadsLocalStorageTable((Node *)query, NULL);
+}
+
+/* The values of SHARED_ENGINE_SETTINGS in this backend, as they are sent with a request */
+static std::string
+SerializeSettings() {
+	std::string settings;
+	settings += GetConfigOption("TimeZone", false, false);
+	settings += '\0';
+	settings += duckdb_default_collation;
+	settings += '\0';
+	return settings;
+}
+
+static void
+MarkRequestDetached(dsm_segment * /*segment*/, Datum arg) {
+	auto request = (SharedEngineRequest *)DatumGetPointer(arg);
+	pg_atomic_write_u32(&request->backend_detached, 1);
+}
+
+/*
+ * Creates the DSM segment of a request and hands it to the shared engine.
+ * Returns NULL if the shared engine is not running (anymore).
+ */
+static dsm_segment *
+SubmitRequest(const Query *query, const std::string *parameters, pid_t *worker_pid) {
+	const char *query_string = pgduckdb_get_querydef((Query *)copyObjectImpl(query));
+	Size query_size = strlen(query_string);
+	std::string settings = SerializeSettings();
+	Size segment_size = MAXALIGN(sizeof(SharedEngineRequest)) + MAXALIGN(query_size) + MAXALIGN(settings.size()) +
+	                    MAXALIGN(parameters->size()) + SHARED_ENGINE_QUEUE_SIZE;
+
+	dsm_segment *segment = dsm_create(segment_size, 0);
+	auto request = (SharedEngineRequest *)dsm_segment_address(segment);
+	pg_atomic_init_u32(&request->backend_detached, 0);
+	on_dsm_detach(segment, MarkRequestDetached, PointerGetDatum(request));
+	request->query_size = query_size;
+	request->settings_size = settings.size();
+	request->parameters_size = parameters->size();
+	memcpy(RequestQuery(request), query_string, query_size);
+	memcpy(RequestSettings(request), settings.data(), settings.size());
+	memcpy(RequestParameters(request), parameters->data(), parameters->size());
+	shm_mq *queue = shm_mq_create(RequestQueue(request), SHARED_ENGINE_QUEUE_SIZE);
+	shm_mq_set_receiver(queue, MyProc);
+
+	/* Wait until the shared engine picked up the previous request of this backend, if any */
+	auto &slot = SharedEngine->requests[MyRequestIndex()];
+	while (true) {
+		SpinLockAcquire(&SharedEngine->lock);
+		*worker_pid = SharedEngine->worker_pid;
+		Latch *worker_latch = SharedEngine->worker_latch;
+		bool submitted = false;
+		if (*worker_pid != 0 && slot == DSM_HANDLE_INVALID) {
+			slot = dsm_segment_handle(segment);
+			submitted = true;
+		}
+		SpinLockRelease(&SharedEngine->lock);
+
+		if (*worker_pid == 0) {
+			dsm_detach(segment);
+			return NULL;
+		}
+
+		if (submitted) {
+			SetLatch(worker_latch);
+			elog(DEBUG1, "[PGDuckDB] Executing the query in the shared engine with PID %d", *worker_pid);
+			return segment;
+		}
+
+		(void)WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH, 10, SharedEngineWaitEvent());
+		ResetLatch(MyLatch);
+		/* The shared engine executes one query at a time, so this can take long */
+		ProcessCancelInterrupts();
+	}
+}
+
+static shm_mq_handle *
+AttachToResponseQueue(dsm_segment *segment) {
+	auto request = (SharedEngineRequest *)dsm_segment_address(segment);
+	return shm_mq_attach(RequestQueue(request), segment, NULL);
+}
+
+/*
+ * Receives the next message of the shared engine. There's no background
+ * worker handle to notice that the shared engine exited, so instead we
+ * check that the one we submitted the query to is still running.
+ */
+static shm_mq_result
+ReceiveFromSharedEngine(shm_mq_handle *queue, pid_t worker_pid, Size *nbytes, void **data) {
+	while (true) {
+		shm_mq_result result = shm_mq_receive(queue, nbytes, data, true);
+		if (result != SHM_MQ_WOULD_BLOCK) {
+			return result;
+		}
+
+		SpinLockAcquire(&SharedEngine->lock);
+		bool running = SharedEngine->worker_pid == worker_pid;
+		SpinLockRelease(&SharedEngine->lock);
+		if (!running) {
+			return SHM_MQ_DETACHED;
+		}
+
+		(void)WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH, 1000, SharedEngineWaitEvent());
+		ResetLatch(MyLatch);
+		/* This backend doesn't execute anything of the query itself, so it can be canceled */
+		ProcessCancelInterrupts();
+	}
+}
+
+static void
+ForgetSegment(dsm_segment * /*segment*/, Datum arg) {
+	*(dsm_segment **)DatumGetPointer(arg) = nullptr;
+}
+
+/*
+ * The result of a query that the shared engine executes. Its chunks are
+ * received one by one while they are fetched. The DSM segment of the request
+ * belongs to the resource owner of the query, so when the transaction aborts
+ * Postgres detaches it before this result is destroyed.
+ */
+class SharedEngineQueryResult : public duckdb::QueryResult {
+public:
+	SharedEngineQueryResult(duckdb::PreparedStatement &prepared, duckdb::ClientContext &context, dsm_segment *segment_,
+	                        shm_mq_handle *queue_, pid_t worker_pid_)
+	    : duckdb::QueryResult(duckdb::QueryResultType::STREAM_RESULT, prepared.GetStatementType(),
+	                          prepared.GetStatementProperties(), prepared.GetTypes(), prepared.GetNames(),
+	                          context.GetClientProperties()),
+	      segment(segment_), queue(queue_), worker_pid(worker_pid_), finished(false) {
+		on_dsm_detach(segment, ForgetSegment, PointerGetDatum(&segment));
+	}
+
+	~SharedEngineQueryResult() override {
+		if (segment) {
+			std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+			dsm_detach(segment);
+		}
+	}
+
+	std::string
+	ToString() override {
+		return "[[SHARED ENGINE RESULT]]";
+	}
+
+protected:
+	duckdb::unique_ptr<duckdb::DataChunk>
+	FetchRaw() override {
+		if (finished) {
+			return nullptr;
+		}
+
+		if (!segment) {
+			throw duckdb::IOException("The result of the DuckDB shared engine is not available anymore");
+		}
+
+		Size nbytes;
+		void *data;
+		auto result = PostgresFunctionGuard(ReceiveFromSharedEngine, queue, worker_pid, &nbytes, &data);
+		if (result != SHM_MQ_SUCCESS || nbytes == 0) {
+			finished = true;
+			throw duckdb::IOException("The DuckDB shared engine exited while executing the query");
+		}
+
+		auto message = (const char *)data;
+		switch (message[0]) {
+		case SHARED_ENGINE_CHUNK: {
+			auto chunk = duckdb::make_uniq<duckdb::DataChunk>();
+			DeserializeChunk(message + 1, nbytes - 1, *chunk);
+			return chunk;
+		}
+		case SHARED_ENGINE_ERROR:
+			finished = true;
+			duckdb::ErrorData(std::string(message + 1, nbytes - 1)).Throw();
+		default:
+			finished = true;
+			return nullptr;
+		}
+	}
+
+private:
+	dsm_segment *segment;
+	shm_mq_handle *queue;
+	pid_t worker_pid;
+	bool finished;
+};
+
+duckdb::unique_ptr<duckdb::QueryResult>
+ExecuteInSharedEngine(const Query *query, const duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &parameters,
+                      duckdb::PreparedStatement &prepared, duckdb::ClientContext &context) {
+	std::string serialized_parameters;
+	if (!parameters.empty()) {
+		serialized_parameters = SerializeParameters(parameters);
+	}
+
+	pid_t worker_pid;
+	auto segment = PostgresFunctionGuard(SubmitRequest, query, &serialized_parameters, &worker_pid);
+	if (!segment) {
+		return nullptr;
+	}
+
+	auto queue = PostgresFunctionGuard(AttachToResponseQueue, segment);
+	return duckdb::make_uniq<SharedEngineQueryResult>(prepared, context, segment, queue, worker_pid);
+}
+
+/* A query that the shared engine executed, and whose result it's still sending back */
+struct SharedEngineResponse {
+	dsm_segment *segment;
+	shm_mq_handle *queue;
+	duckdb::unique_ptr<duckdb::QueryResult> result;
+	/* The error of the query in the JSON format of DuckDB, see SerializeError */
+	std::string error;
+	/* The message that could not be sent yet, because the queue was full */
+	std::string pending_message;
+	bool sent_last_message;
+};
+
+/*
+ * Errors are sent back with their type and extra info, which includes the
+ * SQLSTATE of Postgres errors. So the backend raises them the same way as
+ * the errors of queries that it executes itself.
+ */
+static std::string
+SerializeError(const duckdb::ErrorData &error) {
+	return duckdb::Exception::ToJSON(error.Type(), error.RawMessage(), error.ExtraInfo());
+}
+
+/* Executes the prepared query, and interrupts it when the backend stops waiting for its result */
+static duckdb::unique_ptr<duckdb::QueryResult>
+ExecutePrepared(SharedEngineRequest *request, duckdb::Connection &connection, duckdb::PreparedStatement &prepared,
+                duckdb::case_insensitive_map_t<duckdb::BoundParameterData> &parameters) {
+	auto pending = prepared.PendingQuery(parameters, false);
+	bool interrupted = false;
+	while (!pending->HasError()) {
+		auto execution_result = pending->ExecuteTask();
+		if (duckdb::PendingQueryResult::IsResultReady(execution_result) ||
+		    execution_result == duckdb::PendingExecutionResult::EXECUTION_ERROR) {
+			break;
+		}
+
+		if (!interrupted && pg_atomic_read_u32(&request->backend_detached)) {
+			interrupted = true;
+			connection.Interrupt();
+		}
+	}
+
+	if (pending->HasError()) {
+		return duckdb::make_uniq<duckdb::MaterializedQueryResult>(pending->GetErrorObject());
+	}
+	return pending->Execute();
+}
+
+/* Applies the settings that the backend sent with the request to the connection of the shared engine */
+static void
+ApplyRequestSettings(SharedEngineRequest *request, duckdb::Connection &connection) {
+	const char *value = RequestSettings(request);
+	const char *end = value + request->settings_size;
+	for (auto name : SHARED_ENGINE_SETTINGS) {
+		if (value >= end) {
+			throw duckdb::InternalException("The request to the DuckDB shared engine is missing the setting %s", name);
+		}
+		DuckDBQueryOrThrow(connection, std::string("SET ") + name + " = " + duckdb::KeywordHelper::WriteQuoted(value));
+		value += strlen(value) + 1;
+	}
+}
+
+/*
+ * Executes the query of a request. The result is fully materialized, so that
+ * the transaction can end right away. Sending it back happens separately,
+ * because a backend might take its time fetching it. While a query executes,
+ * the requests of other backends wait, so there's only ever one query at a
+ * time that uses the threads and memory of the shared engine.
+ */
+static void
+ExecuteRequest(SharedEngineResponse &response) {
+	auto request = (SharedEngineRequest *)dsm_segment_address(response.segment);
+	std::string query(RequestQuery(request), request->query_size);
+
+	SetCurrentStatementStartTimestamp();
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+	pgstat_report_activity(STATE_RUNNING, query.c_str());
+
+	bool failed = false;
+	try {
+		auto parameters = DeserializeParameters(RequestParameters(request), request->parameters_size);
+		auto connection = DuckDBManager::GetConnection(false);
+		/* ReleaseAllDuckdbThreads releases these at the end of the transaction */
+		AcquireDuckdbThreads();
+		RebalanceDuckdbThreads(*connection->context);
+		ApplyRequestSettings(request, *connection);
+		auto prepared = connection->context->Prepare(query);
+		if (prepared->HasError()) {
+			response.error = SerializeError(prepared->GetErrorObject());
+		} else if (!prepared->GetStatementProperties().IsReadOnly()) {
+			response.error = duckdb::Exception::ToJSON(
+			    duckdb::ExceptionType::NOT_IMPLEMENTED, "The DuckDB shared engine only executes read-only queries",
+			    {{pg::SQLERRCODE_EXTRA_INFO, std::to_string(ERRCODE_FEATURE_NOT_SUPPORTED)}});
+		} else {
+			auto result = ExecutePrepared(request, *connection, *prepared, parameters);
+			if (result->HasError()) {
+				response.error = SerializeError(result->GetErrorObject());
+			} else {
+				response.result = std::move(result);
+			}
+		}
+	} catch (std::exception &ex) {
+		response.error = SerializeError(duckdb::ErrorData(ex));
+		failed = true;
+	}
+
+	PopActiveSnapshot();
+	if (failed) {
+		AbortCurrentTransaction();
+	} else {
+		CommitTransactionCommand();
+	}
+	pgstat_report_activity(STATE_IDLE, NULL);
+}
+
+static std::string
+NextMessage(SharedEngineResponse &response) {
+	if (!response.error.empty() || !response.result) {
+		response.sent_last_message = true;
+		return SHARED_ENGINE_ERROR + response.error;
+	}
+
+	try {
+		auto chunk = response.result->Fetch();
+		if (!chunk || chunk->size() == 0) {
+			response.sent_last_message = true;
+			return std::string(1, SHARED_ENGINE_COMPLETE);
+		}
+		return SHARED_ENGINE_CHUNK + SerializeChunk(*chunk);
+	} catch (std::exception &ex) {
+		response.sent_last_message = true;
+		return SHARED_ENGINE_ERROR + SerializeError(duckdb::ErrorData(ex));
+	}
+}
+
+/* Sends as many messages of the response as fit in its queue. Returns true once it's done. */
+static bool
+SendResponse(SharedEngineResponse &response) {
+	while (true) {
+		if (response.pending_message.empty()) {
+			if (response.sent_last_message) {
+				return true;
+			}
+			response.pending_message = NextMessage(response);
+		}
+
+		auto &message = response.pending_message;
+#if PG_VERSION_NUM >= 150000
+		shm_mq_result result = shm_mq_send(response.queue, message.size(), message.data(), true, true);
+#else
+		shm_mq_result result = shm_mq_send(response.queue, message.size(), message.data(), true);
+#endif
+		if (result == SHM_MQ_WOULD_BLOCK) {
+			return false;
+		}
+		if (result == SHM_MQ_DETACHED) {
+			/* The backend is not interested in the rest of the result anymore */
+			return true;
+		}
+		message.clear();
+	}
+}
+
+/* Takes the requests that backends submitted, and executes them one by one */
+static void
+TakeRequests(std::vector<duckdb::unique_ptr<SharedEngineResponse>> &responses) {
+	for (int i = 0; i < SharedEngine->num_requests; i++) {
+		SpinLockAcquire(&SharedEngine->lock);
+		dsm_handle handle = SharedEngine->requests[i];
+		SharedEngine->requests[i] = DSM_HANDLE_INVALID;
+		SpinLockRelease(&SharedEngine->lock);
+		if (handle == DSM_HANDLE_INVALID) {
+			continue;
+		}
+
+		/* Attached outside of any transaction, so that it stays attached until the whole response is sent */
+		MemoryContext old_context = MemoryContextSwitchTo(TopMemoryContext);
+		dsm_segment *segment = dsm_attach(handle);
+		if (!segment) {
+			/* The backend gave up on the query already */
+			MemoryContextSwitchTo(old_context);
+			continue;
+		}
+
+		auto request = (SharedEngineRequest *)dsm_segment_address(segment);
+		shm_mq *queue = RequestQueue(request);
+		shm_mq_set_sender(queue, MyProc);
+		auto response = duckdb::make_uniq<SharedEngineResponse>();
+		response->segment = segment;
+		response->queue = shm_mq_attach(queue, segment, NULL);
+		response->sent_last_message = false;
+		MemoryContextSwitchTo(old_context);
+
+		ExecuteRequest(*response);
+		responses.push_back(std::move(response));
+	}
+}
+
+static void
+ClearSharedEngineState(int /*code*/, Datum /*arg*/) {
+	SpinLockAcquire(&SharedEngine->lock);
+	SharedEngine->worker_pid = 0;
+	SharedEngine->worker_latch = NULL;
+	SharedEngine->database_id = InvalidOid;
+	SpinLockRelease(&SharedEngine->lock);
+}
+
+static void
+SharedEngineMainLoop() {
+	std::vector<duckdb::unique_ptr<SharedEngineResponse>> responses;
+
+	while (true) {
+		ResetLatch(MyLatch);
+		CHECK_FOR_INTERRUPTS();
+
+		if (ConfigReloadPending) {
+			ConfigReloadPending = false;
+			ProcessConfigFile(PGC_SIGHUP);
+		}
+
+		TakeRequests(responses);
+
+		for (auto it = responses.begin(); it != responses.end();) {
+			if (SendResponse(**it)) {
+				dsm_detach((*it)->segment);
+				it = responses.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		/* Backends set our latch when they submit a query, or read from a full queue */
+		(void)WaitLatch(MyLatch, WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH, 1000L, SharedEngineWaitEvent());
+	}
+}
+
+} // namespace pgduckdb
+
+extern "C" {
+
+PGDLLEXPORT void pgduckdb_shared_engine_main(Datum main_arg);
+
+PGDLLEXPORT void
+pgduckdb_shared_engine_main(Datum /*main_arg*/) {
+	pqsignal(SIGTERM, die);
+	pqsignal(SIGHUP, SignalHandlerForConfigReload);
+	BackgroundWorkerUnblockSignals();
+
+	BackgroundWorkerInitializeConnection(pgduckdb::duckdb_shared_engine_database, NULL, 0);
+	pgduckdb::is_shared_engine = true;
+
+	SpinLockAcquire(&pgduckdb::SharedEngine->lock);
+	pgduckdb::SharedEngine->worker_pid = MyProcPid;
+	pgduckdb::SharedEngine->worker_latch = MyLatch;
+	pgduckdb::SharedEngine->database_id = MyDatabaseId;
+	SpinLockRelease(&pgduckdb::SharedEngine->lock);
+	before_shmem_exit(pgduckdb::ClearSharedEngineState, 0);
+
+	elog(LOG, "%s: started for database '%s'", PGDUCKDB_SHARED_ENGINE_NAME,
+	     pgduckdb::duckdb_shared_engine_database);
+	InvokeCPPFunc(pgduckdb::SharedEngineMainLoop);
+}
+
+} // extern "C"
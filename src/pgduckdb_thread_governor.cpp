@@ -0,0 +1,389 @@
+#include "duckdb.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+
+#include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+extern "C" {
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "postmaster/autovacuum.h"
+#include "replication/walsender.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+}
+
+namespace pgduckdb {
+
+typedef struct DuckdbThreadShare {
+	pid_t pid;            /* 0 if the slot is not used by any backend */
+	int priority;         /* duckdb.thread_priority of the backend while it runs queries, 0 if it doesn't */
+	int threads;          /* the DuckDB threads of the backend, including the backend itself */
+	int postgres_workers; /* the Postgres parallel workers that the scans of the backend use */
+} DuckdbThreadShare;
+
+/*
+ * duckdb.max_threads_global is shared by all backends that run DuckDB
+ * queries, in proportion to their duckdb.thread_priority. Both the threads of
+ * a DuckDB instance and the Postgres parallel workers that scan tables for it
+ * count towards the share of a backend. Whenever a backend starts or finishes
+ * running queries, the generation is bumped. The other backends notice that
+ * in between DuckDB tasks and resize their thread pool to their new share.
+ *
+ * The shares are indexed by the number of the PGPROC of the backend.
+ */
+typedef struct ThreadGovernorShmemStruct {
+	slock_t lock; /* protects all the fields below, except for generation */
+
+	int64 total_priority;
+	pg_atomic_uint32 generation;
+	int num_shares;
+	DuckdbThreadShare shares[1]; /* actually num_shares long */
+} ThreadGovernorShmemStruct;
+
+static ThreadGovernorShmemStruct *ThreadGovernor;
+
+/* The number of queries of this backend that hold on to their threads */
+static int active_queries = 0;
+static int registered_priority = 0;
+static uint32 applied_generation = 0;
+static int applied_postgres_workers = -1;
+static bool set_up_release_share_hook = false;
+
+/*
+ * The share of this backend, and the Postgres workers its scans use. The
+ * scans are started by DuckDB threads, which is why these are atomics.
+ */
+static std::atomic<int> my_share(0);
+static std::atomic<int> my_postgres_workers(0);
+
+static int
+NumShares() {
+#if PG_VERSION_NUM >= 150000
+	return MaxBackends;
+#else
+	/* See NumReservations in pgduckdb_memory_governor.cpp */
+	return MaxConnections + autovacuum_max_workers + 1 + max_worker_processes + max_wal_senders;
+#endif
+}
+
+static int
+MyShareIndex() {
+#if PG_VERSION_NUM >= 170000
+	return MyProcNumber;
+#else
+	return MyProc->pgprocno;
+#endif
+}
+
+static Size
+ThreadGovernorShmemSize() {
+	return add_size(offsetof(ThreadGovernorShmemStruct, shares), mul_size(NumShares(), sizeof(DuckdbThreadShare)));
+}
+
+static void
+InitThreadGovernorStruct() {
+	MemSet(ThreadGovernor, 0, ThreadGovernorShmemSize());
+	SpinLockInit(&ThreadGovernor->lock);
+	pg_atomic_init_u32(&ThreadGovernor->generation, 0);
+	ThreadGovernor->num_shares = NumShares();
+}
+
+#if PG_VERSION_NUM >= 190000
+
+static void
+ThreadGovernorShmemRequest(void * /*opaque_arg*/) {
+	ShmemStructOpts struct_opts = {
+	    .name = "DuckdbThreadGovernor Data",
+	    .size = ThreadGovernorShmemSize(),
+	    .ptr = (void **)&ThreadGovernor,
+	};
+	ShmemRequestStructWithOpts(&struct_opts);
+}
+
+static void
+ThreadGovernorShmemInit(void * /*opaque_arg*/) {
+	InitThreadGovernorStruct();
+}
+
+#else
+
+#if PG_VERSION_NUM >= 150000
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static void
+ThreadGovernorShmemRequest(void) {
+#if PG_VERSION_NUM >= 150000
+	if (prev_shmem_request_hook)
+		prev_shmem_request_hook();
+#endif
+
+	RequestAddinShmemSpace(ThreadGovernorShmemSize());
+}
+
+static void
+ThreadGovernorShmemStartup(void) {
+	if (prev_shmem_startup_hook) {
+		prev_shmem_startup_hook();
+	}
+
+	bool found;
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	ThreadGovernor =
+	    (ThreadGovernorShmemStruct *)ShmemInitStruct("DuckdbThreadGovernor Data", ThreadGovernorShmemSize(), &found);
+	if (!found) {
+		InitThreadGovernorStruct();
+	}
+	LWLockRelease(AddinShmemInitLock);
+}
+
+#endif
+
+void
+InitThreadGovernorShmem(void) {
+#if PG_VERSION_NUM >= 190000
+	/* See InitBackgroundWorkersShmem on why this is static */
+	static const ShmemCallbacks callbacks = {
+	    .request_fn = ThreadGovernorShmemRequest,
+	    .init_fn = ThreadGovernorShmemInit,
+	};
+	RegisterShmemCallbacks(&callbacks);
+#else
+#if PG_VERSION_NUM >= 150000
+	prev_shmem_request_hook = shmem_request_hook;
+	shmem_request_hook = ThreadGovernorShmemRequest;
+#else
+	ThreadGovernorShmemRequest();
+#endif
+	prev_shmem_startup_hook = shmem_startup_hook;
+	shmem_startup_hook = ThreadGovernorShmemStartup;
+#endif
+}
+
+static bool
+IsThreadGovernorEnabled() {
+	return duckdb_max_threads_global > 0 && ThreadGovernor != NULL;
+}
+
+/* Must be called with the lock held */
+static void
+UnregisterPriority(DuckdbThreadShare *share) {
+	ThreadGovernor->total_priority -= registered_priority;
+	registered_priority = 0;
+	share->priority = 0;
+	share->threads = 0;
+	share->postgres_workers = 0;
+	pg_atomic_fetch_add_u32(&ThreadGovernor->generation, 1);
+}
+
+static void
+ReleaseShare(int /*code*/, Datum /*arg*/) {
+	auto &share = ThreadGovernor->shares[MyShareIndex()];
+	SpinLockAcquire(&ThreadGovernor->lock);
+	UnregisterPriority(&share);
+	share.pid = 0;
+	SpinLockRelease(&ThreadGovernor->lock);
+}
+
+/* Returns the share of this backend, or NULL if its threads are not governed */
+static DuckdbThreadShare *
+MyThreadShare() {
+	if (!IsThreadGovernorEnabled() || MyProc == NULL) {
+		return NULL;
+	}
+
+	int index = MyShareIndex();
+	if (index < 0 || index >= ThreadGovernor->num_shares) {
+		return NULL;
+	}
+
+	if (!set_up_release_share_hook) {
+		before_shmem_exit(ReleaseShare, 0);
+		set_up_release_share_hook = true;
+	}
+	return &ThreadGovernor->shares[index];
+}
+
+void
+AcquireDuckdbThreads(void) {
+	if (active_queries++ > 0) {
+		return;
+	}
+
+	auto share = MyThreadShare();
+	if (!share) {
+		return;
+	}
+
+	SpinLockAcquire(&ThreadGovernor->lock);
+	registered_priority = duckdb_thread_priority;
+	ThreadGovernor->total_priority += registered_priority;
+	share->pid = MyProcPid;
+	share->priority = registered_priority;
+	pg_atomic_fetch_add_u32(&ThreadGovernor->generation, 1);
+	SpinLockRelease(&ThreadGovernor->lock);
+
+	/* Make sure the next rebalance applies the share, even if no other backend changed anything */
+	applied_postgres_workers = -1;
+}
+
+void
+RebalanceDuckdbThreads(duckdb::ClientContext &context) {
+	if (active_queries == 0 || registered_priority == 0) {
+		return;
+	}
+
+	int postgres_workers = my_postgres_workers.load();
+	if (pg_atomic_read_u32(&ThreadGovernor->generation) == applied_generation &&
+	    postgres_workers == applied_postgres_workers) {
+		return;
+	}
+
+	auto &config = duckdb::DBConfig::GetConfig(context);
+	int64 max_threads = std::max<int64>(config.options.maximum_threads, 1);
+	auto share = MyThreadShare();
+
+	SpinLockAcquire(&ThreadGovernor->lock);
+	applied_generation = pg_atomic_read_u32(&ThreadGovernor->generation);
+	int64 fair_share = (int64)duckdb_max_threads_global * registered_priority / ThreadGovernor->total_priority;
+	/* Every query gets at least one thread, and never more than duckdb.threads */
+	int tokens = (int)std::max<int64>(std::min<int64>(fair_share, max_threads + postgres_workers), 1);
+	int threads = std::max(tokens - postgres_workers, 1);
+	share->threads = threads;
+	share->postgres_workers = postgres_workers;
+	SpinLockRelease(&ThreadGovernor->lock);
+
+	applied_postgres_workers = postgres_workers;
+	my_share.store(tokens);
+
+	auto &scheduler = duckdb::TaskScheduler::GetScheduler(context);
+	if ((int)scheduler.NumberOfThreads() == threads) {
+		return;
+	}
+
+	elog(DEBUG2, "[PGDuckDB] Resizing the DuckDB thread pool to %d of duckdb.max_threads_global", threads);
+	scheduler.SetThreads(threads, config.options.external_threads);
+	scheduler.RelaunchThreads();
+}
+
+void
+ReleaseDuckdbThreads(void) {
+	if (active_queries == 0 || --active_queries > 0) {
+		return;
+	}
+
+	my_share.store(0);
+	if (registered_priority == 0) {
+		return;
+	}
+
+	auto share = MyThreadShare();
+	SpinLockAcquire(&ThreadGovernor->lock);
+	UnregisterPriority(share);
+	SpinLockRelease(&ThreadGovernor->lock);
+}
+
+void
+ReleaseAllDuckdbThreads(void) {
+	if (active_queries > 0) {
+		active_queries = 1;
+		ReleaseDuckdbThreads();
+	}
+	my_postgres_workers.store(0);
+}
+
+int
+ReservePostgresScanWorkers(int wanted) {
+	int share = my_share.load();
+	if (share == 0) {
+		/* The query doesn't hold any threads, so there's no share to take the workers from */
+		my_postgres_workers.fetch_add(wanted);
+		return wanted;
+	}
+
+	/* One token always stays with the DuckDB thread that runs the query */
+	int current = my_postgres_workers.load();
+	int granted;
+	do {
+		granted = std::max(std::min(wanted, share - 1 - current), 0);
+	} while (!my_postgres_workers.compare_exchange_weak(current, current + granted));
+	return granted;
+}
+
+void
+ReleasePostgresScanWorkers(int count) {
+	int current = my_postgres_workers.load();
+	while (!my_postgres_workers.compare_exchange_weak(current, std::max(current - count, 0))) {
+	}
+}
+
+} // namespace pgduckdb
+
+extern "C" {
+
+DECLARE_PG_FUNCTION(duckdb_thread_usage) {
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL()) {
+		funcctx = SRF_FIRSTCALL_INIT();
+		MemoryContext old_context = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		TupleDesc tupdesc;
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE) {
+			elog(ERROR, "return type must be a row type");
+		}
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* Copy all shares at once, so that they add up to the total */
+		auto governor = pgduckdb::ThreadGovernor;
+		int num_shares = governor ? governor->num_shares : 0;
+		auto shares = (pgduckdb::DuckdbThreadShare *)palloc(Max(num_shares, 1) * sizeof(pgduckdb::DuckdbThreadShare));
+		int num_used = 0;
+		if (governor) {
+			SpinLockAcquire(&governor->lock);
+			for (int i = 0; i < num_shares; i++) {
+				if (governor->shares[i].pid != 0) {
+					shares[num_used++] = governor->shares[i];
+				}
+			}
+			SpinLockRelease(&governor->lock);
+		}
+
+		funcctx->user_fctx = shares;
+		funcctx->max_calls = num_used;
+		MemoryContextSwitchTo(old_context);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	if (funcctx->call_cntr < funcctx->max_calls) {
+		auto shares = (pgduckdb::DuckdbThreadShare *)funcctx->user_fctx;
+		auto &share = shares[funcctx->call_cntr];
+
+		Datum values[4];
+		bool nulls[4] = {false, false, false, false};
+		values[0] = Int32GetDatum(share.pid);
+		values[1] = Int32GetDatum(share.priority);
+		values[2] = Int32GetDatum(share.threads);
+		values[3] = Int32GetDatum(share.postgres_workers);
+		HeapTuple tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+} // extern "C"
@@ -12,6 +12,7 @@
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
 #include "pgduckdb/scan/postgres_scan.hpp"
 #include "pgduckdb/pg/memory.hpp"
+#include "pgduckdb/pg/relations.hpp"
 #include "pgduckdb/pg/types.hpp"
 
 extern "C" {
@@ -21,7 +22,9 @@ extern "C" {
 #include "postgres.h"
 #include "fmgr.h"
 #include "miscadmin.h"
+#include "access/htup_details.h"
 #include "access/tupdesc_details.h"
+#include "access/tupmacs.h"
 #include "catalog/pg_type.h"
 #include "common/int.h"
 #include "executor/tuptable.h"
@@ -202,16 +205,23 @@ ValidTimestampOrTimestampTz(int64_t timestamp) {
 	return timestamp >= pgduckdb::PGDUCKDB_MIN_TIMESTAMP_VALUE && timestamp < pgduckdb::PGDUCKDB_MAX_TIMESTAMP_VALUE;
 }
 
+static Datum
+StringToVarlenaDatum(const char *data, size_t len) {
+	struct varlena *result = (struct varlena *)palloc(len + VARHDRSZ);
+	SET_VARSIZE(result, len + VARHDRSZ);
+	memcpy(VARDATA(result), data, len);
+	return PointerGetDatum(result);
+}
+
+static Datum
+StringToVarlenaDatum(duckdb::string_t str) {
+	return StringToVarlenaDatum(str.GetData(), str.GetSize());
+}
+
 static Datum
 ConvertToStringDatum(const duckdb::Value &value) {
 	auto str = value.ToString();
-	auto varchar = str.c_str();
-	auto varchar_len = str.size();
-
-	text *result = (text *)palloc0(varchar_len + VARHDRSZ);
-	SET_VARSIZE(result, varchar_len + VARHDRSZ);
-	memcpy(VARDATA(result), varchar, varchar_len);
-	return PointerGetDatum(result);
+	return StringToVarlenaDatum(str.c_str(), str.size());
 }
 
 static inline Datum
@@ -250,18 +260,11 @@ ConvertInt8Datum(const duckdb::Value &value) {
 
 static Datum
 ConvertBinaryDatum(const duckdb::Value &value) {
-	auto str = value.GetValueUnsafe<duckdb::string_t>();
-	auto blob_len = str.GetSize();
-	auto blob = str.GetDataUnsafe();
-	bytea *result = (bytea *)palloc0(blob_len + VARHDRSZ);
-	SET_VARSIZE(result, blob_len + VARHDRSZ);
-	memcpy(VARDATA(result), blob, blob_len);
-	return PointerGetDatum(result);
+	return StringToVarlenaDatum(value.GetValueUnsafe<duckdb::string_t>());
 }
 
-inline Datum
-ConvertDateDatum(const duckdb::Value &value) {
-	duckdb::date_t date = value.GetValue<duckdb::date_t>();
+static Datum
+DateToDatum(duckdb::date_t date) {
 	if (!ValidDate(date))
 		throw duckdb::OutOfRangeException("The value should be between min and max value (%s <-> %s)",
 		                                  duckdb::Date::ToString(pgduckdb::PGDUCKDB_PG_MIN_DATE_VALUE),
@@ -277,9 +280,13 @@ ConvertDateDatum(const duckdb::Value &value) {
 	return DateADTGetDatum(date.days - pgduckdb::PGDUCKDB_DUCK_DATE_OFFSET);
 }
 
+inline Datum
+ConvertDateDatum(const duckdb::Value &value) {
+	return DateToDatum(value.GetValue<duckdb::date_t>());
+}
+
 static Datum
-ConvertIntervalDatum(const duckdb::Value &value) {
-	duckdb::interval_t duckdb_interval = value.GetValue<duckdb::interval_t>();
+IntervalToDatum(duckdb::interval_t duckdb_interval) {
 	Interval *pg_interval = static_cast<Interval *>(palloc(sizeof(Interval)));
 	pg_interval->month = duckdb_interval.months;
 	pg_interval->day = duckdb_interval.days;
@@ -287,6 +294,17 @@ ConvertIntervalDatum(const duckdb::Value &value) {
 	return IntervalPGetDatum(pg_interval);
 }
 
+static Datum
+ConvertIntervalDatum(const duckdb::Value &value) {
+	return IntervalToDatum(value.GetValue<duckdb::interval_t>());
+}
+
+static Datum
+TimeToDatum(duckdb::dtime_t time) {
+	const TimeADT pg_time = time.micros;
+	return TimeADTGetDatum(pg_time);
+}
+
 static Datum
 ConvertTimeDatum(const duckdb::Value &value) {
 	const int64_t microsec = value.GetValue<int64_t>();
@@ -308,6 +326,31 @@ ConvertTimeTzDatum(const duckdb::Value &value) {
 	return TimeTzADTPGetDatum(result);
 }
 
+/* Converts a timestamp in microseconds that is not +/-infinity */
+static Datum
+TimestampMicrosToDatum(int64_t rawValue) {
+	if (!ValidTimestampOrTimestampTz(rawValue))
+		throw duckdb::OutOfRangeException(
+		    "The Timestamp value should be between min and max value (%s <-> %s)",
+		    duckdb::Timestamp::ToString(static_cast<duckdb::timestamp_t>(PGDUCKDB_MIN_TIMESTAMP_VALUE)),
+		    duckdb::Timestamp::ToString(static_cast<duckdb::timestamp_t>(PGDUCKDB_MAX_TIMESTAMP_VALUE)));
+
+	return TimestampGetDatum(rawValue - pgduckdb::PGDUCKDB_DUCK_TIMESTAMP_OFFSET);
+}
+
+static Datum
+TimestampToDatum(duckdb::timestamp_t timestamp) {
+	int64_t rawValue = timestamp.value;
+
+	// Early Return for +/-Inf
+	if (rawValue == static_cast<int64_t>(duckdb::timestamp_t::ninfinity()))
+		return TimestampGetDatum(DT_NOBEGIN);
+	else if (rawValue == static_cast<int64_t>(duckdb::timestamp_t::infinity()))
+		return TimestampGetDatum(DT_NOEND);
+
+	return TimestampMicrosToDatum(rawValue);
+}
+
 inline Datum
 ConvertTimestampDatum(const duckdb::Value &value) {
 	// Extract raw int64_t value of timestamp
@@ -338,18 +381,11 @@ ConvertTimestampDatum(const duckdb::Value &value) {
 		break;
 	}
 
-	if (!ValidTimestampOrTimestampTz(rawValue))
-		throw duckdb::OutOfRangeException(
-		    "The Timestamp value should be between min and max value (%s <-> %s)",
-		    duckdb::Timestamp::ToString(static_cast<duckdb::timestamp_t>(PGDUCKDB_MIN_TIMESTAMP_VALUE)),
-		    duckdb::Timestamp::ToString(static_cast<duckdb::timestamp_t>(PGDUCKDB_MAX_TIMESTAMP_VALUE)));
-
-	return TimestampGetDatum(rawValue - pgduckdb::PGDUCKDB_DUCK_TIMESTAMP_OFFSET);
+	return TimestampMicrosToDatum(rawValue);
 }
 
-inline Datum
-ConvertTimestampTzDatum(const duckdb::Value &value) {
-	duckdb::timestamp_tz_t timestamp = value.GetValue<duckdb::timestamp_tz_t>();
+static Datum
+TimestampTzToDatum(duckdb::timestamp_tz_t timestamp) {
 	int64_t rawValue = timestamp.value;
 
 	// Early Return for +/-Inf
@@ -367,6 +403,11 @@ ConvertTimestampTzDatum(const duckdb::Value &value) {
 	return TimestampTzGetDatum(rawValue - pgduckdb::PGDUCKDB_DUCK_TIMESTAMP_OFFSET);
 }
 
+inline Datum
+ConvertTimestampTzDatum(const duckdb::Value &value) {
+	return TimestampTzToDatum(value.GetValue<duckdb::timestamp_tz_t>());
+}
+
 inline Datum
 ConvertFloatDatum(const duckdb::Value &value) {
 	return Float4GetDatum(value.GetValue<float>());
@@ -498,10 +539,7 @@ ConvertNumericDatum(const duckdb::Value &value) {
 }
 
 static Datum
-ConvertUUIDDatum(const duckdb::Value &value) {
-	D_ASSERT(value.type().id() == duckdb::LogicalTypeId::UUID);
-	D_ASSERT(value.type().InternalType() == duckdb::PhysicalType::INT128);
-	auto duckdb_uuid = value.GetValue<hugeint_t>();
+UUIDToDatum(hugeint_t duckdb_uuid) {
 	pg_uuid_t *postgres_uuid = (pg_uuid_t *)palloc(sizeof(pg_uuid_t));
 
 	duckdb_uuid.upper ^= (uint64_t(1) << 63);
@@ -515,6 +553,13 @@ ConvertUUIDDatum(const duckdb::Value &value) {
 	return UUIDPGetDatum(postgres_uuid);
 }
 
+static Datum
+ConvertUUIDDatum(const duckdb::Value &value) {
+	D_ASSERT(value.type().id() == duckdb::LogicalTypeId::UUID);
+	D_ASSERT(value.type().InternalType() == duckdb::PhysicalType::INT128);
+	return UUIDToDatum(value.GetValue<hugeint_t>());
+}
+
 inline Datum
 ConvertDuckStructDatum(const duckdb::Value &value) {
 	D_ASSERT(value.type().id() == duckdb::LogicalTypeId::STRUCT);
@@ -1274,6 +1319,161 @@ ConvertDuckToPostgresValue(TupleTableSlot *slot, duckdb::Value &value, idx_t col
 	return true;
 }
 
+template <class T, class CONVERT>
+static void
+ConvertDuckToPostgresColumnValues(duckdb::Vector &vector, idx_t count, Datum *values, bool *nulls, CONVERT convert) {
+	duckdb::UnifiedVectorFormat format;
+	vector.ToUnifiedFormat(count, format);
+	auto data = duckdb::UnifiedVectorFormat::GetData<T>(format);
+
+	for (idx_t row = 0; row < count; row++) {
+		auto idx = format.sel->get_index(row);
+		if (!format.validity.RowIsValid(idx)) {
+			values[row] = (Datum)0;
+			nulls[row] = true;
+			continue;
+		}
+
+		values[row] = convert(data[idx]);
+		nulls[row] = false;
+	}
+}
+
+/*
+ * Converts the first count values of a DuckDB vector to Datums of the given
+ * Postgres type. Only the common type combinations are handled here, for any
+ * other combination this returns false without converting anything, and the
+ * values need to be converted one by one with ConvertDuckToPostgresValue.
+ */
+bool
+ConvertDuckToPostgresColumn(duckdb::Vector &vector, idx_t count, Oid oid, Datum *values, bool *nulls) {
+	auto type_id = vector.GetType().id();
+
+	switch (oid) {
+	case BOOLOID:
+		if (type_id != duckdb::LogicalTypeId::BOOLEAN) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<bool>(vector, count, values, nulls,
+		                                        [](bool value) { return BoolGetDatum(value); });
+		return true;
+	case INT2OID:
+		switch (type_id) {
+		case duckdb::LogicalTypeId::TINYINT:
+			ConvertDuckToPostgresColumnValues<int8_t>(vector, count, values, nulls,
+			                                          [](int8_t value) { return Int16GetDatum(value); });
+			return true;
+		case duckdb::LogicalTypeId::UTINYINT:
+			ConvertDuckToPostgresColumnValues<uint8_t>(vector, count, values, nulls,
+			                                           [](uint8_t value) { return Int16GetDatum(value); });
+			return true;
+		case duckdb::LogicalTypeId::SMALLINT:
+			ConvertDuckToPostgresColumnValues<int16_t>(vector, count, values, nulls,
+			                                           [](int16_t value) { return Int16GetDatum(value); });
+			return true;
+		default:
+			return false;
+		}
+	case INT4OID:
+		switch (type_id) {
+		case duckdb::LogicalTypeId::USMALLINT:
+			ConvertDuckToPostgresColumnValues<uint16_t>(vector, count, values, nulls,
+			                                            [](uint16_t value) { return Int32GetDatum(value); });
+			return true;
+		case duckdb::LogicalTypeId::INTEGER:
+			ConvertDuckToPostgresColumnValues<int32_t>(vector, count, values, nulls,
+			                                           [](int32_t value) { return Int32GetDatum(value); });
+			return true;
+		default:
+			return false;
+		}
+	case INT8OID:
+		switch (type_id) {
+		case duckdb::LogicalTypeId::UINTEGER:
+			ConvertDuckToPostgresColumnValues<uint32_t>(vector, count, values, nulls,
+			                                            [](uint32_t value) { return Int64GetDatum(value); });
+			return true;
+		case duckdb::LogicalTypeId::BIGINT:
+			ConvertDuckToPostgresColumnValues<int64_t>(vector, count, values, nulls,
+			                                           [](int64_t value) { return Int64GetDatum(value); });
+			return true;
+		default:
+			return false;
+		}
+	case FLOAT4OID:
+		if (type_id != duckdb::LogicalTypeId::FLOAT) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<float>(vector, count, values, nulls,
+		                                         [](float value) { return Float4GetDatum(value); });
+		return true;
+	case FLOAT8OID:
+		if (type_id != duckdb::LogicalTypeId::DOUBLE) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<double>(vector, count, values, nulls,
+		                                          [](double value) { return Float8GetDatum(value); });
+		return true;
+	case BPCHAROID:
+	case TEXTOID:
+	case JSONOID:
+	case VARCHAROID:
+		/* ENUM and GEOMETRY values need to be formatted as strings first */
+		if (type_id != duckdb::LogicalTypeId::VARCHAR) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::string_t>(
+		    vector, count, values, nulls, [](duckdb::string_t value) { return StringToVarlenaDatum(value); });
+		return true;
+	case BYTEAOID:
+		if (type_id != duckdb::LogicalTypeId::BLOB) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::string_t>(
+		    vector, count, values, nulls, [](duckdb::string_t value) { return StringToVarlenaDatum(value); });
+		return true;
+	case DATEOID:
+		if (type_id != duckdb::LogicalTypeId::DATE) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::date_t>(vector, count, values, nulls, DateToDatum);
+		return true;
+	case TIMESTAMPOID:
+		/* Timestamps with other units than microseconds take the slow path */
+		if (type_id != duckdb::LogicalTypeId::TIMESTAMP) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::timestamp_t>(vector, count, values, nulls, TimestampToDatum);
+		return true;
+	case TIMESTAMPTZOID:
+		if (type_id != duckdb::LogicalTypeId::TIMESTAMP_TZ) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::timestamp_tz_t>(vector, count, values, nulls, TimestampTzToDatum);
+		return true;
+	case INTERVALOID:
+		if (type_id != duckdb::LogicalTypeId::INTERVAL) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::interval_t>(vector, count, values, nulls, IntervalToDatum);
+		return true;
+	case TIMEOID:
+		if (type_id != duckdb::LogicalTypeId::TIME) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<duckdb::dtime_t>(vector, count, values, nulls, TimeToDatum);
+		return true;
+	case UUIDOID:
+		if (type_id != duckdb::LogicalTypeId::UUID) {
+			return false;
+		}
+		ConvertDuckToPostgresColumnValues<hugeint_t>(vector, count, values, nulls, UUIDToDatum);
+		return true;
+	default:
+		return false;
+	}
+}
+
 static inline int32
 make_numeric_typmod(int precision, int scale) {
 	return ((precision << 16) | (scale & 0x7ff)) + VARHDRSZ;
@@ -1651,18 +1851,33 @@ Append(duckdb::Vector &result, T value, idx_t offset) {
 	data[offset] = value;
 }
 
+template <bool IS_BPCHAR>
 static void
-AppendString(duckdb::Vector &result, Datum value, idx_t offset, bool is_bpchar) {
+AppendString(duckdb::Vector &result, Datum value, idx_t offset) {
 	void *ptr = DatumGetPointer(value);
 	const char *text = VARDATA_ANY(ptr);
 	/* Remove the padding of a BPCHAR type. DuckDB expects unpadded value. */
-	auto len = is_bpchar ? bpchartruelen(VARDATA_ANY(ptr), VARSIZE_ANY_EXHDR(ptr)) : VARSIZE_ANY_EXHDR(ptr);
+	auto len = IS_BPCHAR ? bpchartruelen(VARDATA_ANY(ptr), VARSIZE_ANY_EXHDR(ptr)) : VARSIZE_ANY_EXHDR(ptr);
 	duckdb::string_t str(text, len);
 
 	auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
 	data[offset] = duckdb::StringVector::AddString(result, str);
 }
 
+/*
+ * Same as AppendString, but the string is not copied into the string heap of
+ * the vector. This is only safe if the value outlives the vector.
+ */
+template <bool IS_BPCHAR>
+static void
+AppendStringNoCopy(duckdb::Vector &result, Datum value, idx_t offset) {
+	void *ptr = DatumGetPointer(value);
+	auto len = IS_BPCHAR ? bpchartruelen(VARDATA_ANY(ptr), VARSIZE_ANY_EXHDR(ptr)) : VARSIZE_ANY_EXHDR(ptr);
+
+	auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+	data[offset] = duckdb::string_t(VARDATA_ANY(ptr), len);
+}
+
 static void
 AppendJsonb(duckdb::Vector &result, Datum value, idx_t offset) {
 	auto jsonb = DatumGetJsonbP(value);
@@ -1851,194 +2066,339 @@ ConvertPostgresParameterToDuckValue(Datum value, Oid postgres_type) {
 	}
 }
 
-void
-ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &result, idx_t offset) {
-	auto &type = result.GetType();
+/*
+ * Converters for a single non-NULL Datum into a DuckDB vector. Which one to use
+ * only depends on the Postgres and DuckDB types of a column, so it's resolved
+ * once by GetPostgresToDuckConverter instead of switching on the types for
+ * every value.
+ */
+static void
+AppendBool(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<bool>(result, DatumGetBool(value), offset);
+}
+
+static void
+AppendInt16(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<int16_t>(result, DatumGetInt16(value), offset);
+}
+
+static void
+AppendInt32(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<int32_t>(result, DatumGetInt32(value), offset);
+}
+
+static void
+AppendUInt32(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<uint32_t>(result, DatumGetUInt32(value), offset);
+}
+
+static void
+AppendInt64(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<int64_t>(result, DatumGetInt64(value), offset);
+}
+
+static void
+AppendFloat4(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<float>(result, DatumGetFloat4(value), offset);
+}
+
+static void
+AppendFloat8(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<double>(result, DatumGetFloat8(value), offset);
+}
+
+static void
+AppendInterval(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<duckdb::interval_t>(result, DatumGetInterval(value), offset);
+}
+
+static void
+AppendBit(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<duckdb::bitstring_t>(result, duckdb::Bit::ToBit(DatumGetBitString(value)), offset);
+}
+
+static void
+AppendTime(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<duckdb::dtime_t>(result, DatumGetTime(value), offset);
+}
+
+static void
+AppendTimeTz(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<duckdb::dtime_tz_t>(result, DatumGetTimeTz(value), offset);
+}
+
+/* This NUMERIC could not be converted to a DECIMAL, convert it as DOUBLE instead */
+static void
+AppendNumericAsDouble(duckdb::Vector &result, Datum value, idx_t offset) {
+	auto numeric = DatumGetNumeric(value);
+	auto numeric_var = FromNumeric(numeric);
+	Append<double>(result, ConvertDecimal<double, DecimalConversionDouble>(numeric_var), offset);
+}
+
+template <class T, class OP = DecimalConversionInteger>
+static void
+AppendDecimal(duckdb::Vector &result, Datum value, idx_t offset) {
+	auto numeric = DatumGetNumeric(value);
+	auto numeric_var = FromNumeric(numeric);
+	Append<T>(result, ConvertDecimal<T, OP>(numeric_var), offset);
+}
+
+static void
+AppendUUID(duckdb::Vector &result, Datum value, idx_t offset) {
+	Append<hugeint_t>(result, DatumGetUUID(value), offset);
+}
+
+static void
+AppendBlob(duckdb::Vector &result, Datum value, idx_t offset) {
+	void *ptr = DatumGetPointer(value);
+	const char *bytea_data = VARDATA_ANY(ptr);
+	size_t bytea_length = VARSIZE_ANY_EXHDR(ptr);
+	const duckdb::string_t s(bytea_data, bytea_length);
+	auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+	data[offset] = duckdb::StringVector::AddStringOrBlob(result, s);
+}
+
+static void
+AppendBlobNoCopy(duckdb::Vector &result, Datum value, idx_t offset) {
+	void *ptr = DatumGetPointer(value);
+	auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+	data[offset] = duckdb::string_t(VARDATA_ANY(ptr), VARSIZE_ANY_EXHDR(ptr));
+}
+
+static PostgresToDuckConverter GetPostgresToDuckConverter(Oid attr_type, const duckdb::LogicalType &type);
+
+static void
+AppendList(duckdb::Vector &result, Datum value, idx_t offset) {
+	// Convert Datum to ArrayType
+	auto array = DatumGetArrayTypeP(value);
+
+	auto ndims = ARR_NDIM(array);
+	int *dims = ARR_DIMS(array);
+	auto elem_type = ARR_ELEMTYPE(array);
+
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+	PostgresFunctionGuard(get_typlenbyvalalign, elem_type, &typlen, &typbyval, &typalign);
+
+	int nelems;
+	Datum *elems;
+	bool *nulls;
+	// Deconstruct the array into Datum elements
+	PostgresFunctionGuard(deconstruct_array, array, elem_type, typlen, typbyval, typalign, &elems, &nulls, &nelems);
+
+	if (ndims == -1) {
+		throw duckdb::InternalException("Array type has an ndims of -1, so it's actually not an array??");
+	}
+	// Set the list_entry_t metadata
+	duckdb::Vector *vec = &result;
+	int write_offset = offset;
+	for (int dim = 0; dim < ndims; dim++) {
+		auto previous_dimension = dim ? dims[dim - 1] : 1;
+		auto dimension = dims[dim];
+		if (vec->GetType().id() != duckdb::LogicalTypeId::LIST) {
+			throw duckdb::InvalidInputException(
+			    "Dimensionality of the schema and the data does not match, data contains more dimensions than the "
+			    "amount of dimensions specified by the schema");
+		}
+		auto child_offset = duckdb::ListVector::GetListSize(*vec);
+		auto list_data = duckdb::FlatVector::GetData<duckdb::list_entry_t>(*vec);
+		for (int entry = 0; entry < previous_dimension; entry++) {
+			list_data[write_offset + entry] = duckdb::list_entry_t(
+			    // All lists in a postgres row are enforced to have the same dimension
+			    // [[1,2],[2,3,4]] is not allowed, second list has 3 elements instead of 2
+			    child_offset + (dimension * entry), dimension);
+		}
+		auto new_child_size = child_offset + (dimension * previous_dimension);
+		duckdb::ListVector::Reserve(*vec, new_child_size);
+		duckdb::ListVector::SetListSize(*vec, new_child_size);
+		write_offset = child_offset;
+		auto &child = duckdb::ListVector::GetEntry(*vec);
+		vec = &child;
+	}
+	if (ndims == 0) {
+		D_ASSERT(nelems == 0);
+		auto child_offset = duckdb::ListVector::GetListSize(*vec);
+		auto list_data = duckdb::FlatVector::GetData<duckdb::list_entry_t>(*vec);
+		list_data[write_offset] = duckdb::list_entry_t(child_offset, 0);
+		vec = &duckdb::ListVector::GetEntry(*vec);
+	} else if (vec->GetType().id() == duckdb::LogicalTypeId::LIST) {
+		throw duckdb::InvalidInputException(
+		    "Dimensionality of the schema and the data does not match, data contains fewer dimensions than the "
+		    "amount of dimensions specified by the schema");
+	}
+
+	auto convert_element = GetPostgresToDuckConverter(elem_type, vec->GetType());
+	for (int i = 0; i < nelems; i++) {
+		idx_t dest_idx = write_offset + i;
+		if (nulls[i]) {
+			auto &array_mask = duckdb::FlatVector::Validity(*vec);
+			array_mask.SetInvalid(dest_idx);
+			continue;
+		}
+		convert_element(*vec, elems[i], dest_idx);
+	}
+}
+
+static void
+AppendUnsupported(duckdb::Vector &result, Datum, idx_t) {
+	throw duckdb::NotImplementedException("(DuckDB/ConvertPostgresToDuckValue) Unsupported pgduckdb type: %s",
+	                                      result.GetType().ToString().c_str());
+}
+
+static PostgresToDuckConverter
+GetPostgresToDuckConverter(Oid attr_type, const duckdb::LogicalType &type) {
 	switch (type.id()) {
 	case duckdb::LogicalTypeId::BOOLEAN:
-		Append<bool>(result, DatumGetBool(value), offset);
-		break;
-	case duckdb::LogicalTypeId::TINYINT: {
-		Append<int16_t>(result, DatumGetInt16(value), offset);
-		break;
-	}
+		return AppendBool;
+	case duckdb::LogicalTypeId::TINYINT:
 	case duckdb::LogicalTypeId::SMALLINT:
-		Append<int16_t>(result, DatumGetInt16(value), offset);
-		break;
+		return AppendInt16;
 	case duckdb::LogicalTypeId::INTEGER:
-		Append<int32_t>(result, DatumGetInt32(value), offset);
-		break;
+		return AppendInt32;
 	case duckdb::LogicalTypeId::UINTEGER:
-		Append<uint32_t>(result, DatumGetUInt32(value), offset);
-		break;
+		return AppendUInt32;
 	case duckdb::LogicalTypeId::BIGINT:
-		Append<int64_t>(result, DatumGetInt64(value), offset);
-		break;
-	case duckdb::LogicalTypeId::VARCHAR: {
+		return AppendInt64;
+	case duckdb::LogicalTypeId::VARCHAR:
 		// NOTE: This also handles JSON
 		if (attr_type == JSONBOID) {
-			AppendJsonb(result, value, offset);
-			break;
-		} else {
-			AppendString(result, value, offset, attr_type == BPCHAROID);
+			return AppendJsonb;
+		} else if (attr_type == BPCHAROID) {
+			return AppendString<true>;
 		}
-		break;
-	}
+		return AppendString<false>;
 	case duckdb::LogicalTypeId::DATE:
-		AppendDate(result, value, offset);
-		break;
-
+		return AppendDate;
 	case duckdb::LogicalTypeId::TIMESTAMP_SEC:
 	case duckdb::LogicalTypeId::TIMESTAMP_MS:
 	case duckdb::LogicalTypeId::TIMESTAMP_NS:
 	case duckdb::LogicalTypeId::TIMESTAMP:
-		AppendTimestamp(result, value, offset);
-		break;
+		return AppendTimestamp;
 	case duckdb::LogicalTypeId::TIMESTAMP_TZ:
-		AppendTimestampTz(result, value, offset); // Timestamp and Timestamptz are basically same in PG
-		break;
+		return AppendTimestampTz; // Timestamp and Timestamptz are basically same in PG
 	case duckdb::LogicalTypeId::INTERVAL:
-		Append<duckdb::interval_t>(result, DatumGetInterval(value), offset);
-		break;
+		return AppendInterval;
 	case duckdb::LogicalTypeId::BIT:
-		Append<duckdb::bitstring_t>(result, duckdb::Bit::ToBit(DatumGetBitString(value)), offset);
-		break;
+		return AppendBit;
 	case duckdb::LogicalTypeId::TIME:
-		Append<duckdb::dtime_t>(result, DatumGetTime(value), offset);
-		break;
+		return AppendTime;
 	case duckdb::LogicalTypeId::TIME_TZ:
-		Append<duckdb::dtime_tz_t>(result, DatumGetTimeTz(value), offset);
-		break;
+		return AppendTimeTz;
 	case duckdb::LogicalTypeId::FLOAT:
-		Append<float>(result, DatumGetFloat4(value), offset);
-		break;
+		return AppendFloat4;
 	case duckdb::LogicalTypeId::DOUBLE: {
 		auto aux_info = type.GetAuxInfoShrPtr();
 		if (aux_info && dynamic_cast<NumericAsDouble *>(aux_info.get())) {
-			// This NUMERIC could not be converted to a DECIMAL, convert it as DOUBLE instead
-			auto numeric = DatumGetNumeric(value);
-			auto numeric_var = FromNumeric(numeric);
-			auto double_val = ConvertDecimal<double, DecimalConversionDouble>(numeric_var);
-			Append<double>(result, double_val, offset);
-		} else {
-			Append<double>(result, DatumGetFloat8(value), offset);
+			return AppendNumericAsDouble;
 		}
-		break;
+		return AppendFloat8;
 	}
 	case duckdb::LogicalTypeId::DECIMAL: {
 		auto physical_type = type.InternalType();
-		auto numeric = DatumGetNumeric(value);
-		auto numeric_var = FromNumeric(numeric);
 		switch (physical_type) {
-		case duckdb::PhysicalType::INT16: {
-			Append(result, ConvertDecimal<int16_t>(numeric_var), offset);
-			break;
-		}
-		case duckdb::PhysicalType::INT32: {
-			Append(result, ConvertDecimal<int32_t>(numeric_var), offset);
-			break;
-		}
-		case duckdb::PhysicalType::INT64: {
-			Append(result, ConvertDecimal<int64_t>(numeric_var), offset);
-			break;
-		}
-		case duckdb::PhysicalType::INT128: {
-			Append(result, ConvertDecimal<hugeint_t, DecimalConversionHugeint>(numeric_var), offset);
-			break;
-		}
+		case duckdb::PhysicalType::INT16:
+			return AppendDecimal<int16_t>;
+		case duckdb::PhysicalType::INT32:
+			return AppendDecimal<int32_t>;
+		case duckdb::PhysicalType::INT64:
+			return AppendDecimal<int64_t>;
+		case duckdb::PhysicalType::INT128:
+			return AppendDecimal<hugeint_t, DecimalConversionHugeint>;
 		default:
 			throw duckdb::InternalException("Unrecognized physical type (%s) for DECIMAL value",
 			                                duckdb::EnumUtil::ToString(physical_type));
 		}
-		break;
 	}
-	case duckdb::LogicalTypeId::UUID: {
-		Append(result, DatumGetUUID(value), offset);
-		break;
+	case duckdb::LogicalTypeId::UUID:
+		return AppendUUID;
+	case duckdb::LogicalTypeId::BLOB:
+		return AppendBlob;
+	case duckdb::LogicalTypeId::LIST:
+		return AppendList;
+	default:
+		// Only fail once we actually encounter a value, a column that is NULL everywhere can still be scanned.
+		return AppendUnsupported;
 	}
-	case duckdb::LogicalTypeId::BLOB: {
-		void *ptr = DatumGetPointer(value);
-		const char *bytea_data = VARDATA_ANY(ptr);
-		size_t bytea_length = VARSIZE_ANY_EXHDR(ptr);
-		const duckdb::string_t s(bytea_data, bytea_length);
-		auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
-		data[offset] = duckdb::StringVector::AddStringOrBlob(result, s);
-		break;
+}
+
+void
+ConvertPostgresToDuckValue(Oid attr_type, Datum value, duckdb::Vector &result, idx_t offset) {
+	GetPostgresToDuckConverter(attr_type, result.GetType())(result, value, offset);
+}
+
+/*
+ * Returns true if the given type can be converted from a Postgres datum to a DuckDB value
+ * without requiring any Postgres-specific functions or memory allocations (such as palloc).
+ */
+static bool
+IsThreadSafeTypeForPostgresToDuckDB(Oid attr_type, duckdb::LogicalTypeId duckdb_type) {
+	if (duckdb_type == duckdb::LogicalTypeId::VARCHAR) {
+		return attr_type != JSONBOID;
+	}
+	if (duckdb_type == duckdb::LogicalTypeId::LIST || duckdb_type == duckdb::LogicalTypeId::BIT) {
+		return false;
 	}
-	case duckdb::LogicalTypeId::LIST: {
-		// Convert Datum to ArrayType
-		auto array = DatumGetArrayTypeP(value);
 
-		auto ndims = ARR_NDIM(array);
-		int *dims = ARR_DIMS(array);
-		auto elem_type = ARR_ELEMTYPE(array);
+	return true;
+}
 
-		int16 typlen;
-		bool typbyval;
-		char typalign;
-		PostgresFunctionGuard(get_typlenbyvalalign, elem_type, &typlen, &typbyval, &typalign);
+PostgresColumnConverter
+GetPostgresColumnConverter(Form_pg_attribute attr, const duckdb::LogicalType &type) {
+	PostgresColumnConverter converter;
+	converter.convert = GetPostgresToDuckConverter(attr->atttypid, type);
+	converter.convert_no_copy = nullptr;
+	converter.is_varlena = attr->attlen == -1;
+	if (converter.is_varlena && type.id() == duckdb::LogicalTypeId::VARCHAR && attr->atttypid == BPCHAROID) {
+		converter.convert_no_copy = AppendStringNoCopy<true>;
+	} else if (converter.is_varlena && type.id() == duckdb::LogicalTypeId::VARCHAR && attr->atttypid != JSONBOID) {
+		converter.convert_no_copy = AppendStringNoCopy<false>;
+	} else if (converter.is_varlena && type.id() == duckdb::LogicalTypeId::BLOB) {
+		converter.convert_no_copy = AppendBlobNoCopy;
+	}
+	converter.is_thread_safe = IsThreadSafeTypeForPostgresToDuckDB(attr->atttypid, type.id());
+	return converter;
+}
 
-		int nelems;
-		Datum *elems;
-		bool *nulls;
-		// Deconstruct the array into Datum elements
-		PostgresFunctionGuard(deconstruct_array, array, elem_type, typlen, typbyval, typalign, &elems, &nulls, &nelems);
+/*
+ * Converts a non-NULL attribute value to DuckDB, detoasting it first when it
+ * is a varlena.
+ *
+ * Strings are not copied into the vector when they don't have to be: a
+ * detoasted string is handed over to the string buffer of the scan, and if
+ * borrow_tuple_data is true the tuple itself outlives the output vector, so
+ * strings stored inline in it are referenced in place.
+ */
+static inline void
+ConvertAttributeToDuckValue(const PostgresColumnConverter &converter, Datum value, duckdb::Vector &result,
+                            idx_t offset, PostgresScanStringBuffer &string_buffer, bool borrow_tuple_data) {
+	if (!converter.is_varlena) {
+		converter.convert(result, value, offset);
+		return;
+	}
 
-		if (ndims == -1) {
-			throw duckdb::InternalException("Array type has an ndims of -1, so it's actually not an array??");
-		}
-		// Set the list_entry_t metadata
-		duckdb::Vector *vec = &result;
-		int write_offset = offset;
-		for (int dim = 0; dim < ndims; dim++) {
-			auto previous_dimension = dim ? dims[dim - 1] : 1;
-			auto dimension = dims[dim];
-			if (vec->GetType().id() != duckdb::LogicalTypeId::LIST) {
-				throw duckdb::InvalidInputException(
-				    "Dimensionality of the schema and the data does not match, data contains more dimensions than the "
-				    "amount of dimensions specified by the schema");
-			}
-			auto child_offset = duckdb::ListVector::GetListSize(*vec);
-			auto list_data = duckdb::FlatVector::GetData<duckdb::list_entry_t>(*vec);
-			for (int entry = 0; entry < previous_dimension; entry++) {
-				list_data[write_offset + entry] = duckdb::list_entry_t(
-				    // All lists in a postgres row are enforced to have the same dimension
-				    // [[1,2],[2,3,4]] is not allowed, second list has 3 elements instead of 2
-				    child_offset + (dimension * entry), dimension);
-			}
-			auto new_child_size = child_offset + (dimension * previous_dimension);
-			duckdb::ListVector::Reserve(*vec, new_child_size);
-			duckdb::ListVector::SetListSize(*vec, new_child_size);
-			write_offset = child_offset;
-			auto &child = duckdb::ListVector::GetEntry(*vec);
-			vec = &child;
-		}
-		if (ndims == 0) {
-			D_ASSERT(nelems == 0);
-			auto child_offset = duckdb::ListVector::GetListSize(*vec);
-			auto list_data = duckdb::FlatVector::GetData<duckdb::list_entry_t>(*vec);
-			list_data[write_offset] = duckdb::list_entry_t(child_offset, 0);
-			vec = &duckdb::ListVector::GetEntry(*vec);
-		} else if (vec->GetType().id() == duckdb::LogicalTypeId::LIST) {
-			throw duckdb::InvalidInputException(
-			    "Dimensionality of the schema and the data does not match, data contains fewer dimensions than the "
-			    "amount of dimensions specified by the schema");
+	auto attr = reinterpret_cast<varlena *>(value);
+	if (converter.convert_no_copy && !VARATT_IS_EXTERNAL(attr) && !VARATT_IS_COMPRESSED(attr)) {
+		/* Strings are read using VARDATA_ANY, so they don't need detoasting if they only have a short header */
+		if (borrow_tuple_data) {
+			converter.convert_no_copy(result, value, offset);
+		} else {
+			converter.convert(result, value, offset);
 		}
+		return;
+	}
 
-		for (int i = 0; i < nelems; i++) {
-			idx_t dest_idx = write_offset + i;
-			if (nulls[i]) {
-				auto &array_mask = duckdb::FlatVector::Validity(*vec);
-				array_mask.SetInvalid(dest_idx);
-				continue;
-			}
-			ConvertPostgresToDuckValue(elem_type, elems[i], *vec, dest_idx);
-		}
-		break;
+	bool should_free = false;
+	Datum detoasted_value = DetoastPostgresDatum(attr, &should_free);
+	if (should_free && converter.convert_no_copy) {
+		string_buffer.AddDetoastedValue(reinterpret_cast<void *>(detoasted_value));
+		converter.convert_no_copy(result, detoasted_value, offset);
+		return;
 	}
-	default:
-		throw duckdb::NotImplementedException("(DuckDB/ConvertPostgresToDuckValue) Unsupported pgduckdb type: %s",
-		                                      result.GetType().ToString().c_str());
+
+	converter.convert(result, detoasted_value, offset);
+	if (should_free) {
+		duckdb_free(reinterpret_cast<void *>(detoasted_value));
 	}
 }
 
@@ -2060,20 +2420,9 @@ InsertTupleIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_loc
 			auto &array_mask = duckdb::FlatVector::Validity(result);
 			array_mask.SetInvalid(scan_local_state.output_vector_size);
 		} else {
-			auto attr = TupleDescAttr(slot->tts_tupleDescriptor, duckdb_output_index);
-			if (attr->attlen == -1) {
-				bool should_free = false;
-				Datum detoasted_value = DetoastPostgresDatum(
-				    reinterpret_cast<varlena *>(slot->tts_values[duckdb_output_index]), &should_free);
-				ConvertPostgresToDuckValue(attr->atttypid, detoasted_value, result,
-				                           scan_local_state.output_vector_size);
-				if (should_free) {
-					duckdb_free(reinterpret_cast<void *>(detoasted_value));
-				}
-			} else {
-				ConvertPostgresToDuckValue(attr->atttypid, slot->tts_values[duckdb_output_index], result,
-				                           scan_local_state.output_vector_size);
-			}
+			ConvertAttributeToDuckValue(scan_global_state->column_converters[duckdb_output_index],
+			                            slot->tts_values[duckdb_output_index], result,
+			                            scan_local_state.output_vector_size, *scan_local_state.string_buffer, false);
 		}
 	}
 
@@ -2081,22 +2430,6 @@ InsertTupleIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_loc
 	scan_global_state->total_row_count++;
 }
 
-/*
- * Returns true if the given type can be converted from a Postgres datum to a DuckDB value
- * without requiring any Postgres-specific functions or memory allocations (such as palloc).
- */
-static bool
-IsThreadSafeTypeForPostgresToDuckDB(Oid attr_type, duckdb::LogicalTypeId duckdb_type) {
-	if (duckdb_type == duckdb::LogicalTypeId::VARCHAR) {
-		return attr_type != JSONBOID;
-	}
-	if (duckdb_type == duckdb::LogicalTypeId::LIST || duckdb_type == duckdb::LogicalTypeId::BIT) {
-		return false;
-	}
-
-	return true;
-}
-
 /*
  * Insert batch of tuples into chunk. This function is thread-safe and is meant for multi-threaded scans.
  *
@@ -2115,13 +2448,14 @@ InsertTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_lo
 
 	for (int duckdb_output_index = 0; duckdb_output_index < natts; duckdb_output_index++) {
 		auto &result = output.data[duckdb_output_index];
-		auto attr = TupleDescAttr(slots[0]->tts_tupleDescriptor, duckdb_output_index);
-		bool is_safe_type = IsThreadSafeTypeForPostgresToDuckDB(attr->atttypid, result.GetType().id());
+		auto &converter = scan_global_state->column_converters[duckdb_output_index];
+		bool is_safe_type = converter.is_thread_safe;
 
-		std::unique_ptr<std::lock_guard<std::recursive_mutex>> lock_guard;
+		std::unique_ptr<std::lock_guard<pgduckdb::ProcessLock>> lock_guard;
 		MemoryContext old_ctx = NULL;
 		if (!is_safe_type) {
-			lock_guard = std::make_unique<std::lock_guard<std::recursive_mutex>>(GlobalProcessLock::GetLock());
+			lock_guard = std::make_unique<std::lock_guard<pgduckdb::ProcessLock>>(GlobalProcessLock::GetLock());
+			CheckPostgresScansNotAborted();
 			old_ctx = pg::MemoryContextSwitchTo(scan_global_state->duckdb_scan_memory_ctx);
 		}
 
@@ -2130,19 +2464,9 @@ InsertTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_lo
 				auto &array_mask = duckdb::FlatVector::Validity(result);
 				array_mask.SetInvalid(scan_local_state.output_vector_size + row);
 			} else {
-				if (attr->attlen == -1) {
-					bool should_free = false;
-					Datum detoasted_value = DetoastPostgresDatum(
-					    reinterpret_cast<varlena *>(slots[row]->tts_values[duckdb_output_index]), &should_free);
-					ConvertPostgresToDuckValue(attr->atttypid, detoasted_value, result,
-					                           scan_local_state.output_vector_size + row);
-					if (should_free) {
-						duckdb_free(reinterpret_cast<void *>(detoasted_value));
-					}
-				} else {
-					ConvertPostgresToDuckValue(attr->atttypid, slots[row]->tts_values[duckdb_output_index], result,
-					                           scan_local_state.output_vector_size + row);
-				}
+				ConvertAttributeToDuckValue(converter, slots[row]->tts_values[duckdb_output_index], result,
+				                            scan_local_state.output_vector_size + row, *scan_local_state.string_buffer,
+				                            false);
 			}
 		}
 
@@ -2157,6 +2481,155 @@ InsertTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_lo
 	scan_global_state->total_row_count += num_slots;
 }
 
+/*
+ * Computes the offset of every attribute in a tuple of the given descriptor,
+ * for as long as that offset does not depend on the data of the tuple. This
+ * is the same information that Postgres caches in attcacheoff while deforming,
+ * but computing it upfront means we don't depend on a slot having deformed a
+ * tuple first. Attributes that follow a variable-width one get -1.
+ */
+duckdb::vector<int32_t>
+ComputeAttrCacheOffsets(TupleDesc tupdesc) {
+	duckdb::vector<int32_t> offsets(tupdesc->natts, -1);
+	uint32_t off = 0;
+	for (int i = 0; i < tupdesc->natts; i++) {
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		if (attr->attlen == -1) {
+			/* A varlena can have a short unaligned header, so only use the offset if no padding is needed */
+			if (off == att_align_nominal(off, attr->attalign)) {
+				offsets[i] = static_cast<int32_t>(off);
+			}
+			break;
+		} else if (attr->attlen < 0) {
+			break;
+		}
+
+		off = static_cast<uint32_t>(att_align_nominal(off, attr->attalign));
+		offsets[i] = static_cast<int32_t>(off);
+		off += attr->attlen;
+	}
+	return offsets;
+}
+
+namespace {
+
+/* Deforming state of a single tuple, the same as the locals of slot_deform_heap_tuple */
+struct MinimalTupleCursor {
+	const char *data;
+	const bits8 *null_bitmap;
+	uint32_t offset;
+	/* Can we still use the cached offsets? */
+	bool slow;
+};
+
+} // namespace
+
+/*
+ * Insert a batch of minimal tuples into the chunk. This is the column-at-a-time
+ * counterpart of InsertTuplesIntoChunk: instead of deforming each tuple into
+ * the tts_values/tts_isnull arrays of a slot and then converting those, we walk
+ * all tuples of the batch once per column and write the converted values
+ * directly into the output vector. The fixed-width prefix of the tuples is
+ * read using the precomputed attr_cache_offsets.
+ *
+ * Like InsertTuplesIntoChunk this function is thread-safe and meant for
+ * multi-threaded scans.
+ */
+void
+InsertMinimalTuplesIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state,
+                             MinimalTuple *tuples, int num_tuples) {
+	if (num_tuples == 0) {
+		return;
+	}
+
+	auto scan_global_state = scan_local_state.global_state;
+	TupleDesc tupdesc = scan_local_state.slots[0]->tts_tupleDescriptor;
+	int natts = tupdesc->natts;
+	D_ASSERT(!scan_global_state->count_tuples_only);
+	D_ASSERT(num_tuples <= LOCAL_STATE_SLOT_BATCH_SIZE);
+	D_ASSERT(scan_global_state->attr_cache_offsets.size() == static_cast<size_t>(natts));
+
+	MinimalTupleCursor cursors[LOCAL_STATE_SLOT_BATCH_SIZE];
+	for (int row = 0; row < num_tuples; row++) {
+		auto header = reinterpret_cast<HeapTupleHeader>(reinterpret_cast<char *>(tuples[row]) - MINIMAL_TUPLE_OFFSET);
+		if (HeapTupleHeaderGetNatts(header) < natts) {
+			/*
+			 * Trailing attributes that are missing from the tuple need to be
+			 * filled in by slot_getmissingattrs, so let the slot do the work
+			 * for this batch.
+			 */
+			for (int i = 0; i < num_tuples; i++) {
+				scan_local_state.slots[i] = ExecStoreMinimalTupleUnsafe(tuples[i], scan_local_state.slots[i], false);
+				SlotGetAllAttrs(scan_local_state.slots[i]);
+			}
+			InsertTuplesIntoChunk(output, scan_local_state, scan_local_state.slots, num_tuples);
+			return;
+		}
+
+		cursors[row].data = reinterpret_cast<const char *>(header) + header->t_hoff;
+		cursors[row].null_bitmap = (header->t_infomask & HEAP_HASNULL) ? header->t_bits : nullptr;
+		cursors[row].offset = 0;
+		cursors[row].slow = false;
+	}
+
+	for (int duckdb_output_index = 0; duckdb_output_index < natts; duckdb_output_index++) {
+		auto &result = output.data[duckdb_output_index];
+		auto &array_mask = duckdb::FlatVector::Validity(result);
+		auto attr = TupleDescAttr(tupdesc, duckdb_output_index);
+		auto &converter = scan_global_state->column_converters[duckdb_output_index];
+		int32_t cached_offset = scan_global_state->attr_cache_offsets[duckdb_output_index];
+		bool is_safe_type = converter.is_thread_safe;
+
+		std::unique_ptr<std::lock_guard<pgduckdb::ProcessLock>> lock_guard;
+		MemoryContext old_ctx = NULL;
+		if (!is_safe_type) {
+			lock_guard = std::make_unique<std::lock_guard<pgduckdb::ProcessLock>>(GlobalProcessLock::GetLock());
+			CheckPostgresScansNotAborted();
+			old_ctx = pg::MemoryContextSwitchTo(scan_global_state->duckdb_scan_memory_ctx);
+		}
+
+		for (int row = 0; row < num_tuples; row++) {
+			auto &cursor = cursors[row];
+			if (cursor.null_bitmap && att_isnull(duckdb_output_index, cursor.null_bitmap)) {
+				array_mask.SetInvalid(scan_local_state.output_vector_size + row);
+				cursor.slow = true;
+				continue;
+			}
+
+			/* Same offset logic as slot_deform_heap_tuple */
+			if (!cursor.slow && cached_offset >= 0) {
+				cursor.offset = cached_offset;
+			} else if (attr->attlen == -1) {
+				if (cursor.slow || cursor.offset != att_align_nominal(cursor.offset, attr->attalign)) {
+					cursor.offset = static_cast<uint32_t>(
+					    att_align_pointer(cursor.offset, attr->attalign, -1, cursor.data + cursor.offset));
+					cursor.slow = true;
+				}
+			} else {
+				cursor.offset = static_cast<uint32_t>(att_align_nominal(cursor.offset, attr->attalign));
+			}
+
+			const char *attr_ptr = cursor.data + cursor.offset;
+			Datum value = fetchatt(attr, attr_ptr);
+			cursor.offset = static_cast<uint32_t>(att_addlength_pointer(cursor.offset, attr->attlen, attr_ptr));
+			if (attr->attlen <= 0) {
+				cursor.slow = true;
+			}
+
+			ConvertAttributeToDuckValue(converter, value, result, scan_local_state.output_vector_size + row,
+			                            *scan_local_state.string_buffer, true);
+		}
+
+		if (!is_safe_type) {
+			pg::MemoryContextSwitchTo(old_ctx);
+			pg::MemoryContextReset(scan_global_state->duckdb_scan_memory_ctx);
+		}
+	}
+
+	scan_local_state.output_vector_size += num_tuples;
+	scan_global_state->total_row_count += num_tuples;
+}
+
 NumericVar
 FromNumeric(Numeric num) {
 	NumericVar dest;
@@ -14,6 +14,7 @@ extern "C" {
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
 #include "pgduckdb/pgduckdb_userdata_cache.hpp"
 #include "pgduckdb/pgduckdb_fdw.hpp"
+#include "pgduckdb/pgduckdb_guc.hpp"
 #include "pgduckdb/utility/cpp_wrapper.hpp"
 
 namespace pgduckdb {
@@ -110,7 +111,21 @@ InitUserDataCache() {
 bool
 IsMotherDuckEnabled() {
 	InitUserDataCache();
-	return cache.motherduck_foreign_server_oid != InvalidOid && cache.motherduck_user_mapping_oid != InvalidOid;
+	bool motherduck_configured =
+	    cache.motherduck_foreign_server_oid != InvalidOid && cache.motherduck_user_mapping_oid != InvalidOid;
+
+	/* Local storage takes the place of MotherDuck for tables using the duckdb access method */
+	if (duckdb_local_storage) {
+		static bool warned = false;
+		if (motherduck_configured && !warned) {
+			warned = true;
+			ereport(WARNING, (errmsg("MotherDuck is not used, because duckdb.local_storage is enabled"),
+			                  errhint("Disable duckdb.local_storage or drop the MotherDuck server.")));
+		}
+		return false;
+	}
+
+	return motherduck_configured;
 }
 
 Oid
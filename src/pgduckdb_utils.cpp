@@ -6,6 +6,7 @@ namespace pgduckdb {
 
 duckdb::unique_ptr<duckdb::QueryResult>
 DuckDBQueryOrThrow(duckdb::ClientContext &context, const std::string &query) {
+	MaterializeStreamingDuckdbScans();
 	auto res = context.Query(query, false);
 	if (res->HasError()) {
 		res->ThrowError();
@@ -1,9 +1,13 @@
 #include "duckdb/common/exception.hpp"
+#include "pgduckdb/pgduckdb_admission.hpp"
 #include "pgduckdb/pgduckdb_ddl.hpp"
 #include "pgduckdb/pgduckdb_duckdb.hpp"
 #include "pgduckdb/pgduckdb_guc.hpp"
 #include "pgduckdb/pgduckdb_xact.hpp"
 #include "pgduckdb/pgduckdb_hooks.hpp"
+#include "pgduckdb/pgduckdb_local_storage.hpp"
+#include "pgduckdb/pgduckdb_memory_governor.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
 #include "pgduckdb/pgduckdb_utils.hpp"
 #include "pgduckdb/pgduckdb_background_worker.hpp"
 
@@ -243,13 +247,17 @@ DuckdbXactCallback_Cpp(XactEvent event) {
 		}
 
 		if (context.transaction.HasActiveTransaction()) {
-			// Commit the DuckDB transaction too
+			// Commit the DuckDB transaction too, which writes the WAL next to
+			// the DuckDB database file of duckdb.local_storage
+			LocalStorageFileAccess file_access;
 			context.transaction.Commit();
 		}
+		DetachLocalStorage(context);
 		break;
 
 	case XACT_EVENT_ABORT:
 	case XACT_EVENT_PARALLEL_ABORT:
+		AbortStreamingDuckdbScans();
 		next_expected_command_id = FirstCommandId;
 		pg::force_allow_writes = false;
 		if (modified_temporary_duckdb_tables) {
@@ -263,6 +271,10 @@ DuckdbXactCallback_Cpp(XactEvent event) {
 			// Abort the DuckDB transaction too
 			context.transaction.Rollback(nullptr);
 		}
+		DetachLocalStorage(context);
+		ReleaseAllDuckdbThreads();
+		ReleaseAllDuckdbQueryAdmissions();
+		ReleaseDuckdbMemory(*DuckDBManager::Get().GetDatabase().instance);
 		break;
 
 	case XACT_EVENT_PREPARE:
@@ -271,6 +283,9 @@ DuckdbXactCallback_Cpp(XactEvent event) {
 			// Throw an error for prepare events. We don't support COMMIT PREPARED.
 			throw duckdb::NotImplementedException("Prepared transactions are not implemented in DuckDB.");
 		}
+		if (IsLocalStorageAttached()) {
+			throw duckdb::NotImplementedException("Prepared transactions cannot use tables in DuckDB local storage.");
+		}
 
 	case XACT_EVENT_COMMIT:
 	case XACT_EVENT_PARALLEL_COMMIT:
@@ -282,6 +297,9 @@ DuckdbXactCallback_Cpp(XactEvent event) {
 		// > Note that if an error is raised here, it's too late to abort
 		// > the transaction. This should be just noncritical resource
 		// > releasing.
+		ReleaseAllDuckdbThreads();
+		ReleaseAllDuckdbQueryAdmissions();
+		ReleaseDuckdbMemory(*DuckDBManager::Get().GetDatabase().instance);
 		break;
 
 	default:
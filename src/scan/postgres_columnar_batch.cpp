@@ -0,0 +1,531 @@
+#include "duckdb.hpp"
+
+#include "pgduckdb/scan/postgres_columnar_batch.hpp"
+#include "pgduckdb/scan/postgres_scan.hpp"
+#include "pgduckdb/pgduckdb_detoast.hpp"
+#include "pgduckdb/pgduckdb_types.hpp"
+#include "pgduckdb/pgduckdb_utils.hpp"
+#include "pgduckdb/pg/memory.hpp"
+
+extern "C" {
+#include "postgres.h"
+#include "fmgr.h"
+#include "access/htup_details.h"
+#include "access/tupdesc.h"
+#include "catalog/pg_type.h"
+#include "executor/execdesc.h"
+#include "executor/tuptable.h"
+#include "nodes/params.h"
+#include "tcop/dest.h"
+#include "utils/memutils.h"
+}
+
+#include "pgduckdb/utility/cpp_wrapper.hpp"
+
+namespace pgduckdb {
+
+/*
+ * The leader asks the parallel workers of a scan to send columnar batches
+ * through the parameter list of the scan query, which ExecInitParallelPlan
+ * serializes into the DSM segment of the parallel query. Scan queries don't
+ * reference any parameters, so a parameter list that consists of a single
+ * int8 with this value can only come from MakeColumnarWorkerTransportParams.
+ */
+#define COLUMNAR_WORKER_TRANSPORT_REQUEST INT64CONST(0x7067647563626174)
+
+/*
+ * A columnar batch holds up to STANDARD_VECTOR_SIZE rows that a parallel
+ * worker already converted to the DuckDB vector layout. It's sent as a single
+ * message over the regular tuple queue of the worker, behind a MinimalTuple
+ * header that has zero attributes. So any code that would still read the
+ * message as a tuple sees an empty tuple, instead of interpreting the batch as
+ * attribute data. The batch itself starts at BATCH_DATA_OFFSET and looks like
+ * this:
+ *
+ *   ColumnarBatchHeader, which starts with COLUMNAR_BATCH_MAGIC
+ *   for every column:
+ *     ColumnarBatchColumnHeader
+ *     validity mask, only if the column contains NULLs
+ *     the values for fixed-width columns, or for string columns the length of
+ *     every string followed by the bytes of all strings
+ *
+ * Every part starts at a MAXALIGN'ed offset.
+ */
+#define BATCH_DATA_OFFSET MAXALIGN(SizeofMinimalTupleHeader)
+
+/*
+ * A batch is sent before it has STANDARD_VECTOR_SIZE rows if its strings get
+ * this large, so that wide rows don't end up in messages that are too large
+ * for the tuple queue.
+ */
+#define MAX_BATCH_STRING_BYTES (64 * 1024 * 1024)
+
+#define COLUMNAR_BATCH_MAGIC 0x50474342 /* "PGCB" */
+
+struct ColumnarBatchHeader {
+	uint32_t magic;
+	uint32_t row_count;
+	uint32_t column_count;
+};
+
+struct ColumnarBatchColumnHeader {
+	uint32_t has_nulls;
+	/* Total size of the strings in a string column, 0 for fixed-width columns */
+	uint32_t string_bytes;
+};
+
+static inline Size
+ValidityMaskSize(idx_t row_count) {
+	return ((row_count + 63) / 64) * sizeof(duckdb::validity_t);
+}
+
+static inline bool
+IsStringColumn(const duckdb::LogicalType &type) {
+	return type.InternalType() == duckdb::PhysicalType::VARCHAR;
+}
+
+bool
+SupportsColumnarWorkerTransport(const duckdb::vector<duckdb::LogicalType> &types) {
+	for (auto &type : types) {
+		switch (type.id()) {
+		case duckdb::LogicalTypeId::BOOLEAN:
+		case duckdb::LogicalTypeId::SMALLINT:
+		case duckdb::LogicalTypeId::INTEGER:
+		case duckdb::LogicalTypeId::UINTEGER:
+		case duckdb::LogicalTypeId::BIGINT:
+		case duckdb::LogicalTypeId::FLOAT:
+		case duckdb::LogicalTypeId::DOUBLE:
+		case duckdb::LogicalTypeId::DECIMAL:
+		case duckdb::LogicalTypeId::DATE:
+		case duckdb::LogicalTypeId::TIME:
+		case duckdb::LogicalTypeId::TIME_TZ:
+		case duckdb::LogicalTypeId::TIMESTAMP:
+		case duckdb::LogicalTypeId::TIMESTAMP_SEC:
+		case duckdb::LogicalTypeId::TIMESTAMP_MS:
+		case duckdb::LogicalTypeId::TIMESTAMP_NS:
+		case duckdb::LogicalTypeId::TIMESTAMP_TZ:
+		case duckdb::LogicalTypeId::INTERVAL:
+		case duckdb::LogicalTypeId::UUID:
+		case duckdb::LogicalTypeId::VARCHAR:
+		case duckdb::LogicalTypeId::BLOB:
+			break;
+		default:
+			/* Nested types don't have a flat layout, so those are sent as regular tuples */
+			return false;
+		}
+	}
+	return true;
+}
+
+//
+// Worker side
+//
+
+namespace {
+
+/*
+ * Converts the tuples produced by a parallel worker into a DuckDB chunk, and
+ * serializes the chunk into a columnar batch once it is full.
+ */
+class ColumnarBatchWriter {
+public:
+	ColumnarBatchWriter(TupleDesc tupdesc);
+	~ColumnarBatchWriter();
+
+	void Append(TupleTableSlot *slot);
+	bool
+	IsFull() const {
+		return chunk.size() == STANDARD_VECTOR_SIZE || string_bytes >= MAX_BATCH_STRING_BYTES;
+	}
+	MinimalTuple Serialize();
+	void Reset();
+
+private:
+	ColumnarBatchWriter(const ColumnarBatchWriter &) = delete;
+	ColumnarBatchWriter &operator=(const ColumnarBatchWriter &) = delete;
+
+	duckdb::DataChunk chunk;
+	duckdb::vector<PostgresColumnConverter> column_converters;
+	/* Total size of the strings in the current batch */
+	Size string_bytes;
+	/* Memory for the conversion and serialization of a single batch */
+	MemoryContext batch_context;
+};
+
+ColumnarBatchWriter::ColumnarBatchWriter(TupleDesc tupdesc)
+    : chunk(), column_converters(), string_bytes(0), batch_context(nullptr) {
+	duckdb::vector<duckdb::LogicalType> types;
+	for (int i = 0; i < tupdesc->natts; i++) {
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		types.push_back(ConvertPostgresToDuckColumnType(attr));
+		column_converters.push_back(GetPostgresColumnConverter(attr, types.back()));
+	}
+
+	if (!SupportsColumnarWorkerTransport(types)) {
+		throw duckdb::InternalException("(PGDuckDB/ColumnarBatchWriter) Unsupported column type in columnar batch");
+	}
+
+	chunk.Initialize(duckdb::Allocator::DefaultAllocator(), types);
+	batch_context = pg::MemoryContextCreate(CurrentMemoryContext, "DuckdbColumnarBatchContext");
+}
+
+ColumnarBatchWriter::~ColumnarBatchWriter() {
+	pg::MemoryContextDelete(batch_context);
+}
+
+void
+ColumnarBatchWriter::Append(TupleTableSlot *slot) {
+	PostgresFunctionGuard(slot_getallattrs, slot);
+
+	idx_t row = chunk.size();
+	MemoryContext old_context = pg::MemoryContextSwitchTo(batch_context);
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		auto &result = chunk.data[col];
+		if (slot->tts_isnull[col]) {
+			duckdb::FlatVector::SetNull(result, row, true);
+			continue;
+		}
+
+		auto &converter = column_converters[col];
+		Datum value = slot->tts_values[col];
+		auto attr = reinterpret_cast<varlena *>(value);
+		if (!converter.is_varlena) {
+			converter.convert(result, value, row);
+			continue;
+		}
+
+		if (converter.convert_no_copy && !VARATT_IS_EXTERNAL(attr) && !VARATT_IS_COMPRESSED(attr)) {
+			converter.convert(result, value, row);
+		} else {
+			bool should_free = false;
+			Datum detoasted_value = DetoastPostgresDatum(attr, &should_free);
+			converter.convert(result, detoasted_value, row);
+			if (should_free) {
+				duckdb_free(reinterpret_cast<void *>(detoasted_value));
+			}
+		}
+
+		if (IsStringColumn(result.GetType())) {
+			string_bytes += duckdb::FlatVector::GetData<duckdb::string_t>(result)[row].GetSize();
+		}
+	}
+	pg::MemoryContextSwitchTo(old_context);
+	chunk.SetCardinality(row + 1);
+}
+
+/*
+ * Serializes the rows collected so far into a columnar batch. The batch stays
+ * valid until the next call to Reset. Returns NULL if there are no rows.
+ */
+MinimalTuple
+ColumnarBatchWriter::Serialize() {
+	idx_t row_count = chunk.size();
+	if (row_count == 0) {
+		return NULL;
+	}
+
+	Size size = BATCH_DATA_OFFSET + MAXALIGN(sizeof(ColumnarBatchHeader));
+	duckdb::vector<ColumnarBatchColumnHeader> column_headers(chunk.ColumnCount());
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		auto &vector = chunk.data[col];
+		auto &validity = duckdb::FlatVector::Validity(vector);
+		auto &column_header = column_headers[col];
+		column_header.has_nulls = !validity.AllValid();
+		column_header.string_bytes = 0;
+
+		size += MAXALIGN(sizeof(ColumnarBatchColumnHeader));
+		if (column_header.has_nulls) {
+			size += ValidityMaskSize(row_count);
+		}
+
+		if (!IsStringColumn(vector.GetType())) {
+			size += MAXALIGN(row_count * duckdb::GetTypeIdSize(vector.GetType().InternalType()));
+			continue;
+		}
+
+		auto strings = duckdb::FlatVector::GetData<duckdb::string_t>(vector);
+		Size column_string_bytes = 0;
+		for (idx_t row = 0; row < row_count; row++) {
+			if (validity.RowIsValid(row)) {
+				column_string_bytes += strings[row].GetSize();
+			}
+		}
+		column_header.string_bytes = column_string_bytes;
+		size += MAXALIGN(row_count * sizeof(uint32_t)) + MAXALIGN(column_string_bytes);
+	}
+
+	/* Only happens for a batch with a single huge string, a regular tuple couldn't be sent either */
+	if (!AllocSizeIsValid(size)) {
+		throw duckdb::InvalidInputException("(PGDuckDB/ColumnarBatchWriter) Columnar batch of " + std::to_string(size) +
+		                                    " bytes is too large");
+	}
+
+	char *batch = static_cast<char *>(PostgresFunctionGuard(MemoryContextAllocZero, batch_context, size));
+	auto tuple_header = reinterpret_cast<MinimalTuple>(batch);
+	tuple_header->t_len = size;
+	tuple_header->t_infomask2 = 0; /* no attributes */
+	tuple_header->t_hoff = BATCH_DATA_OFFSET + MINIMAL_TUPLE_OFFSET;
+
+	char *data = batch + BATCH_DATA_OFFSET;
+	auto header = reinterpret_cast<ColumnarBatchHeader *>(data);
+	header->magic = COLUMNAR_BATCH_MAGIC;
+	header->row_count = row_count;
+	header->column_count = chunk.ColumnCount();
+	data += MAXALIGN(sizeof(ColumnarBatchHeader));
+
+	for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+		auto &vector = chunk.data[col];
+		auto &validity = duckdb::FlatVector::Validity(vector);
+		auto &column_header = column_headers[col];
+		memcpy(data, &column_header, sizeof(ColumnarBatchColumnHeader));
+		data += MAXALIGN(sizeof(ColumnarBatchColumnHeader));
+
+		if (column_header.has_nulls) {
+			memcpy(data, validity.GetData(), ValidityMaskSize(row_count));
+			data += ValidityMaskSize(row_count);
+		}
+
+		if (!IsStringColumn(vector.GetType())) {
+			Size data_size = row_count * duckdb::GetTypeIdSize(vector.GetType().InternalType());
+			memcpy(data, duckdb::FlatVector::GetData(vector), data_size);
+			data += MAXALIGN(data_size);
+			continue;
+		}
+
+		auto strings = duckdb::FlatVector::GetData<duckdb::string_t>(vector);
+		auto lengths = reinterpret_cast<uint32_t *>(data);
+		char *string_data = data + MAXALIGN(row_count * sizeof(uint32_t));
+		for (idx_t row = 0; row < row_count; row++) {
+			if (!validity.RowIsValid(row)) {
+				continue;
+			}
+			lengths[row] = strings[row].GetSize();
+			memcpy(string_data, strings[row].GetData(), lengths[row]);
+			string_data += lengths[row];
+		}
+		data += MAXALIGN(row_count * sizeof(uint32_t)) + MAXALIGN(column_header.string_bytes);
+	}
+	D_ASSERT(static_cast<Size>(data - batch) == size);
+	return reinterpret_cast<MinimalTuple>(batch);
+}
+
+void
+ColumnarBatchWriter::Reset() {
+	pg::MemoryContextReset(batch_context);
+	chunk.Reset();
+	string_bytes = 0;
+}
+
+/*
+ * DestReceiver that wraps the tuple queue receiver of a parallel worker, and
+ * sends the tuples it receives as columnar batches.
+ */
+struct ColumnarBatchReceiver {
+	DestReceiver pub;
+	DestReceiver *tuple_queue;
+	/* Slot that a serialized batch is stored in to send it over the tuple queue */
+	TupleTableSlot *batch_slot;
+	ColumnarBatchWriter *writer;
+};
+
+void
+ColumnarBatchStartup_Cpp(ColumnarBatchReceiver *receiver, TupleDesc tupdesc) {
+	receiver->writer = new ColumnarBatchWriter(tupdesc);
+}
+
+/* Returns a batch that should be sent, if the current one is full */
+MinimalTuple
+ColumnarBatchAppend_Cpp(ColumnarBatchReceiver *receiver, TupleTableSlot *slot) {
+	receiver->writer->Append(slot);
+	return receiver->writer->IsFull() ? receiver->writer->Serialize() : NULL;
+}
+
+MinimalTuple
+ColumnarBatchSerialize_Cpp(ColumnarBatchReceiver *receiver) {
+	return receiver->writer->Serialize();
+}
+
+void
+ColumnarBatchReset_Cpp(ColumnarBatchReceiver *receiver) {
+	receiver->writer->Reset();
+}
+
+void
+ColumnarBatchCleanup_Cpp(ColumnarBatchReceiver *receiver) {
+	delete receiver->writer;
+	receiver->writer = nullptr;
+}
+
+} // namespace
+
+extern "C" {
+
+/*
+ * Sends a batch over the tuple queue. This is plain C, because sending the
+ * batch can throw a Postgres error.
+ */
+static bool
+ColumnarBatchSend(ColumnarBatchReceiver *receiver, MinimalTuple batch) {
+	ExecStoreMinimalTuple(batch, receiver->batch_slot, false);
+	bool keep_sending = receiver->tuple_queue->receiveSlot(receiver->batch_slot, receiver->tuple_queue);
+	ExecClearTuple(receiver->batch_slot);
+	InvokeCPPFunc(ColumnarBatchReset_Cpp, receiver);
+	return keep_sending;
+}
+
+static void
+ColumnarBatchStartup(DestReceiver *self, int operation, TupleDesc typeinfo) {
+	auto receiver = reinterpret_cast<ColumnarBatchReceiver *>(self);
+	receiver->tuple_queue->rStartup(receiver->tuple_queue, operation, typeinfo);
+	receiver->batch_slot = MakeSingleTupleTableSlot(typeinfo, &TTSOpsMinimalTuple);
+	InvokeCPPFunc(ColumnarBatchStartup_Cpp, receiver, typeinfo);
+}
+
+static bool
+ColumnarBatchReceiveSlot(TupleTableSlot *slot, DestReceiver *self) {
+	auto receiver = reinterpret_cast<ColumnarBatchReceiver *>(self);
+	MinimalTuple batch = InvokeCPPFunc(ColumnarBatchAppend_Cpp, receiver, slot);
+	return batch ? ColumnarBatchSend(receiver, batch) : true;
+}
+
+static void
+ColumnarBatchShutdown(DestReceiver *self) {
+	auto receiver = reinterpret_cast<ColumnarBatchReceiver *>(self);
+	MinimalTuple batch = InvokeCPPFunc(ColumnarBatchSerialize_Cpp, receiver);
+	if (batch) {
+		ColumnarBatchSend(receiver, batch);
+	}
+	InvokeCPPFunc(ColumnarBatchCleanup_Cpp, receiver);
+	ExecDropSingleTupleTableSlot(receiver->batch_slot);
+	receiver->batch_slot = NULL;
+	receiver->tuple_queue->rShutdown(receiver->tuple_queue);
+}
+
+static void
+ColumnarBatchDestroy(DestReceiver *self) {
+	/* The tuple queue receiver is destroyed by ParallelQueryMain itself */
+	pfree(self);
+}
+
+} // extern "C"
+
+ParamListInfo
+MakeColumnarWorkerTransportParams() {
+	ParamListInfo params = makeParamList(1);
+	params->params[0].value = Int64GetDatum(COLUMNAR_WORKER_TRANSPORT_REQUEST);
+	params->params[0].isnull = false;
+	params->params[0].pflags = PARAM_FLAG_CONST;
+	params->params[0].ptype = INT8OID;
+	return params;
+}
+
+static bool
+IsColumnarWorkerTransportRequested(ParamListInfo params) {
+	if (params == NULL || params->numParams != 1 || params->paramFetch != NULL) {
+		return false;
+	}
+
+	const ParamExternData &param = params->params[0];
+	return param.ptype == INT8OID && !param.isnull && DatumGetInt64(param.value) == COLUMNAR_WORKER_TRANSPORT_REQUEST;
+}
+
+/*
+ * If the leader created the scan query with the parameters of
+ * MakeColumnarWorkerTransportParams, the tuple queue receiver of the worker
+ * gets wrapped, so every batch is sent as a single message instead of sending
+ * every tuple separately.
+ */
+void
+MaybeUseColumnarWorkerTransport(QueryDesc *query_desc) {
+	if (query_desc->operation != CMD_SELECT || !IsColumnarWorkerTransportRequested(query_desc->params)) {
+		return;
+	}
+
+	auto receiver = static_cast<ColumnarBatchReceiver *>(PostgresFunctionGuard(palloc0, sizeof(ColumnarBatchReceiver)));
+	receiver->pub.receiveSlot = ColumnarBatchReceiveSlot;
+	receiver->pub.rStartup = ColumnarBatchStartup;
+	receiver->pub.rShutdown = ColumnarBatchShutdown;
+	receiver->pub.rDestroy = ColumnarBatchDestroy;
+	receiver->pub.mydest = query_desc->dest->mydest;
+	receiver->tuple_queue = query_desc->dest;
+	receiver->batch_slot = NULL;
+	receiver->writer = nullptr;
+	query_desc->dest = &receiver->pub;
+}
+
+//
+// Leader side
+//
+
+/*
+ * Appends a columnar batch to the output chunk. Strings are not copied, they
+ * point into the batch, which is a copy in the tuple arena of the string
+ * buffer of the scan.
+ */
+void
+InsertColumnarBatchIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &scan_local_state,
+                             MinimalTuple batch) {
+	const char *data = reinterpret_cast<const char *>(batch) + BATCH_DATA_OFFSET;
+	ColumnarBatchHeader header;
+	if (batch->t_len < BATCH_DATA_OFFSET + sizeof(ColumnarBatchHeader) || batch->t_infomask2 != 0) {
+		throw duckdb::InternalException("(PGDuckDB/InsertColumnarBatchIntoChunk) Parallel worker sent a tuple "
+		                                "instead of a columnar batch");
+	}
+	memcpy(&header, data, sizeof(ColumnarBatchHeader));
+	if (header.magic != COLUMNAR_BATCH_MAGIC || header.column_count != output.ColumnCount()) {
+		throw duckdb::InternalException("(PGDuckDB/InsertColumnarBatchIntoChunk) Invalid columnar batch received "
+		                                "from parallel worker");
+	}
+	data += MAXALIGN(sizeof(ColumnarBatchHeader));
+
+	D_ASSERT(scan_local_state.output_vector_size == 0);
+	idx_t row_count = header.row_count;
+
+	for (idx_t col = 0; col < header.column_count; col++) {
+		auto &result = output.data[col];
+		auto &validity = duckdb::FlatVector::Validity(result);
+		ColumnarBatchColumnHeader column_header;
+		memcpy(&column_header, data, sizeof(ColumnarBatchColumnHeader));
+		data += MAXALIGN(sizeof(ColumnarBatchColumnHeader));
+
+		if (column_header.has_nulls) {
+			for (idx_t entry = 0; entry * 64 < row_count; entry++) {
+				duckdb::validity_t word;
+				memcpy(&word, data + entry * sizeof(duckdb::validity_t), sizeof(duckdb::validity_t));
+				if (word == ~duckdb::validity_t(0)) {
+					continue;
+				}
+				for (idx_t row = entry * 64; row < std::min<idx_t>(row_count, (entry + 1) * 64); row++) {
+					if (!(word & (duckdb::validity_t(1) << (row % 64)))) {
+						validity.SetInvalid(row);
+					}
+				}
+			}
+			data += ValidityMaskSize(row_count);
+		}
+
+		if (!IsStringColumn(result.GetType())) {
+			Size data_size = row_count * duckdb::GetTypeIdSize(result.GetType().InternalType());
+			memcpy(duckdb::FlatVector::GetData(result), data, data_size);
+			data += MAXALIGN(data_size);
+			continue;
+		}
+
+		auto strings = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+		auto lengths = reinterpret_cast<const uint32_t *>(data);
+		const char *string_data = data + MAXALIGN(row_count * sizeof(uint32_t));
+		for (idx_t row = 0; row < row_count; row++) {
+			if (!validity.RowIsValid(row)) {
+				continue;
+			}
+			strings[row] = duckdb::string_t(string_data, lengths[row]);
+			string_data += lengths[row];
+		}
+		data += MAXALIGN(row_count * sizeof(uint32_t)) + MAXALIGN(column_header.string_bytes);
+	}
+
+	scan_local_state.output_vector_size += row_count;
+	scan_local_state.global_state->total_row_count += row_count;
+}
+
+} // namespace pgduckdb
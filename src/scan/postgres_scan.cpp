@@ -1,15 +1,24 @@
 #include <duckdb/common/types.hpp>
+#include <duckdb/execution/expression_executor.hpp>
+#include <duckdb/planner/expression_iterator.hpp>
+#include <duckdb/planner/operator/logical_get.hpp>
+#include <duckdb/planner/filter/conjunction_filter.hpp>
+#include <duckdb/planner/filter/constant_filter.hpp>
+#include <duckdb/planner/filter/dynamic_filter.hpp>
 #include <duckdb/planner/filter/optional_filter.hpp>
 #include <duckdb/planner/filter/expression_filter.hpp>
 #include <duckdb/planner/expression/bound_comparison_expression.hpp>
 #include <duckdb/planner/expression/bound_constant_expression.hpp>
 #include <duckdb/planner/expression/bound_function_expression.hpp>
 #include <duckdb/planner/expression/bound_between_expression.hpp>
+#include <duckdb/planner/expression/bound_columnref_expression.hpp>
 #include <duckdb/planner/expression/bound_conjunction_expression.hpp>
 #include <duckdb/planner/expression/bound_operator_expression.hpp>
+#include <duckdb/planner/expression/bound_reference_expression.hpp>
 
 #include "pgduckdb/catalog/pgduckdb_table.hpp"
 #include "pgduckdb/scan/postgres_scan.hpp"
+#include "pgduckdb/scan/postgres_columnar_batch.hpp"
 #include "pgduckdb/scan/postgres_table_reader.hpp"
 #include "pgduckdb/pgduckdb_types.hpp"
 #include "pgduckdb/pgduckdb_utils.hpp"
@@ -20,7 +29,9 @@
 #include "pgduckdb/pgduckdb_process_lock.hpp"
 #include "pgduckdb/logger.hpp"
 
-#include <numeric> // std::accumulate
+#include <algorithm> // std::find
+#include <cmath>     // std::llround
+#include <numeric>   // std::accumulate
 #include <optional>
 
 namespace pgduckdb {
@@ -317,11 +328,18 @@ PostgresScanGlobalState::ExtractQueryFilters(duckdb::TableFilter *filter, const
 		query_filters += *ExpressionToString(*expression_filter.expr, column_name);
 		return 1;
 	}
-	/* DYNAMIC_FILTER is push down filter from topN execution. STRUCT_EXTRACT is
-	 * only received if struct_extract function is used. Default will catch all
-	 * filter that could be added in future in DuckDB.
+	/* DYNAMIC_FILTER is push down filter from topN execution. Its bound changes
+	 * during the scan, so it's applied to the scanned chunks instead, see
+	 * CollectDynamicFilters.
+	 */
+	case duckdb::TableFilterType::DYNAMIC_FILTER: {
+		pd_log(DEBUG1, "(DuckDB/ExtractQueryFilters) Applying dynamic filter during scan: %s",
+		       filter->ToString(column_name).c_str());
+		return 0;
+	}
+	/* STRUCT_EXTRACT is only received if struct_extract function is used.
+	 * Default will catch all filter that could be added in future in DuckDB.
 	 */
-	case duckdb::TableFilterType::DYNAMIC_FILTER:
 	case duckdb::TableFilterType::STRUCT_EXTRACT:
 	default: {
 		if (is_inside_optional_filter) {
@@ -335,6 +353,31 @@ PostgresScanGlobalState::ExtractQueryFilters(duckdb::TableFilter *filter, const
 	}
 }
 
+/*
+ * Finds the dynamic filters that DuckDB pushes down for Top-N queries. The
+ * bound of such a filter gets tighter while the Top-N operator sees more rows,
+ * so it can't be part of the Postgres query.
+ */
+static void
+CollectDynamicFilters(duckdb::TableFilter &filter,
+                      duckdb::vector<duckdb::shared_ptr<duckdb::DynamicFilterData>> &result) {
+	switch (filter.filter_type) {
+	case duckdb::TableFilterType::DYNAMIC_FILTER:
+		result.push_back(filter.Cast<duckdb::DynamicFilter>().filter_data);
+		break;
+	case duckdb::TableFilterType::OPTIONAL_FILTER:
+		CollectDynamicFilters(*filter.Cast<duckdb::OptionalFilter>().child_filter, result);
+		break;
+	case duckdb::TableFilterType::CONJUNCTION_AND:
+		for (auto &child_filter : filter.Cast<duckdb::ConjunctionAndFilter>().child_filters) {
+			CollectDynamicFilters(*child_filter, result);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 void
 PostgresScanGlobalState::ConstructTableScanQuery(const duckdb::TableFunctionInitInput &input) {
 	/* SELECT COUNT(*) FROM */
@@ -390,6 +433,19 @@ PostgresScanGlobalState::ConstructTableScanQuery(const duckdb::TableFunctionInit
 		}
 	}
 
+	for (idx_t output_index = 0; output_index < output_columns.size(); output_index++) {
+		auto column_filter_it = pg_column_order.find(output_columns[output_index]);
+		if (column_filter_it == pg_column_order.end() || !column_filters[column_filter_it->second]) {
+			continue;
+		}
+
+		duckdb::vector<duckdb::shared_ptr<duckdb::DynamicFilterData>> filters;
+		CollectDynamicFilters(*column_filters[column_filter_it->second], filters);
+		for (auto &filter_data : filters) {
+			dynamic_filters.emplace_back(output_index, std::move(filter_data));
+		}
+	}
+
 	scan_query << "SELECT ";
 
 	bool first = true;
@@ -419,19 +475,38 @@ PostgresScanGlobalState::ConstructTableScanQuery(const duckdb::TableFunctionInit
 	}
 
 	if (query_filters.size()) {
-		scan_query << " WHERE ";
-		scan_query << FilterJoin(query_filters, " AND ");
+		scan_filters = FilterJoin(query_filters, " AND ");
+		scan_query << " WHERE " << scan_filters;
 	}
 }
 
-PostgresScanGlobalState::PostgresScanGlobalState(Snapshot _snapshot, Relation _rel,
-                                                 const duckdb::TableFunctionInitInput &input)
-    : snapshot(_snapshot), rel(_rel), table_tuple_desc(RelationGetDescr(rel)), count_tuples_only(false),
-      output_columns(), total_row_count(0), registered_local_states(0), scan_query(),
+PostgresScanGlobalState::PostgresScanGlobalState(Relation _rel, const duckdb::TableFunctionInitInput &input)
+    : rel(_rel), table_tuple_desc(RelationGetDescr(rel)), count_tuples_only(false), output_columns(),
+      column_converters(), attr_cache_offsets(), columnar_worker_transport(false), dynamic_filters(),
+      total_row_count(0), registered_local_states(0), scan_query(), scan_filters(),
       table_reader_global_state(nullptr), duckdb_scan_memory_ctx(nullptr), max_threads(1) {
 	ConstructTableScanQuery(input);
+
+	// Work out how to convert every output column upfront, so that converting the values doesn't need to look at
+	// their types anymore.
+	if (!count_tuples_only) {
+		auto &column_types = input.bind_data->Cast<PostgresScanFunctionData>().column_types;
+		duckdb::vector<duckdb::LogicalType> output_types;
+		for (auto const &attr_num : output_columns) {
+			auto attr = GetAttr(table_tuple_desc, attr_num - 1);
+			column_converters.emplace_back(GetPostgresColumnConverter(attr, column_types[attr_num - 1]));
+			output_types.push_back(column_types[attr_num - 1]);
+		}
+
+		// Workers can only send columnar batches if they're read by the multi-threaded scan below, which is only
+		// used with more than one DuckDB thread.
+		columnar_worker_transport = duckdb_columnar_worker_transport && duckdb_threads_for_postgres_scan > 1 &&
+		                            SupportsColumnarWorkerTransport(output_types);
+	}
+
 	table_reader_global_state = duckdb::make_shared_ptr<PostgresTableReader>();
-	table_reader_global_state->Init(scan_query.str().c_str(), count_tuples_only);
+	TableScanKey scan_key {GetRelationOid(rel), count_tuples_only, output_columns, scan_filters};
+	table_reader_global_state->Init(scan_key, scan_query.str().c_str(), columnar_worker_transport);
 	// Dedicated Postgres memory context for temporary allocations during type conversion in scans.
 	duckdb_scan_memory_ctx = pg::MemoryContextCreate(CurrentMemoryContext, "DuckdbScanContext");
 
@@ -448,6 +523,12 @@ PostgresScanGlobalState::PostgresScanGlobalState(Snapshot _snapshot, Relation _r
 		max_threads = duckdb_threads_for_postgres_scan;
 	}
 
+	// Multi-threaded scans deform the worker tuples column-at-a-time, for which we need the offsets of the
+	// fixed-width attributes. These are the same for every tuple, so only compute them once.
+	if (max_threads > 1 && !columnar_worker_transport) {
+		attr_cache_offsets = ComputeAttrCacheOffsets(table_reader_global_state->GetResultTupleDesc());
+	}
+
 	pd_log(DEBUG1, "(DuckDB/PostgresSeqScanGlobalState) Running %" PRIu64 " threads: '%s'", (uint64_t)MaxThreads(),
 	       scan_query.str().c_str());
 }
@@ -463,7 +544,7 @@ PostgresScanGlobalState::RegisterLocalState() {
 
 void
 PostgresScanGlobalState::UnregisterLocalState() {
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
 	registered_local_states--;
 	// Cleanup up the table reader global state when all registered local states are gone.
 	// And set the flag to negative to indicate no more local states are allowed to be registered.
@@ -476,13 +557,33 @@ PostgresScanGlobalState::UnregisterLocalState() {
 PostgresScanGlobalState::~PostgresScanGlobalState() {
 }
 
+//
+// PostgresScanStringBuffer
+//
+
+PostgresScanStringBuffer::PostgresScanStringBuffer()
+    : duckdb::VectorBuffer(duckdb::VectorBufferType::OPAQUE_BUFFER),
+      tuple_arena(duckdb::Allocator::DefaultAllocator()), detoasted_values() {
+}
+
+PostgresScanStringBuffer::~PostgresScanStringBuffer() {
+	for (auto value : detoasted_values) {
+		duckdb_free(value);
+	}
+}
+
+void
+PostgresScanStringBuffer::AddDetoastedValue(void *value) {
+	detoasted_values.push_back(value);
+}
+
 //
 // PostgresScanLocalState
 //
 
 PostgresScanLocalState::PostgresScanLocalState(PostgresScanGlobalState *_global_state)
-    : global_state(_global_state), output_vector_size(0), exhausted_scan(false) {
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
+    : global_state(_global_state), worker_queues(), string_buffer(), output_vector_size(0), exhausted_scan(false) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
 	bool registered = global_state->RegisterLocalState();
 	if (!registered || global_state->MaxThreads() <= 1) {
 		return;
@@ -499,13 +600,24 @@ PostgresScanLocalState::~PostgresScanLocalState() {
 // PostgresSeqScanFunctionData
 //
 
-PostgresScanFunctionData::PostgresScanFunctionData(Relation _rel, uint64_t _cardinality, Snapshot _snapshot)
-    : complex_filters(), rel(_rel), cardinality(_cardinality), snapshot(_snapshot) {
+PostgresScanFunctionData::PostgresScanFunctionData(duckdb::TableCatalogEntry &_table, Relation _rel,
+                                                   uint64_t _cardinality,
+                                                   duckdb::vector<duckdb::LogicalType> _column_types)
+    : complex_filters(), table(_table), relid(GetRelationOid(_rel)), relation_name(GetRelationName(_rel)),
+      cardinality(_cardinality), filtered_cardinality(_cardinality), column_types(std::move(_column_types)),
+      distinct_counts() {
 }
 
 PostgresScanFunctionData::~PostgresScanFunctionData() {
 }
 
+duckdb::unique_ptr<duckdb::BaseStatistics>
+MakeDistinctCountStatistics(const duckdb::LogicalType &type, duckdb::idx_t distinct_count) {
+	auto stats = duckdb::BaseStatistics::CreateUnknown(type);
+	stats.SetDistinctCount(distinct_count);
+	return stats.ToUnique();
+}
+
 //
 // PostgresScanFunction
 //
@@ -515,6 +627,112 @@ PostgresScanPushdownExpression(duckdb::ClientContext &, const duckdb::LogicalGet
 	return ExpressionToString(expr, "dummy") != std::nullopt;
 }
 
+/*
+ * Returns the Postgres column that a filter expression uses, or an invalid
+ * index if it uses more than one or none at all.
+ */
+static duckdb::idx_t
+FilterExpressionColumn(duckdb::unique_ptr<duckdb::Expression> &expr, const duckdb::LogicalGet &get) {
+	duckdb::optional_ptr<duckdb::BoundColumnRefExpression> column_ref;
+	bool single_column = true;
+	duckdb::ExpressionIterator::EnumerateExpression(expr, [&](duckdb::Expression &child) {
+		if (child.GetExpressionClass() != duckdb::ExpressionClass::BOUND_COLUMN_REF) {
+			return;
+		}
+		auto &child_ref = child.Cast<duckdb::BoundColumnRefExpression>();
+		if (column_ref && column_ref->binding != child_ref.binding) {
+			single_column = false;
+		}
+		column_ref = &child_ref;
+	});
+
+	if (!column_ref || !single_column) {
+		return duckdb::DConstants::INVALID_INDEX;
+	}
+	return get.GetColumnIds()[column_ref->binding.column_index].GetPrimaryIndex();
+}
+
+/*
+ * Renders a filter the same way ConstructTableScanQuery renders it once
+ * DuckDB turned it into a table filter.
+ */
+static std::optional<duckdb::string>
+FilterExpressionToString(const duckdb::Expression &expr, const duckdb::string &column_name) {
+	if (expr.GetExpressionClass() == duckdb::ExpressionClass::BOUND_COMPARISON &&
+	    expr.type != duckdb::ExpressionType::COMPARE_DISTINCT_FROM &&
+	    expr.type != duckdb::ExpressionType::COMPARE_NOT_DISTINCT_FROM) {
+		auto &comparison = expr.Cast<duckdb::BoundComparisonExpression>();
+		if (comparison.left->type == duckdb::ExpressionType::BOUND_COLUMN_REF &&
+		    comparison.right->type == duckdb::ExpressionType::VALUE_CONSTANT) {
+			auto &value = comparison.right->Cast<duckdb::BoundConstantExpression>().value;
+			return duckdb::ConstantFilter(expr.type, value).ToString(column_name);
+		}
+		if (comparison.left->type == duckdb::ExpressionType::VALUE_CONSTANT &&
+		    comparison.right->type == duckdb::ExpressionType::BOUND_COLUMN_REF) {
+			auto &value = comparison.left->Cast<duckdb::BoundConstantExpression>().value;
+			return duckdb::ConstantFilter(duckdb::FlipComparisonExpression(expr.type), value).ToString(column_name);
+		}
+	}
+	return ExpressionToString(expr, column_name);
+}
+
+/*
+ * DuckDB's join order optimizer only knows the size of the table, so it
+ * guesses how selective the filters on a scan are. Postgres can do much
+ * better using its column statistics, so the filters are passed to the
+ * Postgres planner to estimate how many rows will be scanned, which the scan
+ * reports through its cardinality callback. The filters are left in place:
+ * they're still pushed into the scan as table filters.
+ *
+ * The estimate is best effort. If Postgres can't plan the filters, they're
+ * left out of the estimate and the previous estimate is kept, which is the
+ * size of the whole table if there was none.
+ */
+static void
+PostgresScanPushdownComplexFilter(duckdb::ClientContext &, duckdb::LogicalGet &get, duckdb::FunctionData *bind_data_p,
+                                  duckdb::vector<duckdb::unique_ptr<duckdb::Expression>> &filters) {
+	auto &bind_data = bind_data_p->Cast<PostgresScanFunctionData>();
+	Relation rel;
+	{
+		std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+		rel = GetOpenRelation(bind_data.relid);
+	}
+	auto tuple_desc = RelationGetDescr(rel);
+	auto previous_filter_count = bind_data.complex_filters.size();
+
+	for (auto &filter : filters) {
+		auto column_id = FilterExpressionColumn(filter, get);
+		if (column_id >= static_cast<duckdb::idx_t>(GetTupleDescNatts(tuple_desc))) {
+			continue;
+		}
+
+		auto column_name = QuoteIdentifier(GetAttName(GetAttr(tuple_desc, column_id)));
+		auto query_filter = FilterExpressionToString(*filter, column_name);
+		if (!query_filter || std::find(bind_data.complex_filters.begin(), bind_data.complex_filters.end(),
+		                               *query_filter) != bind_data.complex_filters.end()) {
+			continue;
+		}
+
+		bind_data.complex_filters.emplace_back(*query_filter);
+	}
+
+	if (bind_data.complex_filters.size() == previous_filter_count) {
+		return;
+	}
+
+	double estimate;
+	try {
+		estimate = EstimateFilteredRelSize(rel, FilterJoin(bind_data.complex_filters, " AND ").c_str());
+	} catch (std::exception &ex) {
+		pd_log(DEBUG1, "(DuckDB/PostgresScanPushdownComplexFilter) Could not estimate the size of filtered scan: %s",
+		       ex.what());
+		bind_data.complex_filters.resize(previous_filter_count);
+		return;
+	}
+
+	bind_data.filtered_cardinality = std::min(bind_data.cardinality, static_cast<uint64_t>(std::llround(estimate)));
+}
+
 PostgresScanTableFunction::PostgresScanTableFunction()
     : TableFunction("pgduckdb_postgres_scan", {}, PostgresScanFunction, nullptr, PostgresScanInitGlobal,
                     PostgresScanInitLocal) {
@@ -525,7 +743,10 @@ PostgresScanTableFunction::PostgresScanTableFunction()
 	filter_pushdown = true;
 	filter_prune = true;
 	cardinality = PostgresScanCardinality;
+	statistics = PostgresScanStatistics;
+	get_bind_info = PostgresScanGetBindInfo;
 	pushdown_expression = PostgresScanPushdownExpression;
+	pushdown_complex_filter = PostgresScanPushdownComplexFilter;
 	to_string = ToString;
 }
 
@@ -533,14 +754,17 @@ duckdb::InsertionOrderPreservingMap<duckdb::string>
 PostgresScanTableFunction::ToString(duckdb::TableFunctionToStringInput &input) {
 	auto &bind_data = input.bind_data->Cast<PostgresScanFunctionData>();
 	duckdb::InsertionOrderPreservingMap<duckdb::string> result;
-	result["Table"] = GetRelationName(bind_data.rel);
+	result["Table"] = bind_data.relation_name;
 	return result;
 }
 
 duckdb::unique_ptr<duckdb::GlobalTableFunctionState>
 PostgresScanTableFunction::PostgresScanInitGlobal(duckdb::ClientContext &, duckdb::TableFunctionInitInput &input) {
 	auto &bind_data = input.bind_data->CastNoConst<PostgresScanFunctionData>();
-	return duckdb::make_uniq<PostgresScanGlobalState>(bind_data.snapshot, bind_data.rel, input);
+	/* The optimizer is done with the catalog entry, which doesn't outlive this query */
+	bind_data.table = nullptr;
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	return duckdb::make_uniq<PostgresScanGlobalState>(GetOpenRelation(bind_data.relid), input);
 }
 
 duckdb::unique_ptr<duckdb::LocalTableFunctionState>
@@ -582,18 +806,43 @@ ScanSingleTuple(duckdb::DataChunk &output, PostgresScanLocalState &local_state)
 	return true;
 }
 
-void
-PostgresScanTableFunction::PostgresScanFunction(duckdb::ClientContext &, duckdb::TableFunctionInput &data,
-                                                duckdb::DataChunk &output) {
-	auto &local_state = data.local_state->Cast<PostgresScanLocalState>();
+/*
+ * Scans up to `count` tuples of the share of a parallel scan that the leader executes itself, and appends them to the
+ * output chunk. This is meant for multi-threaded scans, for when none of the workers has tuples ready.
+ *
+ * @return The number of tuples that were scanned, less than `count` if the leader's share is done.
+ */
+static size_t
+ScanLeaderTuples(duckdb::DataChunk &output, PostgresScanLocalState &local_state, size_t count) {
+	auto global_state = local_state.global_state;
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	size_t scanned = 0;
+	for (; scanned < count; scanned++) {
+		TupleTableSlot *slot = global_state->table_reader_global_state->GetNextLeaderTuple();
+		if (pgduckdb::TupleIsNull(slot)) {
+			break;
+		}
 
-	/* We have exhausted table scan */
-	if (local_state.exhausted_scan) {
-		SetOutputCardinality(output, local_state);
-		return;
+		// The slot is only valid until the next tuple is scanned, possibly by another thread, so convert it while
+		// still holding the lock.
+		SlotGetAllAttrs(slot);
+		MemoryContext old_context = pg::MemoryContextSwitchTo(global_state->duckdb_scan_memory_ctx);
+		InsertTupleIntoChunk(output, local_state, slot);
+		pg::MemoryContextSwitchTo(old_context);
 	}
 
+	pg::MemoryContextReset(global_state->duckdb_scan_memory_ctx);
+	return scanned;
+}
+
+/*
+ * Fills the output chunk with the next rows of the scan.
+ */
+static void
+ScanIntoChunk(duckdb::DataChunk &output, PostgresScanLocalState &local_state) {
 	local_state.output_vector_size = 0;
+	// The previous chunk keeps its own buffer alive for as long as DuckDB needs it
+	local_state.string_buffer = duckdb::make_buffer<PostgresScanStringBuffer>();
 
 	D_ASSERT(STANDARD_VECTOR_SIZE % LOCAL_STATE_SLOT_BATCH_SIZE == 0);
 	bool is_parallel_scan = local_state.global_state->MaxThreads() > 1;
@@ -601,52 +850,173 @@ PostgresScanTableFunction::PostgresScanFunction(duckdb::ClientContext &, duckdb:
 	size_t num_batches = STANDARD_VECTOR_SIZE / batch_size;
 
 	// For single-threaded scans, only one batch is processed and the global lock is acquired for each batch.
-	// For parallel scans, multiple batches are processed; the global lock is held only during tuple retrieval
-	// from the PostgreSQL parallel worker, allowing the rest of the processing to proceed concurrently.
+	// For parallel scans, multiple batches are processed. Each thread reads from its own worker queues, so the global
+	// lock is only held briefly while receiving a tuple from a queue, and the rest of the processing proceeds
+	// concurrently.
 	for (size_t batch_idx = 0; batch_idx < num_batches; batch_idx++) {
 		size_t valid_slots = 0;
-		{
-			std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
+		if (is_parallel_scan && local_state.global_state->columnar_worker_transport) {
+			// Every message from a worker is a whole columnar batch, which is as large as the output chunk at most.
+			// An empty chunk would end the scan, so keep going until there are rows or the scan is done.
+			while (local_state.output_vector_size == 0 && !local_state.exhausted_scan) {
+				MinimalTuple batch = local_state.global_state->table_reader_global_state->GetNextMinimalWorkerTuple(
+				    local_state.worker_queues, local_state.string_buffer->tuple_arena);
+				if (batch) {
+					InsertColumnarBatchIntoChunk(output, local_state, batch);
+				} else if (local_state.worker_queues.leader_turn) {
+					// Fill the chunk from the leader's own share a few tuples at a time, so that the other threads
+					// can read from their queues in between.
+					size_t scanned;
+					do {
+						scanned = ScanLeaderTuples(output, local_state, LOCAL_STATE_SLOT_BATCH_SIZE);
+					} while (scanned == LOCAL_STATE_SLOT_BATCH_SIZE &&
+					         local_state.output_vector_size < STANDARD_VECTOR_SIZE);
+				} else {
+					local_state.exhausted_scan = true;
+				}
+			}
+			break;
+		}
+
+		if (!is_parallel_scan) {
+			std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
 			for (size_t i = 0; i < batch_size; i++) {
-				bool ret = is_parallel_scan
-				               ? local_state.global_state->table_reader_global_state->GetNextMinimalWorkerTuple(
-				                     local_state.minimal_tuple_buffer[i])
-				               : ScanSingleTuple(output, local_state);
-				if (!ret) {
+				if (!ScanSingleTuple(output, local_state)) {
 					local_state.exhausted_scan = true;
 					break;
 				}
-
-				++valid_slots;
 			}
 
-			if (!is_parallel_scan) {
-				pg::MemoryContextReset(local_state.global_state->duckdb_scan_memory_ctx);
-				D_ASSERT(num_batches == 1);
+			pg::MemoryContextReset(local_state.global_state->duckdb_scan_memory_ctx);
+			D_ASSERT(num_batches == 1);
+			break;
+		}
+
+		MinimalTuple minimal_tuples[LOCAL_STATE_SLOT_BATCH_SIZE];
+		for (size_t i = 0; i < batch_size; i++) {
+			// Copied into the arena of the string buffer, so strings can point into the tuple
+			minimal_tuples[i] = local_state.global_state->table_reader_global_state->GetNextMinimalWorkerTuple(
+			    local_state.worker_queues, local_state.string_buffer->tuple_arena);
+			if (!minimal_tuples[i]) {
+				local_state.exhausted_scan = !local_state.worker_queues.leader_turn;
 				break;
 			}
+
+			++valid_slots;
 		}
 
 		// The follow-up convertion logic is thread-safe.
-		D_ASSERT(is_parallel_scan);
-		for (size_t i = 0; i < valid_slots; i++) {
-			MinimalTuple minmal_tuple = reinterpret_cast<MinimalTuple>(local_state.minimal_tuple_buffer[i].data());
-			local_state.slots[i] = ExecStoreMinimalTupleUnsafe(minmal_tuple, local_state.slots[i], false);
-			SlotGetAllAttrs(local_state.slots[i]);
+		InsertMinimalTuplesIntoChunk(output, local_state, minimal_tuples, valid_slots);
+
+		// None of the workers had a tuple ready, so fill up the batch from the leader's own share of the scan
+		if (valid_slots < batch_size && local_state.worker_queues.leader_turn) {
+			ScanLeaderTuples(output, local_state, batch_size - valid_slots);
 		}
-		InsertTuplesIntoChunk(output, local_state, local_state.slots, valid_slots);
+	}
+
+	// Strings of columnar batches point into the batch, so all string columns need the buffer in that case
+	auto &column_converters = local_state.global_state->column_converters;
+	bool columnar_worker_transport = is_parallel_scan && local_state.global_state->columnar_worker_transport;
+	for (idx_t i = 0; i < column_converters.size(); i++) {
+		if (column_converters[i].convert_no_copy ||
+		    (columnar_worker_transport && output.data[i].GetType().InternalType() == duckdb::PhysicalType::VARCHAR)) {
+			duckdb::StringVector::AddBuffer(output.data[i], local_state.string_buffer);
+		}
+	}
+
+	SetOutputCardinality(output, local_state);
+}
+
+/*
+ * Removes the rows from the output chunk that can't make it into the result of
+ * a Top-N query anymore, using the current bound of its dynamic filters. This
+ * saves DuckDB from processing rows that it would throw away anyway.
+ *
+ * This only happens after the rows were converted, and after parallel workers
+ * sent them. The bound is a DuckDB value that changes while the scan runs, so
+ * it can't be part of the Postgres scan query, and the workers can't see it.
+ * Checking it per tuple before conversion would need the filtered column to
+ * be converted separately in each of the conversion paths.
+ */
+static void
+ApplyDynamicFilters(duckdb::ClientContext &context, duckdb::DataChunk &output, PostgresScanLocalState &local_state) {
+	for (auto &[output_index, filter_data] : local_state.global_state->dynamic_filters) {
+		if (output.size() == 0) {
+			return;
+		}
+
+		duckdb::unique_ptr<duckdb::Expression> expression;
+		{
+			std::lock_guard<std::mutex> lock(filter_data->lock);
+			if (!filter_data->initialized) {
+				continue;
+			}
+			duckdb::BoundReferenceExpression column(output.data[output_index].GetType(), output_index);
+			expression = filter_data->filter->ToExpression(column);
+		}
+
+		duckdb::ExpressionExecutor executor(context, *expression);
+		duckdb::SelectionVector sel(STANDARD_VECTOR_SIZE);
+		idx_t count = executor.SelectExpression(output, sel);
+		if (count < output.size()) {
+			output.Slice(sel, count);
+		}
+	}
+}
+
+void
+PostgresScanTableFunction::PostgresScanFunction(duckdb::ClientContext &context, duckdb::TableFunctionInput &data,
+                                                duckdb::DataChunk &output) {
+	auto &local_state = data.local_state->Cast<PostgresScanLocalState>();
+
+	/* We have exhausted table scan */
+	if (local_state.exhausted_scan) {
+		SetOutputCardinality(output, local_state);
+		return;
+	}
+
+	ScanIntoChunk(output, local_state);
+	ApplyDynamicFilters(context, output, local_state);
+	// An empty chunk ends the scan, so keep scanning while the dynamic filters remove all rows
+	while (output.size() == 0 && !local_state.exhausted_scan) {
+		output.Reset();
+		ScanIntoChunk(output, local_state);
+		ApplyDynamicFilters(context, output, local_state);
 	}
 
 	if (local_state.exhausted_scan) {
 		local_state.global_state->UnregisterLocalState();
 	}
-	SetOutputCardinality(output, local_state);
 }
 
 duckdb::unique_ptr<duckdb::NodeStatistics>
 PostgresScanTableFunction::PostgresScanCardinality(duckdb::ClientContext &, const duckdb::FunctionData *data) {
 	auto &bind_data = data->Cast<PostgresScanFunctionData>();
-	return duckdb::make_uniq<duckdb::NodeStatistics>(bind_data.cardinality, bind_data.cardinality);
+	return duckdb::make_uniq<duckdb::NodeStatistics>(bind_data.filtered_cardinality, bind_data.cardinality);
+}
+
+duckdb::unique_ptr<duckdb::BaseStatistics>
+PostgresScanTableFunction::PostgresScanStatistics(duckdb::ClientContext &, const duckdb::FunctionData *data,
+                                                  duckdb::column_t column_id) {
+	auto &bind_data = data->Cast<PostgresScanFunctionData>();
+	if (column_id >= bind_data.distinct_counts.size() || bind_data.distinct_counts[column_id] == 0) {
+		return nullptr;
+	}
+	return MakeDistinctCountStatistics(bind_data.column_types[column_id], bind_data.distinct_counts[column_id]);
+}
+
+/*
+ * Exposing the table lets DuckDB's join order optimizer use the distinct
+ * counts of its columns, which it only trusts for catalog tables. The counts
+ * themselves come from PostgresScanStatistics.
+ */
+duckdb::BindInfo
+PostgresScanTableFunction::PostgresScanGetBindInfo(const duckdb::optional_ptr<duckdb::FunctionData> data) {
+	auto &bind_data = data->Cast<PostgresScanFunctionData>();
+	if (!bind_data.table) {
+		return duckdb::BindInfo(duckdb::ScanType::TABLE);
+	}
+	return duckdb::BindInfo(*bind_data.table);
 }
 
 } // namespace pgduckdb
@@ -1,7 +1,13 @@
+#include "duckdb/common/exception.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+
 #include "pgduckdb/scan/postgres_table_reader.hpp"
+#include "pgduckdb/scan/postgres_columnar_batch.hpp"
 #include "pgduckdb/pgduckdb_process_lock.hpp"
 #include "pgduckdb/pgduckdb_utils.hpp"
 #include "pgduckdb/pgduckdb_guc.hpp"
+#include "pgduckdb/pgduckdb_thread_governor.hpp"
+#include "pgduckdb/pg/relations.hpp"
 
 extern "C" {
 #include "postgres.h"
@@ -16,14 +22,17 @@ extern "C" {
 #include "executor/executor.h"
 #include "executor/execParallel.h"
 #include "executor/tqueue.h"
+#include "optimizer/optimizer.h"
 #include "optimizer/planmain.h"
 #include "optimizer/planner.h"
 #include "tcop/tcopprot.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/snapmgr.h"
 #include "utils/wait_event.h"
 #include "storage/latch.h"
+#include "storage/lmgr.h"
 #if PG_VERSION_NUM >= 190000
 #include "storage/waiteventset.h"
 #endif
@@ -31,25 +40,40 @@ extern "C" {
 
 #include "pgduckdb/vendor/pg_list.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace pgduckdb {
 
-PostgresTableReader::PostgresTableReader()
-    : table_scan_query_desc(nullptr), table_scan_planstate(nullptr), parallel_executor_info(nullptr),
-      parallel_worker_readers(nullptr), slot(nullptr), nworkers_launched(0), nreaders(0), next_parallel_reader(0),
-      entered_parallel_mode(false), cleaned_up(false) {
+ParallelWorkerQueues::ParallelWorkerQueues() : readers(), next_reader(0), claimed_share(false), leader_turn(false) {
 }
 
+/*
+ * Once the transaction aborts, Postgres releases the resources of the scans
+ * itself, also of the ones that a streaming DuckDB result still reads from.
+ */
 void
-PostgresTableReader::Init(const char *table_scan_query, bool count_tuples_only) {
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
-	PostgresScopedStackReset scoped_stack_reset;
-	PostgresMemberGuard(PostgresTableReader::InitUnsafe, table_scan_query, count_tuples_only);
+CheckPostgresScansNotAborted() {
+	if (!IsTransactionState()) {
+		throw duckdb::InterruptException();
+	}
 }
 
-void
-PostgresTableReader::InitUnsafe(const char *table_scan_query, bool count_tuples_only) {
+PostgresTableReader::PostgresTableReader()
+    : table_scan_query_desc(nullptr), table_scan_planstate(nullptr), parallel_executor_info(nullptr),
+      parallel_worker_readers(nullptr), slot(nullptr), nworkers_launched(0), nreaders(0), num_consumers(1),
+      next_unclaimed_reader(0), leader_participation(false), leader_scan_done(false), single_consumer_queues(),
+      entered_parallel_mode(false), cleaned_up(false) {
+}
+
+static PlannedStmt *
+PlanTableScanQuery(const char *table_scan_query) {
 	List *raw_parsetree_list = pg_parse_query(table_scan_query);
 	Assert(list_length(raw_parsetree_list) == 1);
 	RawStmt *raw_parsetree = linitial_node(RawStmt, raw_parsetree_list);
@@ -64,18 +88,152 @@ PostgresTableReader::InitUnsafe(const char *table_scan_query, bool count_tuples_
 	Query *query = linitial_node(Query, query_list);
 
 	Assert(list_length(query->rtable) == 1);
-	RangeTblEntry *rte = linitial_node(RangeTblEntry, query->rtable);
-
-	char persistence = get_rel_persistence(rte->relid);
 
 #if PG_VERSION_NUM >= 190000
-	PlannedStmt *planned_stmt = standard_planner(query, table_scan_query, 0, nullptr, nullptr);
+	return standard_planner(query, table_scan_query, 0, nullptr, nullptr);
 #else
-	PlannedStmt *planned_stmt = standard_planner(query, table_scan_query, 0, nullptr);
+	return standard_planner(query, table_scan_query, 0, nullptr);
 #endif
+}
+
+bool
+TableScanKey::operator==(const TableScanKey &other) const {
+	return relid == other.relid && count_tuples_only == other.count_tuples_only &&
+	       output_columns == other.output_columns && filters == other.filters;
+}
+
+size_t
+TableScanKeyHash::operator()(const TableScanKey &key) const {
+	size_t hash = std::hash<Oid>()(key.relid) ^ std::hash<bool>()(key.count_tuples_only);
+	for (AttrNumber attr_num : key.output_columns) {
+		hash = hash * 31 + std::hash<AttrNumber>()(attr_num);
+	}
+	return hash ^ std::hash<std::string>()(key.filters);
+}
+
+/*
+ * Scans of the same table with the same columns and filters have the same
+ * scan query, and short analytic queries often run over and over again.
+ * Parsing and planning the scan query is a significant part of their runtime,
+ * so the plans are cached for the lifetime of the backend. Like the plans of
+ * prepared statements, they are replanned when one of their relations
+ * changes, but not when planner settings change.
+ *
+ * At most duckdb.max_cached_scan_plans plans are kept, the least recently
+ * used plan is evicted to make room for a new one.
+ */
+struct CachedScanPlan {
+	TableScanKey key;
+	MemoryContext context;
+	PlannedStmt *planned_stmt;
+	bool valid;
+};
+
+/* Ordered from most to least recently used */
+static std::list<CachedScanPlan> cached_scan_plans;
+static std::unordered_map<TableScanKey, std::list<CachedScanPlan>::iterator, TableScanKeyHash> cached_scan_plan_index;
+
+void
+InvalidateCachedScanPlans(Oid relid) {
+	for (auto &plan : cached_scan_plans) {
+		if (relid == InvalidOid || list_member_oid(plan.planned_stmt->relationOids, relid)) {
+			plan.valid = false;
+		}
+	}
+}
+
+static void
+DropCachedScanPlan(std::list<CachedScanPlan>::iterator it) {
+	MemoryContextDelete(it->context);
+	cached_scan_plan_index.erase(it->key);
+	cached_scan_plans.erase(it);
+}
+
+/*
+ * Returns a plan for the scan query that the caller is free to modify, from
+ * the cache if possible.
+ */
+static PlannedStmt *
+GetTableScanPlan(const TableScanKey &scan_key, const char *table_scan_query) {
+	auto index_it = cached_scan_plan_index.find(scan_key);
+	if (index_it != cached_scan_plan_index.end()) {
+		auto it = index_it->second;
+
+		/*
+		 * Like AcquireExecutorLocks does for cached plans: locking the
+		 * relations processes any pending invalidations, after which we know
+		 * if the plan is still valid. The relations need to be locked for the
+		 * scan anyway.
+		 */
+		foreach_node(RangeTblEntry, rte, it->planned_stmt->rtable) {
+			if (rte->rtekind == RTE_RELATION) {
+				LockRelationOid(rte->relid, rte->rellockmode);
+			}
+		}
 
+		if (it->valid) {
+			elog(DEBUG1, "(PGDuckDB/GetTableScanPlan) Reusing the cached plan of: %s", table_scan_query);
+			cached_scan_plans.splice(cached_scan_plans.begin(), cached_scan_plans, it);
+			return (PlannedStmt *)copyObject(it->planned_stmt);
+		}
+
+		DropCachedScanPlan(it);
+	}
+
+	PlannedStmt *planned_stmt = PlanTableScanQuery(table_scan_query);
+
+	/* Plans that depend on row level security policies or on still invisible indexes can't be reused */
+	if (planned_stmt->dependsOnRole || planned_stmt->transientPlan || duckdb_max_cached_scan_plans <= 0) {
+		return planned_stmt;
+	}
+
+	while (cached_scan_plans.size() >= static_cast<size_t>(duckdb_max_cached_scan_plans)) {
+		elog(DEBUG1, "(PGDuckDB/GetTableScanPlan) Evicting a cached plan of relation %u",
+		     cached_scan_plans.back().key.relid);
+		DropCachedScanPlan(std::prev(cached_scan_plans.end()));
+	}
+
+	MemoryContext plan_context = AllocSetContextCreate(CacheMemoryContext, "PGDuckDB cached scan plan",
+	                                                   ALLOCSET_SMALL_SIZES);
+	MemoryContext old_context = MemoryContextSwitchTo(plan_context);
+	PlannedStmt *cached_stmt = (PlannedStmt *)copyObject(planned_stmt);
+	MemoryContextSwitchTo(old_context);
+	cached_scan_plans.push_front(CachedScanPlan {scan_key, plan_context, cached_stmt, true});
+	cached_scan_plan_index.emplace(scan_key, cached_scan_plans.begin());
+
+	return planned_stmt;
+}
+
+void
+PostgresTableReader::Init(const TableScanKey &scan_key, const char *table_scan_query, bool columnar_worker_transport) {
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+	CheckPostgresScansNotAborted();
+	PostgresScopedStackReset scoped_stack_reset;
+	PostgresMemberGuard(PostgresTableReader::InitUnsafe, scan_key, table_scan_query, columnar_worker_transport);
+}
+
+/*
+ * If columnar_worker_transport is true, any parallel workers send their
+ * results as columnar batches (see postgres_columnar_batch.cpp), which the
+ * caller then needs to read with GetNextMinimalWorkerTuple.
+ */
+void
+PostgresTableReader::InitUnsafe(const TableScanKey &scan_key, const char *table_scan_query,
+                                bool columnar_worker_transport) {
+	PlannedStmt *planned_stmt = GetTableScanPlan(scan_key, table_scan_query);
+
+	char persistence = RELPERSISTENCE_PERMANENT;
+	foreach_node(RangeTblEntry, rte, planned_stmt->rtable) {
+		if (rte->rtekind == RTE_RELATION) {
+			persistence = get_rel_persistence(rte->relid);
+			break;
+		}
+	}
+
+	// The parameters are passed on to the parallel workers, which is how they know to send columnar batches.
+	ParamListInfo params = columnar_worker_transport ? MakeColumnarWorkerTransportParams() : nullptr;
 	table_scan_query_desc = CreateQueryDesc(planned_stmt, table_scan_query, GetActiveSnapshot(), InvalidSnapshot,
-	                                        None_Receiver, nullptr, nullptr, 0);
+	                                        None_Receiver, params, nullptr, 0);
 
 	ExecutorStart(table_scan_query_desc, 0);
 
@@ -86,7 +244,7 @@ PostgresTableReader::InitUnsafe(const char *table_scan_query, bool count_tuples_
 
 	/* Temp tables cannot be excuted with parallel workers, and whole plan should be parallel aware */
 	if (run_scan_with_parallel_workers) {
-		InitRunWithParallelScan(planned_stmt, count_tuples_only);
+		InitRunWithParallelScan(planned_stmt, scan_key.count_tuples_only);
 	}
 
 	if (duckdb_log_pg_explain) {
@@ -114,6 +272,8 @@ PostgresTableReader::InitRunWithParallelScan(PlannedStmt *planned_stmt, bool cou
 		MarkPlanParallelAware(table_scan_query_desc->planstate->plan);
 		parallel_workers = ParallelWorkerNumber(planned_stmt->planTree->plan_rows);
 	}
+	/* The workers count towards the share of duckdb.max_threads_global of this backend */
+	parallel_workers = ReservePostgresScanWorkers(parallel_workers);
 
 	bool interrupts_can_be_process = INTERRUPTS_CAN_BE_PROCESSED();
 	if (!interrupts_can_be_process) {
@@ -129,10 +289,14 @@ PostgresTableReader::InitRunWithParallelScan(PlannedStmt *planned_stmt, bool cou
 	pcxt = parallel_executor_info->pcxt;
 	LaunchParallelWorkers(pcxt);
 	nworkers_launched = pcxt->nworkers_launched;
+	ReleasePostgresScanWorkers(parallel_workers - nworkers_launched);
 
 	if (pcxt->nworkers_launched > 0) {
 		ExecParallelCreateReaders(parallel_executor_info);
 		nreaders = pcxt->nworkers_launched;
+		// Must match the number of threads that PostgresScanGlobalState lets DuckDB use for the scan
+		num_consumers = count_tuples_only ? 1 : std::max(duckdb_threads_for_postgres_scan, 1);
+		leader_participation = parallel_leader_participation;
 		parallel_worker_readers = (void **)palloc(nreaders * sizeof(TupleQueueReader *));
 		memcpy(parallel_worker_readers, parallel_executor_info->reader, nreaders * sizeof(TupleQueueReader *));
 	}
@@ -154,15 +318,27 @@ PostgresTableReader::InitRunWithParallelScan(PlannedStmt *planned_stmt, bool cou
 TupleTableSlot *
 PostgresTableReader::InitTupleSlot() {
 	D_ASSERT(!cleaned_up);
+	CheckPostgresScansNotAborted();
 	return PostgresFunctionGuard(ExecInitExtraTupleSlot, table_scan_query_desc->estate,
 	                             table_scan_planstate->ps_ResultTupleDesc, &TTSOpsMinimalTuple);
 }
 
+/*
+ * Returns the descriptor of the tuples produced by the scan query. Both the
+ * tuples returned by GetNextTuple and the ones sent by the parallel workers
+ * use this descriptor.
+ */
+TupleDesc
+PostgresTableReader::GetResultTupleDesc() const {
+	D_ASSERT(!cleaned_up);
+	return table_scan_planstate->ps_ResultTupleDesc;
+}
+
 PostgresTableReader::~PostgresTableReader() {
 	if (cleaned_up) {
 		return;
 	}
-	std::lock_guard<std::recursive_mutex> lock(GlobalProcessLock::GetLock());
+	std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
 	Cleanup();
 }
 
@@ -170,6 +346,15 @@ void
 PostgresTableReader::Cleanup() {
 	D_ASSERT(!cleaned_up);
 	cleaned_up = true;
+	ReleasePostgresScanWorkers(nworkers_launched);
+	if (!IsTransactionState()) {
+		/*
+		 * The transaction aborted, which already released the relations,
+		 * snapshots and parallel context of the scan. The memory is freed
+		 * together with the portal, so there's nothing left to clean up.
+		 */
+		return;
+	}
 	PostgresScopedStackReset scoped_stack_reset;
 	PostgresMemberGuard(PostgresTableReader::CleanupUnsafe);
 }
@@ -289,74 +474,193 @@ PostgresTableReader::MarkPlanParallelAware(Plan *plan) {
  */
 TupleTableSlot *
 PostgresTableReader::GetNextTuple() {
+	CheckPostgresScansNotAborted();
 	return PostgresMemberGuard(PostgresTableReader::GetNextTupleUnsafe);
 }
 
 TupleTableSlot *
 PostgresTableReader::GetNextTupleUnsafe() {
-	if (nreaders > 0) {
-		MinimalTuple worker_minmal_tuple = GetNextWorkerTuple();
+	while (nreaders > 0) {
+		MinimalTuple worker_minmal_tuple = GetNextWorkerTuple(single_consumer_queues);
 		if (HeapTupleIsValid(worker_minmal_tuple)) {
 			ExecStoreMinimalTuple(worker_minmal_tuple, slot, false);
 			return slot;
 		}
+
+		/* All workers are done, whatever is left is scanned below */
+		if (!single_consumer_queues.leader_turn) {
+			break;
+		}
+
+		/* None of the workers has a tuple ready, so scan one ourselves. Once our share is done, wait for them. */
+		TupleTableSlot *leader_slot = GetNextLeaderTupleUnsafe();
+		if (!TupIsNull(leader_slot)) {
+			return leader_slot;
+		}
+	}
+
+	TupleTableSlot *thread_scan_slot = GetNextLeaderTupleUnsafe();
+	return TupIsNull(thread_scan_slot) ? ExecClearTuple(slot) : thread_scan_slot;
+}
+
+/*
+ * Returns the next tuple of the share of the scan that the leader executes
+ * itself, or NULL once that share is done. The returned slot is only valid
+ * until the next call, so the tuple needs to be converted while still holding
+ * the GlobalProcessLock, which should be held before calling this.
+ */
+TupleTableSlot *
+PostgresTableReader::GetNextLeaderTuple() {
+	CheckPostgresScansNotAborted();
+	return PostgresMemberGuard(PostgresTableReader::GetNextLeaderTupleUnsafe);
+}
+
+TupleTableSlot *
+PostgresTableReader::GetNextLeaderTupleUnsafe() {
+	if (leader_scan_done) {
+		return NULL;
 	}
 
 	PostgresScopedStackReset scoped_stack_reset;
 	table_scan_query_desc->estate->es_query_dsa = parallel_executor_info ? parallel_executor_info->area : NULL;
 	TupleTableSlot *thread_scan_slot = ExecProcNode(table_scan_planstate);
 	table_scan_query_desc->estate->es_query_dsa = NULL;
-	return TupIsNull(thread_scan_slot) ? ExecClearTuple(slot) : thread_scan_slot;
+	if (TupIsNull(thread_scan_slot)) {
+		leader_scan_done = true;
+		return NULL;
+	}
+	return thread_scan_slot;
 }
 
 /*
- * Reads the next minimal tuple from a Postgres parallel worker and copies it into the provided buffer.
- * This function should only be called when the table scan is running with parallel workers.
+ * Reads the next minimal tuple from one of the Postgres parallel worker queues of a consumer and copies it into the
+ * provided arena. The copy stays valid after reading the next tuple, so the caller can keep referencing values in it
+ * for as long as the arena lives. This function should only be called when the table scan is running with parallel
+ * workers.
+ *
+ * @param queues Worker queues of the calling thread, must not be used by any other thread.
+ * @param allocator Arena to allocate the copied minimal tuple in.
+ * @return the copied tuple; NULL if the workers are done, or if queues.leader_turn got set because the caller should
+ * scan part of the leader's share of the table with GetNextLeaderTuple first.
  *
- * @param minimal_tuple_buffer Buffer to store the copied minimal tuple.
- * @return true if a tuple was read and copied; false if the scan is complete and no more tuples are available.
+ * Note: The caller should NOT hold the GlobalProcessLock, it's only taken while actually reading from a queue.
+ */
+MinimalTuple
+PostgresTableReader::GetNextMinimalWorkerTuple(ParallelWorkerQueues &queues, duckdb::ArenaAllocator &allocator) {
+	MinimalTuple worker_minmal_tuple = GetNextWorkerTuple(queues);
+	if (!HeapTupleIsValid(worker_minmal_tuple)) {
+		return NULL;
+	}
+
+	// deep copy worker_minmal_tuple to the arena, which does not align its allocations itself
+	Size tuple_size = worker_minmal_tuple->t_len + MINIMAL_TUPLE_DATA_OFFSET;
+	auto minimal_tuple = reinterpret_cast<MinimalTuple>(allocator.Allocate(MAXALIGN(tuple_size)));
+	memcpy(minimal_tuple, worker_minmal_tuple, tuple_size);
+	return minimal_tuple;
+}
+
+/*
+ * Claims worker queues that no consumer reads from yet. The first time a consumer claims its share of all queues,
+ * after that it claims one queue at a time, which it only does once it runs out of tuples to read. That way all
+ * queues are read from, even if DuckDB ends up using fewer threads for the scan than we expected.
  *
- * Note: The caller must hold the GlobalProcessLock before invoking this function.
+ * Returns false if all queues have been claimed already.
  */
 bool
-PostgresTableReader::GetNextMinimalWorkerTuple(std::vector<uint8_t> &minimal_tuple_buffer) {
-	MinimalTuple worker_minmal_tuple = GetNextWorkerTuple();
-	if (HeapTupleIsValid(worker_minmal_tuple)) {
-		// deep copy worker_minmal_tuple to destination buffer
-		Size tuple_size = worker_minmal_tuple->t_len + MINIMAL_TUPLE_DATA_OFFSET;
-		minimal_tuple_buffer.resize(tuple_size);
-		memcpy(minimal_tuple_buffer.data(), worker_minmal_tuple, tuple_size);
-		return true;
+PostgresTableReader::ClaimWorkerQueues(ParallelWorkerQueues &queues) {
+	int count = 1;
+	if (!queues.claimed_share) {
+		count = (nreaders + num_consumers - 1) / num_consumers;
+		queues.claimed_share = true;
+	}
+
+	int first = next_unclaimed_reader.fetch_add(count);
+	for (int i = first; i < first + count && i < nreaders; i++) {
+		queues.readers.push_back(i);
 	}
+	return first < nreaders;
+}
+
+static const auto WORKER_TUPLES_WAIT_TIMEOUT = std::chrono::milliseconds(1);
+
+/*
+ * Coordinates the threads that wait for new worker tuples, see
+ * WaitForWorkerTuples. This is shared by all scans of the process.
+ */
+static std::mutex worker_tuples_mutex;
+static std::condition_variable worker_tuples_cv;
+static uint64_t worker_tuples_generation = 0;
+
+/*
+ * Returns the number of times a worker queue has finished so far. A consumer
+ * takes this before it checks its queues, so it can tell if a queue finished
+ * while it was checking.
+ */
+static uint64_t
+WorkerTuplesGeneration() {
+	std::lock_guard<std::mutex> lock(worker_tuples_mutex);
+	return worker_tuples_generation;
+}
+
+/* Wakes up the threads in WaitForWorkerTuples, so that they check their queues again right away */
+static void
+NotifyWorkerTuplesWaiters() {
+	{
+		std::lock_guard<std::mutex> lock(worker_tuples_mutex);
+		worker_tuples_generation++;
+	}
+	worker_tuples_cv.notify_all();
+}
 
-	minimal_tuple_buffer.resize(0);
-	return false;
+/*
+ * Blocks for a short while, so that parallel workers can send new tuples.
+ * The workers set the process latch when they do, but only the main thread
+ * may wait on that latch, because WaitLatch and ResetLatch are not
+ * thread-safe and the main thread uses the latch itself, e.g. to return the
+ * rows of a streaming result. So the scan threads poll their queues instead,
+ * and are woken up early if another one notices that a queue finished.
+ */
+static void
+WaitForWorkerTuples(uint64_t generation) {
+	std::unique_lock<std::mutex> lock(worker_tuples_mutex);
+	worker_tuples_cv.wait_for(lock, WORKER_TUPLES_WAIT_TIMEOUT,
+	                          [&] { return worker_tuples_generation != generation; });
 }
 
+/*
+ * Returns the next tuple from the worker queues of the given consumer. The returned tuple is only valid until the
+ * next call for the same consumer. Returns NULL if the workers are done, or if none of them has a tuple ready and
+ * queues.leader_turn got set.
+ */
 MinimalTuple
-PostgresTableReader::GetNextWorkerTuple() {
+PostgresTableReader::GetNextWorkerTuple(ParallelWorkerQueues &queues) {
 	int nvisited = 0;
-	TupleQueueReader *reader = NULL;
-	MinimalTuple minimal_tuple = NULL;
-	bool readerdone = false;
-	// The loop's stop condition acts as a safeguard in multithreaded scans, ensuring that if one thread calls this
-	// function after another thread has already completed the scan, we do not access invalid readers.
-	for (; next_parallel_reader < nreaders;) {
-		reader = (TupleQueueReader *)parallel_worker_readers[next_parallel_reader];
+	uint64_t wait_generation = WorkerTuplesGeneration();
+	queues.leader_turn = false;
+	for (;;) {
+		if (queues.readers.empty() && !ClaimWorkerQueues(queues)) {
+			/* The leader might still be halfway through a page of its own share */
+			queues.leader_turn = leader_participation && !leader_scan_done;
+			return NULL;
+		}
 
-		minimal_tuple = TupleQueueReaderNext(reader, true, &readerdone);
+		if (queues.next_reader >= static_cast<int>(queues.readers.size())) {
+			queues.next_reader = 0;
+		}
 
-		if (readerdone) {
-			--nreaders;
-			if (nreaders == 0) {
-				return NULL;
-			}
+		TupleQueueReader *reader = (TupleQueueReader *)parallel_worker_readers[queues.readers[queues.next_reader]];
+		MinimalTuple minimal_tuple = NULL;
+		bool readerdone = false;
+		{
+			// Only this consumer reads from the queue, but receiving from it may allocate memory and take LWLocks.
+			std::lock_guard<pgduckdb::ProcessLock> lock(GlobalProcessLock::GetLock());
+			CheckPostgresScansNotAborted();
+			minimal_tuple = TupleQueueReaderNext(reader, true, &readerdone);
+		}
 
-			memmove(&parallel_worker_readers[next_parallel_reader], &parallel_worker_readers[next_parallel_reader + 1],
-			        sizeof(TupleQueueReader *) * (nreaders - next_parallel_reader));
-			if (next_parallel_reader >= nreaders) {
-				next_parallel_reader = 0;
-			}
+		if (readerdone) {
+			queues.readers.erase(queues.readers.begin() + queues.next_reader);
+			NotifyWorkerTuplesWaiters();
 			continue;
 		}
 
@@ -364,25 +668,22 @@ PostgresTableReader::GetNextWorkerTuple() {
 			return minimal_tuple;
 		}
 
-		next_parallel_reader++;
-		if (next_parallel_reader >= nreaders) {
-			next_parallel_reader = 0;
-		}
-
+		queues.next_reader++;
 		nvisited++;
-		if (nvisited >= nreaders) {
-			/*
-			 * It should be safe to make this call because function calling GetNextTuple() and transitively
-			 * GetNextWorkerTuple() should held GlobalProcesLock.
-			 */
-			WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, 0, PG_WAIT_EXTENSION);
-			/* No need to use PostgresFunctionGuard here, because ResetLatch is a trivial function */
-			ResetLatch(MyLatch);
+		if (nvisited >= static_cast<int>(queues.readers.size())) {
+			// None of our queues has a tuple ready, so first see if there's a queue that nobody reads from yet. If not,
+			// the leader can scan part of its own share, instead of sitting idle until a worker sends more tuples.
+			if (!ClaimWorkerQueues(queues)) {
+				if (leader_participation && !leader_scan_done) {
+					queues.leader_turn = true;
+					return NULL;
+				}
+				WaitForWorkerTuples(wait_generation);
+			}
 			nvisited = 0;
+			wait_generation = WorkerTuplesGeneration();
 		}
 	}
-
-	return NULL;
 }
 
 } // namespace pgduckdb
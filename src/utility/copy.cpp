@@ -5,6 +5,7 @@
 #include "pgduckdb/pgduckdb_guc.hpp"
 #include "pgduckdb/pgduckdb_metadata_cache.hpp"
 #include "pgduckdb/pgduckdb_hooks.hpp"
+#include "pgduckdb/pgduckdb_node.hpp"
 
 extern "C" {
 #include "postgres.h"
@@ -14,6 +15,9 @@ extern "C" {
 #include "commands/defrem.h"
 #include "common/string.h"
 #include "executor/executor.h"
+#include "libpq/libpq.h"
+#include "libpq/pqformat.h"
+#include "mb/pg_wchar.h"
 #include "nodes/parsenodes.h"
 #include "parser/parser.h"
 #include "parser/parse_node.h"
@@ -22,8 +26,12 @@ extern "C" {
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/rls.h"
+#include "utils/snapmgr.h"
+#include "utils/timestamp.h"
+#include "utils/uuid.h"
 
 #include "pgduckdb/vendor/pg_list.hpp"
 #include "pgduckdb/pgduckdb_ruleutils.h"
@@ -454,3 +462,502 @@ MakeDuckdbCopyQuery(PlannedStmt *pstmt, const char *query_string, struct QueryEn
 
 	return rewritten_query_info->data;
 }
+
+/* How a single column is written by the DuckdbCopyOut receiver */
+typedef enum CopyOutMethod {
+	COPY_OUT_INT2,
+	COPY_OUT_INT4,
+	COPY_OUT_INT8,
+	COPY_OUT_FLOAT4,
+	COPY_OUT_FLOAT8,
+	COPY_OUT_BOOL,
+	COPY_OUT_VARLENA,
+	COPY_OUT_UUID,
+	COPY_OUT_INTERVAL,
+	COPY_OUT_FUNCTION,
+} CopyOutMethod;
+
+typedef struct CopyOutColumn {
+	CopyOutMethod method;
+	/* The output or send function of the type, only used for COPY_OUT_FUNCTION */
+	FmgrInfo function;
+} CopyOutColumn;
+
+/*
+ * DestReceiver that writes rows in the COPY text or binary format straight to
+ * the client. Rows are normally received a whole converted DuckDB chunk at a
+ * time through DuckdbCopyOutReceiveChunk, but receiveSlot works too.
+ */
+typedef struct DuckdbCopyOutReceiver {
+	DestReceiver pub;
+	bool binary;
+	int natts;
+	CopyOutColumn *columns;
+	StringInfoData buf;
+	/* Reset for every row, like the rowcontext of COPY TO, for detoasted values and output function results */
+	MemoryContext row_context;
+	/* Used by receiveSlot to pass the values of a slot as single value columns */
+	Datum **slot_values;
+	bool **slot_nulls;
+} DuckdbCopyOutReceiver;
+
+/* The CopyData messages that we send are roughly this size */
+#define COPY_OUT_MESSAGE_SIZE 65536
+
+/* Including the terminating zero byte, it's part of the signature */
+static const char BinarySignature[] = "PGCOPY\n\377\r\n";
+
+/*
+ * Only the default text format and the binary format are handled, for any
+ * other COPY option (delimiters, CSV, headers, ...) we let Postgres do the
+ * COPY instead.
+ */
+static bool
+GetCopyOutFormat(CopyStmt *copy_stmt, bool *binary) {
+	*binary = false;
+	foreach_node(DefElem, defel, copy_stmt->options) {
+		if (strcmp(defel->defname, "format") != 0) {
+			return false;
+		}
+
+		char *fmt = defGetString(defel);
+		if (strcmp(fmt, "binary") == 0) {
+			*binary = true;
+		} else if (strcmp(fmt, "text") != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+DuckdbCopyOutStartup(DestReceiver *self, int /*operation*/, TupleDesc typeinfo) {
+	DuckdbCopyOutReceiver *receiver = (DuckdbCopyOutReceiver *)self;
+	receiver->natts = typeinfo->natts;
+	receiver->columns = (CopyOutColumn *)palloc0(sizeof(CopyOutColumn) * typeinfo->natts);
+	receiver->slot_values = (Datum **)palloc(sizeof(Datum *) * typeinfo->natts);
+	receiver->slot_nulls = (bool **)palloc(sizeof(bool *) * typeinfo->natts);
+	initStringInfo(&receiver->buf);
+	receiver->row_context = AllocSetContextCreate(CurrentMemoryContext, "DuckdbCopyOut row", ALLOCSET_DEFAULT_SIZES);
+
+	for (int i = 0; i < typeinfo->natts; i++) {
+		Oid type_oid = TupleDescAttr(typeinfo, i)->atttypid;
+		CopyOutColumn *column = &receiver->columns[i];
+
+		switch (type_oid) {
+		case INT2OID:
+			column->method = COPY_OUT_INT2;
+			continue;
+		case INT4OID:
+			column->method = COPY_OUT_INT4;
+			continue;
+		case INT8OID:
+			column->method = COPY_OUT_INT8;
+			continue;
+		case BOOLOID:
+			column->method = COPY_OUT_BOOL;
+			continue;
+		case TEXTOID:
+		case VARCHAROID:
+		case BPCHAROID:
+		case JSONOID:
+			column->method = COPY_OUT_VARLENA;
+			continue;
+		default:
+			break;
+		}
+
+		/* These have a simple binary representation, but their text output depends on GUCs */
+		if (receiver->binary) {
+			switch (type_oid) {
+			case DATEOID:
+				column->method = COPY_OUT_INT4;
+				continue;
+			case TIMESTAMPOID:
+			case TIMESTAMPTZOID:
+			case TIMEOID:
+				column->method = COPY_OUT_INT8;
+				continue;
+			case FLOAT4OID:
+				column->method = COPY_OUT_FLOAT4;
+				continue;
+			case FLOAT8OID:
+				column->method = COPY_OUT_FLOAT8;
+				continue;
+			case BYTEAOID:
+				column->method = COPY_OUT_VARLENA;
+				continue;
+			case UUIDOID:
+				column->method = COPY_OUT_UUID;
+				continue;
+			case INTERVALOID:
+				column->method = COPY_OUT_INTERVAL;
+				continue;
+			default:
+				break;
+			}
+		}
+
+		Oid func_oid;
+		bool is_varlena;
+		if (receiver->binary) {
+			getTypeBinaryOutputInfo(type_oid, &func_oid, &is_varlena);
+		} else {
+			getTypeOutputInfo(type_oid, &func_oid, &is_varlena);
+		}
+		column->method = COPY_OUT_FUNCTION;
+		fmgr_info(func_oid, &column->function);
+	}
+
+	if (receiver->binary) {
+		appendBinaryStringInfo(&receiver->buf, BinarySignature, sizeof(BinarySignature));
+		/* No flags and no header extension */
+		pq_sendint32(&receiver->buf, 0);
+		pq_sendint32(&receiver->buf, 0);
+	}
+}
+
+/*
+ * Appends a value in the COPY text format, i.e. with backslashes and control
+ * characters escaped. This is the same as CopyAttributeOutText in Postgres
+ * with the default tab delimiter. All server encodings are safe to scan
+ * byte by byte here, because none of them embed ASCII in multibyte
+ * characters.
+ */
+static void
+AppendCopyOutText(StringInfo buf, const char *str, int len) {
+	const char *start = str;
+	const char *end = str + len;
+
+	for (const char *ptr = str; ptr < end; ptr++) {
+		char escaped;
+		switch (*ptr) {
+		case '\b':
+			escaped = 'b';
+			break;
+		case '\f':
+			escaped = 'f';
+			break;
+		case '\n':
+			escaped = 'n';
+			break;
+		case '\r':
+			escaped = 'r';
+			break;
+		case '\t':
+			escaped = 't';
+			break;
+		case '\v':
+			escaped = 'v';
+			break;
+		case '\\':
+			escaped = '\\';
+			break;
+		default:
+			continue;
+		}
+
+		appendBinaryStringInfo(buf, start, ptr - start);
+		appendStringInfoChar(buf, '\\');
+		appendStringInfoChar(buf, escaped);
+		start = ptr + 1;
+	}
+
+	appendBinaryStringInfo(buf, start, end - start);
+}
+
+static void
+AppendCopyOutTextValue(StringInfo buf, CopyOutColumn *column, Datum value) {
+	char int_buf[MAXINT8LEN + 1];
+
+	switch (column->method) {
+	case COPY_OUT_INT2:
+		appendBinaryStringInfo(buf, int_buf, pg_lltoa(DatumGetInt16(value), int_buf));
+		break;
+	case COPY_OUT_INT4:
+		appendBinaryStringInfo(buf, int_buf, pg_lltoa(DatumGetInt32(value), int_buf));
+		break;
+	case COPY_OUT_INT8:
+		appendBinaryStringInfo(buf, int_buf, pg_lltoa(DatumGetInt64(value), int_buf));
+		break;
+	case COPY_OUT_BOOL:
+		appendStringInfoChar(buf, DatumGetBool(value) ? 't' : 'f');
+		break;
+	case COPY_OUT_VARLENA: {
+		struct varlena *varlena = PG_DETOAST_DATUM_PACKED(value);
+		AppendCopyOutText(buf, VARDATA_ANY(varlena), VARSIZE_ANY_EXHDR(varlena));
+		break;
+	}
+	default: {
+		char *str = OutputFunctionCall(&column->function, value);
+		AppendCopyOutText(buf, str, strlen(str));
+		break;
+	}
+	}
+}
+
+static void
+AppendCopyOutBinaryValue(StringInfo buf, CopyOutColumn *column, Datum value) {
+	switch (column->method) {
+	case COPY_OUT_INT2:
+		pq_sendint32(buf, sizeof(int16));
+		pq_sendint16(buf, DatumGetInt16(value));
+		break;
+	case COPY_OUT_INT4:
+		pq_sendint32(buf, sizeof(int32));
+		pq_sendint32(buf, DatumGetInt32(value));
+		break;
+	case COPY_OUT_INT8:
+		pq_sendint32(buf, sizeof(int64));
+		pq_sendint64(buf, DatumGetInt64(value));
+		break;
+	case COPY_OUT_FLOAT4:
+		pq_sendint32(buf, sizeof(float4));
+		pq_sendfloat4(buf, DatumGetFloat4(value));
+		break;
+	case COPY_OUT_FLOAT8:
+		pq_sendint32(buf, sizeof(float8));
+		pq_sendfloat8(buf, DatumGetFloat8(value));
+		break;
+	case COPY_OUT_BOOL:
+		pq_sendint32(buf, 1);
+		pq_sendbyte(buf, DatumGetBool(value) ? 1 : 0);
+		break;
+	case COPY_OUT_VARLENA: {
+		struct varlena *varlena = PG_DETOAST_DATUM_PACKED(value);
+		pq_sendint32(buf, VARSIZE_ANY_EXHDR(varlena));
+		pq_sendbytes(buf, VARDATA_ANY(varlena), VARSIZE_ANY_EXHDR(varlena));
+		break;
+	}
+	case COPY_OUT_UUID:
+		pq_sendint32(buf, UUID_LEN);
+		pq_sendbytes(buf, (const char *)DatumGetUUIDP(value)->data, UUID_LEN);
+		break;
+	case COPY_OUT_INTERVAL: {
+		Interval *interval = DatumGetIntervalP(value);
+		pq_sendint32(buf, sizeof(int64) + 2 * sizeof(int32));
+		pq_sendint64(buf, interval->time);
+		pq_sendint32(buf, interval->day);
+		pq_sendint32(buf, interval->month);
+		break;
+	}
+	default: {
+		bytea *bytes = SendFunctionCall(&column->function, value);
+		pq_sendint32(buf, VARSIZE(bytes) - VARHDRSZ);
+		pq_sendbytes(buf, VARDATA(bytes), VARSIZE(bytes) - VARHDRSZ);
+		break;
+	}
+	}
+}
+
+static void
+FlushCopyOut(DuckdbCopyOutReceiver *receiver) {
+	if (receiver->buf.len == 0) {
+		return;
+	}
+
+	pq_putmessage('d', receiver->buf.data, receiver->buf.len);
+	resetStringInfo(&receiver->buf);
+}
+
+/* Appends a row to the buffer, the values of the row are at the given index in the value and null arrays */
+static inline void
+AppendCopyOutRow(DuckdbCopyOutReceiver *receiver, Datum **values, bool **nulls, uint64 row) {
+	StringInfo buf = &receiver->buf;
+
+	/* The buffer was allocated outside of the row context, and growing it keeps it there */
+	MemoryContextReset(receiver->row_context);
+	MemoryContext old_context = MemoryContextSwitchTo(receiver->row_context);
+
+	if (receiver->binary) {
+		pq_sendint16(buf, receiver->natts);
+		for (int col = 0; col < receiver->natts; col++) {
+			if (nulls[col][row]) {
+				pq_sendint32(buf, -1);
+			} else {
+				AppendCopyOutBinaryValue(buf, &receiver->columns[col], values[col][row]);
+			}
+		}
+	} else {
+		for (int col = 0; col < receiver->natts; col++) {
+			if (col > 0) {
+				appendStringInfoChar(buf, '\t');
+			}
+
+			if (nulls[col][row]) {
+				appendBinaryStringInfo(buf, "\\N", 2);
+			} else {
+				AppendCopyOutTextValue(buf, &receiver->columns[col], values[col][row]);
+			}
+		}
+		appendStringInfoChar(buf, '\n');
+	}
+
+	MemoryContextSwitchTo(old_context);
+
+	if (buf->len >= COPY_OUT_MESSAGE_SIZE) {
+		FlushCopyOut(receiver);
+	}
+}
+
+static bool
+DuckdbCopyOutReceiveSlot(TupleTableSlot *slot, DestReceiver *self) {
+	DuckdbCopyOutReceiver *receiver = (DuckdbCopyOutReceiver *)self;
+	slot_getallattrs(slot);
+
+	for (int col = 0; col < receiver->natts; col++) {
+		receiver->slot_values[col] = &slot->tts_values[col];
+		receiver->slot_nulls[col] = &slot->tts_isnull[col];
+	}
+
+	AppendCopyOutRow(receiver, receiver->slot_values, receiver->slot_nulls, 0);
+	return true;
+}
+
+static void
+DuckdbCopyOutShutdown(DestReceiver *self) {
+	DuckdbCopyOutReceiver *receiver = (DuckdbCopyOutReceiver *)self;
+	if (receiver->binary) {
+		/* File trailer */
+		pq_sendint16(&receiver->buf, -1);
+	}
+	FlushCopyOut(receiver);
+	MemoryContextDelete(receiver->row_context);
+}
+
+static void
+DuckdbCopyOutDestroy(DestReceiver *self) {
+	pfree(self);
+}
+
+bool
+IsDuckdbCopyOutReceiver(DestReceiver *dest) {
+	return dest->receiveSlot == DuckdbCopyOutReceiveSlot;
+}
+
+void
+DuckdbCopyOutReceiveChunk(DestReceiver *dest, Datum **values, bool **nulls, uint64 count) {
+	DuckdbCopyOutReceiver *receiver = (DuckdbCopyOutReceiver *)dest;
+	for (uint64 row = 0; row < count; row++) {
+		AppendCopyOutRow(receiver, values, nulls, row);
+	}
+}
+
+/*
+ * Plans the query of COPY (SELECT ...) TO STDOUT, if it's executed by DuckDB
+ * and the COPY can be handled by DuckdbCopyToStdout. Otherwise this returns
+ * NULL, in which case Postgres should execute the COPY.
+ */
+PlannedStmt *
+PlanDuckdbCopyToStdout(PlannedStmt *pstmt, const char *query_string, struct QueryEnvironment *query_env,
+                       bool *binary) {
+	CopyStmt *copy_stmt = (CopyStmt *)pstmt->utilityStmt;
+
+	if (copy_stmt->is_from || copy_stmt->filename || !copy_stmt->query) {
+		return NULL;
+	}
+
+	/* Postgres writes to stdout in single user mode, and converts text to the client encoding */
+	if (whereToSendOutput != DestRemote || pg_get_client_encoding() != GetDatabaseEncoding()) {
+		return NULL;
+	}
+
+	if (!GetCopyOutFormat(copy_stmt, binary)) {
+		return NULL;
+	}
+
+	RawStmt *raw_stmt = makeNode(RawStmt);
+	raw_stmt->stmt = (Node *)copyObjectImpl(copy_stmt->query);
+	raw_stmt->stmt_location = pstmt->stmt_location;
+	raw_stmt->stmt_len = pstmt->stmt_len;
+
+#if PG_VERSION_NUM >= 150000
+	List *rewritten = pg_analyze_and_rewrite_fixedparams(raw_stmt, query_string, NULL, 0, query_env);
+#else
+	List *rewritten = pg_analyze_and_rewrite(raw_stmt, query_string, NULL, 0, query_env);
+#endif
+	CheckRewritten(rewritten);
+
+	Query *query = linitial_node(Query, rewritten);
+	if (query->commandType != CMD_SELECT) {
+		return NULL;
+	}
+
+	/* Don't plan the query twice if it's clear that Postgres will execute it */
+	if (!pgduckdb::NeedsDuckdbExecution(query) && !pgduckdb::ShouldTryToUseDuckdbExecution(query)) {
+		return NULL;
+	}
+
+#if PG_VERSION_NUM >= 190000
+	PlannedStmt *plan = pg_plan_query(query, query_string, CURSOR_OPT_PARALLEL_OK, NULL, NULL);
+#else
+	PlannedStmt *plan = pg_plan_query(query, query_string, CURSOR_OPT_PARALLEL_OK, NULL);
+#endif
+
+	if (!IsA(plan->planTree, CustomScan) ||
+	    castNode(CustomScan, plan->planTree)->methods != &duckdb_scan_scan_methods) {
+		return NULL;
+	}
+
+	return plan;
+}
+
+/*
+ * Executes COPY (SELECT ...) TO STDOUT with the plan of
+ * PlanDuckdbCopyToStdout. Instead of going through the COPY implementation of
+ * Postgres, which calls the output function of every single value, the
+ * converted DuckDB chunks are written in the COPY format and sent to the
+ * client directly.
+ *
+ * Like any other query this is executed without holding the process lock, so
+ * that the DuckDB threads that scan Postgres tables can take it.
+ */
+void
+DuckdbCopyToStdout(PlannedStmt *plan, const char *query_string, struct QueryEnvironment *query_env, bool binary,
+                   QueryCompletion *qc) {
+	DuckdbCopyOutReceiver *receiver = (DuckdbCopyOutReceiver *)palloc0(sizeof(DuckdbCopyOutReceiver));
+	receiver->pub.receiveSlot = DuckdbCopyOutReceiveSlot;
+	receiver->pub.rStartup = DuckdbCopyOutStartup;
+	receiver->pub.rShutdown = DuckdbCopyOutShutdown;
+	receiver->pub.rDestroy = DuckdbCopyOutDestroy;
+	receiver->pub.mydest = DestCopyOut;
+	receiver->binary = binary;
+
+	/* Same as BeginCopyTo in Postgres */
+	PushCopiedSnapshot(GetActiveSnapshot());
+	UpdateActiveSnapshotCommandId();
+
+	QueryDesc *query_desc = CreateQueryDesc(plan, query_string, GetActiveSnapshot(), InvalidSnapshot,
+	                                        (DestReceiver *)receiver, NULL, query_env, 0);
+	ExecutorStart(query_desc, 0);
+
+	/* CopyOutResponse */
+	StringInfoData buf;
+	int natts = query_desc->tupDesc->natts;
+	pq_beginmessage(&buf, 'H');
+	pq_sendbyte(&buf, binary ? 1 : 0);
+	pq_sendint16(&buf, natts);
+	for (int i = 0; i < natts; i++) {
+		pq_sendint16(&buf, binary ? 1 : 0);
+	}
+	pq_endmessage(&buf);
+
+#if PG_VERSION_NUM >= 180000
+	ExecutorRun(query_desc, ForwardScanDirection, 0);
+#else
+	ExecutorRun(query_desc, ForwardScanDirection, 0, true);
+#endif
+	uint64 processed = query_desc->estate->es_processed;
+
+	ExecutorFinish(query_desc);
+	ExecutorEnd(query_desc);
+	FreeQueryDesc(query_desc);
+	PopActiveSnapshot();
+
+	/* CopyDone */
+	pq_putemptymessage('c');
+
+	if (qc) {
+		SetQueryCompletion(qc, CMDTAG_COPY, processed);
+	}
+}
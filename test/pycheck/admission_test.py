@@ -0,0 +1,74 @@
+"""Tests for the admission control of DuckDB queries
+
+These tests are using Python, because duckdb.max_active_queries_per_database
+can only be changed in the server configuration, and because they need
+multiple connections that execute DuckDB queries at the same time.
+"""
+
+import psycopg.errors
+import pytest
+
+from .utils import Postgres
+
+
+def test_admission(pg: Postgres):
+    pg.configure("duckdb.max_active_queries_per_database = 1")
+    pg.reload()
+
+    with pg.cur() as cur1, pg.cur() as cur2:
+        # duckdb.admission_queue is a Postgres view, so DuckDB can't query it
+        cur1.sql("SET duckdb.force_execution = false")
+
+        # While its query runs, the connection is admitted
+        cur1.sql("BEGIN")
+        cur1.sql(
+            "DECLARE c CURSOR FOR "
+            "SELECT * FROM duckdb.query($$ SELECT * FROM range(100000) $$)"
+        )
+        assert cur1.sql("FETCH 2 FROM c") == [0, 1]
+        assert cur1.sql(
+            """
+            SELECT datname = current_database(), rolname = session_user, state
+            FROM duckdb.admission_queue WHERE pid = pg_backend_pid()
+            """
+        ) == (True, True, "active")
+
+        # Other queries of the same connection don't need to wait for it
+        assert cur1.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)") == 42
+
+        # But the queries of other connections do
+        cur2.sql("SET duckdb.admission_timeout = '100ms'")
+        with pytest.raises(
+            psycopg.errors.QueryCanceled,
+            match="waited longer than duckdb.admission_timeout",
+        ):
+            cur2.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)")
+
+        # Without duckdb.admission_timeout waiting queries can still be canceled
+        cur2.sql("RESET duckdb.admission_timeout")
+        cur2.sql("SET statement_timeout = '100ms'")
+        with pytest.raises(
+            psycopg.errors.QueryCanceled,
+            match="canceling statement due to statement timeout",
+        ):
+            cur2.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)")
+        cur2.sql("RESET statement_timeout")
+
+        # Afterwards it's not in the queue anymore, and the others can go ahead
+        cur1.sql("COMMIT")
+        queued = cur1.sql(
+            "SELECT count(*) FROM duckdb.admission_queue WHERE pid = pg_backend_pid()"
+        )
+        assert queued == 0
+        assert cur2.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)") == 42
+        stats = cur1.sql(
+            "SELECT admitted > 0, timed_out > 0 FROM duckdb.admission_stats"
+        )
+        assert stats == (True, True)
+
+        # The limits can only be changed in the server configuration
+        with pytest.raises(
+            psycopg.errors.CantChangeRuntimeParam,
+            match="cannot be changed now",
+        ):
+            cur1.sql("SET duckdb.max_active_queries_per_database = 2")
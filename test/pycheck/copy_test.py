@@ -64,11 +64,9 @@ def test_copy_to_local(cur: Cursor, tmp_path: Path):
         (2, "Bob"),
     ]
 
-    # Again relative paths are not allowed for COPY TO, this becomes an
-    # internal error though, due to our failure to propagate error codes
-    # correctly.
+    # Again relative paths are not allowed for COPY TO
     with pytest.raises(
-        psycopg.errors.InternalError, match="relative path not allowed for COPY to file"
+        psycopg.errors.InvalidName, match="relative path not allowed for COPY to file"
     ):
         cur.sql("COPY test_table TO 'test_copy.parquet' WITH (FORMAT PARQUET)")
 
@@ -178,6 +176,66 @@ def test_copy_to_stdout(cur: Cursor):
             pass
 
 
+def test_copy_to_stdout_formats(cur: Cursor):
+    query = """
+        COPY (
+            SELECT * FROM duckdb.query($$
+                SELECT 1::smallint AS a, 2::int AS b, 3::bigint AS c, true AS d,
+                       'tab\there, back\\slash' AS e, NULL::text AS f,
+                       1.5::double AS g, '2024-01-02'::date AS h,
+                       '01020304-0506-0708-090a-0b0c0d0e0f10'::uuid AS i
+                UNION ALL
+                SELECT NULL, NULL, NULL, false, 'line\nbreak', 'x', NULL, NULL, NULL
+                ORDER BY d DESC
+            $$)
+        ) TO STDOUT"""
+
+    # Values are escaped the same way as Postgres its own COPY does
+    with cur.copy(query) as copy:
+        data = b"".join(copy)
+    assert data == (
+        b"1\t2\t3\tt\ttab\\there, back\\\\slash\t\\N\t1.5\t2024-01-02\t01020304-0506-0708-090a-0b0c0d0e0f10\n"
+        b"\\N\t\\N\t\\N\tf\tline\\nbreak\tx\t\\N\t\\N\t\\N\n"
+    )
+
+    # The binary format can be read by psycopg
+    with cur.copy(query + " (FORMAT BINARY)") as copy:
+        copy.set_types(
+            ["int2", "int4", "int8", "bool", "text", "text", "float8", "date", "uuid"]
+        )
+        rows = list(copy.rows())
+    assert [row[:7] for row in rows] == [
+        (1, 2, 3, True, "tab\there, back\\slash", None, 1.5),
+        (None, None, None, False, "line\nbreak", "x", None),
+    ]
+    assert str(rows[0][7]) == "2024-01-02"
+    assert str(rows[0][8]) == "01020304-0506-0708-090a-0b0c0d0e0f10"
+    assert rows[1][7:] == (None, None)
+
+
+def test_copy_to_stdout_from_postgres_table(cur: Cursor):
+    cur.sql("CREATE TABLE heap_table (id int, name text)")
+    cur.sql(
+        "INSERT INTO heap_table SELECT i, 'name' || i FROM generate_series(1, 300000) i"
+    )
+
+    # DuckDB scans the table with multiple threads while the COPY is running
+    with cur.copy(
+        "COPY (SELECT id, name FROM heap_table WHERE id % 1000 = 0 ORDER BY id) "
+        "TO STDOUT"
+    ) as copy:
+        rows = list(copy.rows())
+    assert len(rows) == 300
+    assert rows[:2] == [("1000", "name1000"), ("2000", "name2000")]
+    assert rows[-1] == ("300000", "name300000")
+
+    with cur.copy(
+        "COPY (SELECT count(*), max(id) FROM heap_table) TO STDOUT (FORMAT BINARY)"
+    ) as copy:
+        copy.set_types(["int8", "int4"])
+        assert list(copy.rows()) == [(300000, 300000)]
+
+
 def test_copy_from_local(cur: Cursor, tmp_path: Path):
     cur.sql("CREATE TEMP TABLE pg_table (id INT, name TEXT)")
     cur.sql("INSERT INTO pg_table (id, name) VALUES (1, 'Alice'), (2, 'Bob')")
@@ -230,7 +288,7 @@ def test_copy_from_local(cur: Cursor, tmp_path: Path):
         )
 
     with pytest.raises(
-        psycopg.errors.InternalError,
+        psycopg.errors.FeatureNotSupported,
         match="DuckDB COPY only supports SELECT statement",
     ):
         cur.sql(
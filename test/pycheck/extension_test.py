@@ -4,7 +4,7 @@ import psycopg.errors
 import psycopg.sql
 import pytest
 
-from .utils import Cursor, Postgres
+from .utils import Cursor, Postgres, pg_bin, run, wait_until
 
 
 def test_autoinstall_known_extensions(pg: Postgres, cur: Cursor):
@@ -70,3 +70,52 @@ def test_autoinstall_known_extensions(pg: Postgres, cur: Cursor):
         match=r'motherduck.duckdb_extension" not found.',
     ):
         cur.sql("SELECT * FROM duckdb.query($$ SELECT 1 $$)")
+
+
+def wait_for_replay(primary_cur: Cursor, standby_cur: Cursor):
+    lsn = primary_cur.sql("SELECT pg_current_wal_lsn()::text")
+    for _ in wait_until("The standby did not replay the changes", interval=0.1):
+        if standby_cur.sql("SELECT pg_last_wal_replay_lsn() >= %s::pg_lsn", (lsn,)):
+            break
+
+
+def test_extensions_changed_on_standby(pg: Postgres, cur: Cursor, tmp_path):
+    standby = Postgres(tmp_path / "standby")
+    run(
+        [
+            pg_bin("pg_basebackup"),
+            "--pgdata",
+            standby.pgdata,
+            "--write-recovery-conf",
+            "--checkpoint=fast",
+            "--host",
+            pg.host,
+            "--port",
+            pg.port,
+            "--username",
+            "postgres",
+        ]
+    )
+    standby.start()
+    try:
+        with standby.cur() as standby_cur:
+            cur.sql("SET duckdb.force_execution = false")
+            standby_cur.sql("SET duckdb.force_execution = false")
+            assert standby_cur.dsql("SELECT 42") == 42
+
+            # The standby loads the extensions again once it replayed a change
+            # to duckdb.extensions, even though the primary bumped the
+            # generation of the table only in its own shared memory
+            cur.sql("INSERT INTO duckdb.extensions (name) VALUES ('pgduckdb_missing')")
+            wait_for_replay(cur, standby_cur)
+            with pytest.raises(
+                psycopg.errors.InternalError,
+                match=r'pgduckdb_missing.duckdb_extension" not found.',
+            ):
+                standby_cur.dsql("SELECT 42")
+
+            cur.sql("DELETE FROM duckdb.extensions WHERE name = 'pgduckdb_missing'")
+            wait_for_replay(cur, standby_cur)
+            assert standby_cur.dsql("SELECT 42") == 42
+    finally:
+        standby.cleanup()
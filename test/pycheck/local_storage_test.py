@@ -0,0 +1,70 @@
+"""Tests for duckdb.local_storage
+
+These tests are using Python, because duckdb.local_storage can only be changed
+with a restart, and because they need multiple connections that use the DuckDB
+database file at the same time.
+"""
+
+import psycopg.errors
+import pytest
+
+from .utils import Postgres
+
+
+def test_local_storage(pg: Postgres):
+    pg.configure("duckdb.local_storage = true")
+    pg.restart()
+
+    with pg.cur() as cur1, pg.cur() as cur2:
+        cur1.sql("CREATE TABLE t (a int, b text) USING duckdb")
+        cur1.sql("INSERT INTO t SELECT i, 'b' || i FROM generate_series(1, 100) i")
+        assert cur1.sql("SELECT count(*), max(b) FROM t") == (100, "b99")
+
+        # Transactions that only read the tables don't wait for each other
+        cur1.sql("BEGIN")
+        assert cur1.sql("SELECT count(*) FROM t") == 100
+        assert cur2.sql("SELECT count(*) FROM t WHERE a > 50") == 50
+
+        # But transactions that change them do
+        cur2.sql("SET lock_timeout = '100ms'")
+        with pytest.raises(psycopg.errors.LockNotAvailable):
+            cur2.sql("INSERT INTO t VALUES (101, 'b101')")
+
+        # Until the other transactions finished
+        cur1.sql("COMMIT")
+        cur2.sql("INSERT INTO t VALUES (101, 'b101')")
+        assert cur1.sql("SELECT count(*) FROM t") == 101
+
+        # A transaction that reads and then writes the tables can do so
+        cur1.sql("BEGIN")
+        assert cur1.sql("SELECT count(*) FROM t") == 101
+        cur1.sql("DELETE FROM t WHERE a > 100")
+        assert cur1.sql("SELECT count(*) FROM t") == 100
+        cur1.sql("COMMIT")
+        assert cur2.sql("SELECT count(*) FROM t") == 100
+
+        cur1.sql("ALTER TABLE t ADD COLUMN c int")
+        cur1.sql("TRUNCATE t")
+        assert cur2.sql("SELECT count(*) FROM t") == 0
+
+        # Queries can't access the DuckDB database file directly
+        with pytest.raises(
+            psycopg.errors.InternalError,
+            match="can only be accessed by the local storage of pg_duckdb",
+        ):
+            cur1.sql(
+                "SELECT * FROM duckdb.query("
+                "$$ SELECT * FROM read_blob('pgduckdb-local:///tmp/x.duckdb') $$)"
+            )
+
+        # MotherDuck can't be used together with local storage
+        with pytest.raises(
+            psycopg.errors.InternalError,
+            match="because duckdb.local_storage is enabled",
+        ):
+            cur1.sql(
+                "CREATE SERVER motherduck TYPE 'motherduck' "
+                "FOREIGN DATA WRAPPER duckdb"
+            )
+
+        cur1.sql("DROP TABLE t")
@@ -0,0 +1,32 @@
+"""Tests for the memory budget of duckdb.max_memory_global
+
+These tests are using Python, because duckdb.max_memory_global can only be
+changed with a restart, and because they need multiple connections that
+reserve memory at the same time.
+"""
+
+import psycopg.errors
+import pytest
+
+from .utils import Postgres
+
+
+def test_memory_budget_exhausted(pg: Postgres):
+    pg.configure("duckdb.max_memory_global = 200")
+    pg.restart()
+
+    with pg.cur() as cur1, pg.cur() as cur2:
+        # A transaction that uses DuckDB reserves the whole budget
+        cur1.sql("BEGIN")
+        assert cur1.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)") == 42
+
+        # So another connection can't reserve enough memory for its queries
+        with pytest.raises(
+            psycopg.errors.InsufficientResources,
+            match="Could not reserve DuckDB memory for this connection",
+        ):
+            cur2.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)")
+
+        # Until the transaction gives most of it back
+        cur1.sql("COMMIT")
+        assert cur2.sql("SELECT * FROM duckdb.query($$ SELECT 42 $$)") == 42
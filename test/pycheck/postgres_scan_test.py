@@ -0,0 +1,173 @@
+"""Tests for scans of Postgres tables
+
+These tests are using Python, because they check the queries that DuckDB sends
+to Postgres. Those are only logged as notices, together with a Postgres plan
+that depends on the number of parallel workers that were available.
+"""
+
+from .utils import Cursor
+
+
+def scan_queries(output, table_name):
+    """Returns the logged queries that scanned the given table"""
+    return [
+        line
+        for line in output.splitlines()
+        if line.startswith("QUERY: ") and f" FROM public.{table_name}" in line
+    ]
+
+
+def test_join_keys_pushed_into_scan(cur: Cursor, capsys):
+    cur.sql("CREATE TABLE dim (id int, name text)")
+    cur.sql(
+        "INSERT INTO dim SELECT i * 1000, 'dim' || i FROM generate_series(1, 100) i"
+    )
+    cur.sql("CREATE TABLE fact (id int, v int)")
+    cur.sql("INSERT INTO fact SELECT i, i % 7 FROM generate_series(1, 300000) i")
+    cur.sql("ANALYZE dim, fact")
+    cur.sql("SET duckdb.log_pg_explain = true")
+
+    # The 100 keys of dim end up in the scan query of fact as an IN list
+    capsys.readouterr()
+    assert cur.sql(
+        "SELECT count(*), sum(fact.v) FROM fact JOIN dim ON fact.id = dim.id"
+    ) == (100, 305)
+    queries = scan_queries(capsys.readouterr().out, "fact")
+    assert len(queries) == 1
+    assert " IN (" in queries[0]
+    assert "1000, " in queries[0]
+
+    # With DuckDB its own default threshold the keys aren't pushed down
+    cur.sql("SET duckdb.dynamic_or_filter_threshold = 50")
+    capsys.readouterr()
+    assert cur.sql(
+        "SELECT count(*), sum(fact.v) FROM fact JOIN dim ON fact.id = dim.id"
+    ) == (100, 305)
+    queries = scan_queries(capsys.readouterr().out, "fact")
+    assert len(queries) == 1
+    assert " IN (" not in queries[0]
+
+
+def cached_plan_messages(output):
+    """Returns the debug messages about the cached scan plans"""
+    return [
+        line
+        for line in output.splitlines()
+        if line.startswith("DEBUG: (PGDuckDB/GetTableScanPlan)")
+    ]
+
+
+def test_scan_plan_cache(cur: Cursor, capsys):
+    cur.sql("CREATE TABLE t (a int, b int)")
+    cur.sql("INSERT INTO t SELECT i, i % 10 FROM generate_series(1, 1000) i")
+    cur.sql("SET client_min_messages = debug1")
+
+    # The second scan with the same columns and filters reuses the plan
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 3") == 100
+    capsys.readouterr()
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 3") == 100
+    messages = cached_plan_messages(capsys.readouterr().out)
+    assert len(messages) == 1
+    assert "Reusing the cached plan of: " in messages[0]
+    assert "b=3" in messages[0]
+
+    # Other filters need a plan of their own
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 4") == 100
+    assert cached_plan_messages(capsys.readouterr().out) == []
+
+    # Changing the table replans its scans
+    cur.sql("ALTER TABLE t ADD COLUMN c int")
+    capsys.readouterr()
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 3") == 100
+    assert cached_plan_messages(capsys.readouterr().out) == []
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 3") == 100
+    assert len(cached_plan_messages(capsys.readouterr().out)) == 1
+
+    # Only the least recently used plan is evicted when the cache is full
+    cur.sql("SET duckdb.max_cached_scan_plans = 2")
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 4") == 100
+    capsys.readouterr()
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 5") == 100
+    messages = cached_plan_messages(capsys.readouterr().out)
+    assert len(messages) == 1
+    assert "Evicting a cached plan of relation " in messages[0]
+    assert cur.sql("SELECT count(*) FROM t WHERE b = 4") == 100
+    messages = cached_plan_messages(capsys.readouterr().out)
+    assert len(messages) == 1
+    assert "b=4" in messages[0]
+
+
+def scan_runs(output):
+    """Returns how the logged scans of Postgres tables were run"""
+    return [line for line in output.splitlines() if line.startswith("RUNNING: ")]
+
+
+def test_parallel_scan_settings(cur: Cursor, capsys):
+    cur.sql("CREATE TABLE t (a int, b text, c numeric(10, 2), d uuid)")
+    cur.sql("""
+        INSERT INTO t SELECT
+            i,
+            CASE WHEN i % 3 = 0 THEN NULL ELSE 'str' || i END,
+            i / 100.0,
+            md5(i::text)::uuid
+        FROM generate_series(1, 300000) i
+    """)
+    cur.sql("ANALYZE t")
+    summary = """
+        SELECT count(*), sum(a), count(b), sum(length(b)), sum(c), count(DISTINCT d)
+        FROM t
+    """
+
+    cur.sql("SET duckdb.force_execution = false")
+    expected = cur.sql(summary)
+    cur.sql("SET duckdb.force_execution = true")
+    cur.sql("SET duckdb.log_pg_explain = true")
+
+    def check(running):
+        capsys.readouterr()
+        assert cur.sql(summary) == expected
+        assert scan_runs(capsys.readouterr().out) == [f"RUNNING: {running}."]
+
+    # By default the workers send columnar batches, and the leader scans too
+    check("ON 2 PARALLEL WORKER(S)")
+
+    # More worker queues than DuckDB threads and the other way around
+    cur.sql("SET duckdb.max_workers_per_postgres_scan = 4")
+    cur.sql("SET duckdb.threads_for_postgres_scan = 2")
+    check("ON 4 PARALLEL WORKER(S)")
+    cur.sql("SET duckdb.max_workers_per_postgres_scan = 1")
+    cur.sql("SET duckdb.threads_for_postgres_scan = 4")
+    check("ON 1 PARALLEL WORKER(S)")
+    cur.sql("RESET duckdb.max_workers_per_postgres_scan")
+    cur.sql("RESET duckdb.threads_for_postgres_scan")
+
+    # Workers sending tuples, with and without the leader scanning its share
+    cur.sql("SET duckdb.columnar_worker_transport = false")
+    check("ON 2 PARALLEL WORKER(S)")
+    cur.sql("SET parallel_leader_participation = false")
+    check("ON 2 PARALLEL WORKER(S)")
+    cur.sql("RESET duckdb.columnar_worker_transport")
+    check("ON 2 PARALLEL WORKER(S)")
+    cur.sql("RESET parallel_leader_participation")
+
+    # Without workers the backend scans the table itself
+    cur.sql("SET duckdb.max_workers_per_postgres_scan = 0")
+    check("IN PROCESS THREAD")
+
+
+def test_cursor_with_hold_replays_result(cur: Cursor, capsys):
+    cur.sql("CREATE TABLE held (a int)")
+    cur.sql("INSERT INTO held SELECT generate_series(1, 5)")
+    cur.sql("SET duckdb.log_pg_explain = true")
+
+    # At commit Postgres rewinds the cursor to store all of its rows. The rows
+    # that were already fetched are replayed then, instead of running the
+    # query and its scan of the table again.
+    capsys.readouterr()
+    cur.sql("BEGIN")
+    cur.sql("DECLARE c CURSOR WITH HOLD FOR SELECT a FROM held ORDER BY a")
+    assert cur.sql("FETCH 2 FROM c") == [1, 2]
+    cur.sql("COMMIT")
+    assert cur.sql("FETCH ALL FROM c") == [3, 4, 5]
+    cur.sql("CLOSE c")
+    assert len(scan_queries(capsys.readouterr().out, "held")) == 1
@@ -0,0 +1,84 @@
+"""Tests for the shared engine of duckdb.shared_engine_database
+
+These tests are using Python, because the shared engine can only be enabled
+with a restart, and because they need to check which DuckDB instance executed
+a query. The latter is only logged as a debug message.
+"""
+
+import psycopg.errors
+import pytest
+
+from .utils import Cursor, Postgres, wait_until
+
+
+def shared_engine_messages(output):
+    """Returns the debug messages about queries sent to the shared engine"""
+    return [
+        line
+        for line in output.splitlines()
+        if line.startswith("DEBUG: [PGDuckDB] Executing the query in the shared engine")
+    ]
+
+
+def shared_engine_pid(cur: Cursor):
+    return cur.sql(
+        "SELECT pid FROM pg_stat_activity "
+        "WHERE backend_type = 'pg_duckdb shared engine'"
+    )
+
+
+def test_shared_engine(pg: Postgres, capsys):
+    pg.configure("duckdb.shared_engine_database = 'postgres'")
+    pg.restart()
+
+    with pg.cur() as cur:
+        for _ in wait_until("The shared engine did not start"):
+            if shared_engine_pid(cur) != []:
+                break
+
+        cur.sql("SET client_min_messages = debug1")
+        cur.sql("CREATE TABLE t (a int)")
+        cur.sql("INSERT INTO t VALUES (1), (2)")
+
+        # Queries that don't read Postgres tables go to the shared engine, and
+        # are executed with the TimeZone of the connection
+        cur.sql("SET TimeZone = 'Asia/Kolkata'")
+        capsys.readouterr()
+        time_zone = cur.dsql("SELECT current_setting('TimeZone')")
+        assert time_zone == "Asia/Kolkata"
+        assert len(shared_engine_messages(capsys.readouterr().out)) == 1
+
+        # Queries that read Postgres tables are executed locally
+        assert cur.sql("SELECT count(*) FROM t") == 2
+        assert shared_engine_messages(capsys.readouterr().out) == []
+
+        # Errors of the shared engine are raised in the connection. A DuckDB
+        # temporary table only exists in the DuckDB instance of the connection.
+        cur.sql("SELECT * FROM duckdb.raw_query($$ CREATE TEMP TABLE tmp (a int) $$)")
+        cur.sql("SELECT * FROM duckdb.raw_query($$ INSERT INTO tmp VALUES (42) $$)")
+        with pytest.raises(psycopg.errors.InternalError, match="tmp does not exist"):
+            cur.dsql("SELECT * FROM tmp")
+
+        # So such queries have to opt out of the shared engine
+        cur.sql("SET duckdb.use_shared_engine = false")
+        capsys.readouterr()
+        assert cur.dsql("SELECT * FROM tmp") == 42
+        assert shared_engine_messages(capsys.readouterr().out) == []
+        cur.sql("RESET duckdb.use_shared_engine")
+
+        # Canceling a query stops its execution in the shared engine, so that
+        # the next query doesn't have to wait for it
+        cur.sql("SET statement_timeout = '1s'")
+        with pytest.raises(psycopg.errors.QueryCanceled):
+            cur.dsql("SELECT sum(hash(i)) FROM range(100000000000) t(i)")
+        assert cur.dsql("SELECT 42") == 42
+        cur.sql("RESET statement_timeout")
+
+        # While the shared engine is not running, queries are executed locally
+        cur.sql("SELECT pg_terminate_backend(%s)", (shared_engine_pid(cur),))
+        for _ in wait_until("The shared engine did not exit", interval=0.1):
+            if shared_engine_pid(cur) == []:
+                break
+        capsys.readouterr()
+        assert cur.dsql("SELECT * FROM tmp") == 42
+        assert shared_engine_messages(capsys.readouterr().out) == []
@@ -810,6 +810,7 @@ class Postgres(OutputSilencer):
             self.reloaded = False
 
     def reload(self):
+        self.reloaded = True
         if WINDOWS:
             # SIGHUP and thus reload don't exist on Windows
             self.restart()
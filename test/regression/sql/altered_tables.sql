@@ -20,3 +20,28 @@ SELECT * FROM table_missing_attrs;
 SELECT a, c, d, f FROM table_missing_attrs;
 
 DROP TABLE table_missing_attrs;
+
+-- Tables that are replaced or moved after they were queried
+CREATE TABLE replaced_table(a int);
+INSERT INTO replaced_table VALUES (1);
+SELECT * FROM replaced_table;
+DROP TABLE replaced_table;
+CREATE TABLE replaced_table(b text);
+INSERT INTO replaced_table VALUES ('x');
+SELECT * FROM replaced_table;
+ALTER TABLE replaced_table ALTER COLUMN b TYPE int USING 42;
+SELECT * FROM replaced_table;
+DROP TABLE replaced_table;
+
+CREATE SCHEMA moved_schema;
+CREATE TABLE moved_schema.t(a int);
+INSERT INTO moved_schema.t VALUES (1);
+SELECT * FROM moved_schema.t;
+ALTER SCHEMA moved_schema RENAME TO renamed_schema;
+CREATE SCHEMA moved_schema;
+CREATE TABLE moved_schema.t(b text);
+INSERT INTO moved_schema.t VALUES ('new');
+SELECT * FROM moved_schema.t;
+SELECT * FROM renamed_schema.t;
+DROP TABLE moved_schema.t, renamed_schema.t;
+DROP SCHEMA moved_schema, renamed_schema;
@@ -53,3 +53,14 @@ CREATE TABLE t(a INT, b VARCHAR);
 INSERT INTO t SELECT g, repeat('ABCDE', 10000) FROM generate_series(1, 10) g;
 SELECT LENGTH(b) FROM t WHERE a = 5;
 DROP TABLE t;
+
+-- Joins of analyzed tables, whose column statistics are used to order the joins
+CREATE TABLE fact(a INT, b INT, c INT);
+INSERT INTO fact SELECT g % 100, g % 10, g FROM generate_series(1, 10000) g;
+CREATE TABLE dim_a(a INT, name TEXT);
+INSERT INTO dim_a SELECT g, 'a' || g FROM generate_series(0, 99) g;
+CREATE TABLE dim_b(b INT, name TEXT);
+INSERT INTO dim_b SELECT g, 'b' || g FROM generate_series(0, 9) g;
+ANALYZE fact, dim_a, dim_b;
+SELECT COUNT(*), SUM(fact.c) FROM fact JOIN dim_a ON fact.a = dim_a.a JOIN dim_b ON fact.b = dim_b.b WHERE dim_b.name = 'b3';
+DROP TABLE fact, dim_a, dim_b;
@@ -67,5 +67,10 @@ SELECT last_value FROM duckdb.extensions_table_seq;
 
 SELECT * FROM duckdb.query($$ SELECT extension_name, loaded, installed, installed_from FROM duckdb_extensions() WHERE loaded and extension_name != 'jemalloc' $$);
 
+-- Changes to duckdb.extensions can't be part of a prepared transaction
+BEGIN;
+INSERT INTO duckdb.extensions (name) VALUES ('pgduckdb_missing');
+PREPARE TRANSACTION 'extensions';
+
 -- cleanup
 TRUNCATE duckdb.extensions;
@@ -0,0 +1,22 @@
+SET duckdb.lazy_initialization = true;
+CALL duckdb.recycle_ddb();
+
+CREATE TABLE lazy_init(a int);
+INSERT INTO lazy_init VALUES (1), (2), (3);
+
+-- Only reads a Postgres table, so this doesn't need the extensions and secrets
+SELECT count(*) FROM lazy_init;
+
+CREATE SERVER lazy_init_s3_server TYPE 's3' FOREIGN DATA WRAPPER duckdb;
+
+-- But this does, so they are loaded now
+SELECT * FROM duckdb.query($$ SELECT name, type FROM duckdb_secrets(); $$);
+
+-- And are kept up to date from then on
+DROP SERVER lazy_init_s3_server;
+SELECT count(*) FROM lazy_init;
+SELECT * FROM duckdb.query($$ SELECT name, type FROM duckdb_secrets(); $$);
+
+DROP TABLE lazy_init;
+RESET duckdb.lazy_initialization;
+CALL duckdb.recycle_ddb();
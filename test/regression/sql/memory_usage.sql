@@ -0,0 +1,12 @@
+-- duckdb.memory_usage is a Postgres view, so DuckDB can't query it
+SET duckdb.force_execution = false;
+SHOW duckdb.max_memory_global;
+
+-- Using DuckDB reserves memory for this connection, up to duckdb.max_memory
+SELECT * FROM duckdb.query($$ SELECT current_setting('memory_limit') $$);
+
+-- At the end of the transaction most of it is given back
+SELECT reserved_memory > 0 AS reserved, reserved_memory < 4096 * 1024 * 1024::bigint AS released
+FROM duckdb.memory_usage WHERE pid = pg_backend_pid();
+
+RESET duckdb.force_execution;
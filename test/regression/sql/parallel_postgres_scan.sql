@@ -14,3 +14,43 @@ SELECT tbl.id, tbl.c, tbl.d, tbl1.c, tbl1.d FROM tbl JOIN tbl1 ON tbl.id = tbl1.
 
 DROP TABLE tbl, tbl1;
 
+-- One table for the checks below, with fixed-width, variable-width, NULL,
+-- compressed and toasted columns
+CREATE TABLE scan_tbl (a int, b int2, c text, d float8, e bool, f numeric(10, 2), g uuid, h bytea, big text, ext text);
+ALTER TABLE scan_tbl ALTER COLUMN ext SET STORAGE EXTERNAL;
+INSERT INTO scan_tbl SELECT i, i % 100, CASE WHEN i % 3 = 0 THEN NULL ELSE 'str' || i END, CASE WHEN i % 5 = 0 THEN NULL ELSE i / 2.0 END, i % 2 = 0, CASE WHEN i % 7 = 0 THEN NULL ELSE i / 100.0 END, md5(i::text)::uuid, decode(md5(i::text), 'hex'), CASE WHEN i % 1000 = 0 THEN repeat(md5(i::text), 200) END, CASE WHEN i % 1000 = 0 THEN repeat(md5(i::text), 100) END FROM generate_series(1, 300000) i;
+SELECT count(*), sum(a) AS a, sum(b) AS b, count(c) AS c, sum(length(c)) AS c_length, count(d) AS d, sum(d) AS d_sum, count(*) FILTER (WHERE e) AS e, count(f) AS f, sum(f) AS f_sum, count(DISTINCT g) AS g, sum(octet_length(h)) AS h FROM scan_tbl;
+SELECT count(*) FILTER (WHERE big = repeat(md5(a::text), 200) AND ext = repeat(md5(a::text), 100)) AS toasted, sum(length(big)) AS big, sum(length(ext)) AS ext FROM scan_tbl;
+
+-- Strings that are referenced in place, of which bpchar values are trimmed
+CREATE TABLE str_tbl (id int, a varchar, b bpchar(20), c varchar(10));
+INSERT INTO str_tbl SELECT i, repeat('x', i % 7), 'pad' || (i % 10), CASE WHEN i % 4 = 0 THEN NULL ELSE 'v' || (i % 1000) END FROM generate_series(1, 200000) i;
+SELECT sum(length(a)) AS a, sum(length(b)) AS b, count(*) FILTER (WHERE b = 'pad' || (id % 10)) AS b_matches, count(c) AS c_count, sum(length(c)) AS c FROM str_tbl;
+SELECT id, a, b || '|' AS b, c FROM str_tbl ORDER BY id LIMIT 3;
+DROP TABLE str_tbl;
+
+-- Top-N queries, for which DuckDB pushes down a dynamic filter
+SELECT a, b, c, d, e, f, g, h FROM scan_tbl ORDER BY a LIMIT 3;
+SELECT a, b, c, d, e, f FROM scan_tbl ORDER BY a DESC LIMIT 3;
+SELECT a, c FROM scan_tbl WHERE a % 2 = 0 ORDER BY a LIMIT 3;
+
+-- Cursors stream their result, also when it reads from Postgres tables
+BEGIN;
+DECLARE c CURSOR FOR SELECT a, c FROM scan_tbl ORDER BY a;
+FETCH 2 FROM c;
+-- Other queries can run while the cursor is open
+SELECT count(*) FROM scan_tbl;
+FETCH 2 FROM c;
+CLOSE c;
+-- Committing stops a partially consumed result
+DECLARE c CURSOR FOR SELECT a, c FROM scan_tbl WHERE a > 299990 ORDER BY a;
+FETCH 2 FROM c;
+COMMIT;
+-- And so does aborting the transaction
+BEGIN;
+DECLARE c CURSOR FOR SELECT a, c FROM scan_tbl ORDER BY a;
+FETCH 2 FROM c;
+SAVEPOINT s;
+ROLLBACK;
+SELECT count(*) FROM scan_tbl;
+DROP TABLE scan_tbl;
@@ -78,4 +78,42 @@ DEALLOCATE ALL;
 SELECT name, statement, parameter_types FROM pg_prepared_statements
     ORDER BY name;
 
+-- the DuckDB statement prepared while planning is reused, until the table changes
+PREPARE q8 AS SELECT COUNT(*), MAX(a) FROM ta;
+EXECUTE q8;
+INSERT INTO ta VALUES (1001);
+EXECUTE q8;
+ALTER TABLE ta ADD COLUMN b int DEFAULT 5;
+EXECUTE q8;
+ALTER TABLE ta RENAME COLUMN a TO c;
+EXECUTE q8;
+DEALLOCATE q8;
+
+-- custom plans get a new statement for every execution
+SET plan_cache_mode = force_custom_plan;
+PREPARE q9(int) AS SELECT COUNT(*) FROM ta WHERE c > $1;
+EXECUTE q9(500);
+EXECUTE q9(900);
+DEALLOCATE q9;
+RESET plan_cache_mode;
+
+-- plans that SPI caches keep their statement between calls, until the table changes
+CREATE FUNCTION count_ta(min_c int) RETURNS bigint
+LANGUAGE plpgsql
+AS $$
+DECLARE
+    result bigint;
+BEGIN
+    SELECT COUNT(*) INTO result FROM ta WHERE c > min_c;
+    RETURN result;
+END;
+$$;
+SELECT count_ta(500);
+SELECT count_ta(900);
+INSERT INTO ta VALUES (1002, 6);
+SELECT count_ta(900);
+ALTER TABLE ta DROP COLUMN b;
+SELECT count_ta(900);
+DROP FUNCTION count_ta;
+
 DROP TABLE copy_database, ta, tb;
@@ -0,0 +1,17 @@
+-- duckdb.thread_usage is a Postgres view, so DuckDB can't query it
+SET duckdb.force_execution = false;
+SHOW duckdb.max_threads_global;
+
+-- While a query runs, this connection gets a share of duckdb.max_threads_global
+SET duckdb.thread_priority = 5;
+BEGIN;
+DECLARE c CURSOR FOR SELECT * FROM duckdb.query($$ SELECT * FROM range(100000) $$);
+FETCH 2 FROM c;
+SELECT priority, threads > 0 AS has_threads FROM duckdb.thread_usage WHERE pid = pg_backend_pid();
+COMMIT;
+
+-- Afterwards it gives the share back
+SELECT priority, threads FROM duckdb.thread_usage WHERE pid = pg_backend_pid();
+
+RESET duckdb.thread_priority;
+RESET duckdb.force_execution;
@@ -310,5 +310,32 @@ FETCH NEXT FROM c;
 FETCH PRIOR FROM c;
 COMMIT;
 
+-- A cursor WITH HOLD rescans its query when the transaction commits
+INSERT INTO t_ddb VALUES (2), (3), (4);
+BEGIN;
+DECLARE c2 CURSOR WITH HOLD FOR SELECT a FROM t_ddb ORDER BY a;
+FETCH 2 FROM c2;
+COMMIT;
+FETCH ALL FROM c2;
+CLOSE c2;
+
+CREATE TABLE t_hold(a int);
+INSERT INTO t_hold SELECT generate_series(1, 5);
+BEGIN;
+DECLARE c3 CURSOR WITH HOLD FOR SELECT a FROM t_hold ORDER BY a;
+FETCH 2 FROM c3;
+COMMIT;
+FETCH ALL FROM c3;
+CLOSE c3;
+
+-- FETCH ALL continues with the rows after the ones that an earlier FETCH returned
+BEGIN;
+DECLARE c4 CURSOR FOR SELECT a FROM t_hold ORDER BY a;
+FETCH 2 FROM c4;
+FETCH ALL FROM c4;
+FETCH ALL FROM c4;
+COMMIT;
+DROP TABLE t_hold;
+
 DROP FUNCTION f, f2;
 DROP TABLE t;